@@ -34,7 +34,26 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct LRUCacheOptions, high_pri_pool_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable,
-          offsetof(struct LRUCacheOptions, high_pri_pool_ratio)}}};
+          offsetof(struct LRUCacheOptions, high_pri_pool_ratio)}},
+        {"miss_ratio_curve_sampling_rate",
+         {offsetof(struct LRUCacheOptions, miss_ratio_curve_sampling_rate),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
+        {"high_pri_admission_control",
+         {offsetof(struct LRUCacheOptions, high_pri_admission_control),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
+        {"low_pri_admission_control",
+         {offsetof(struct LRUCacheOptions, low_pri_admission_control),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
+        {"probation_pool_ratio",
+         {offsetof(struct LRUCacheOptions, probation_pool_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
+        {"numa_aware",
+         {offsetof(struct LRUCacheOptions, numa_aware), OptionType::kBoolean,
+          OptionVerificationType::kNormal, OptionTypeFlags::kNone, 0}}};
 #endif  // ROCKSDB_LITE
 
 Status Cache::CreateFromString(const ConfigOptions& config_options,
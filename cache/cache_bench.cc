@@ -16,6 +16,8 @@ int main() {
 #include <cinttypes>
 #include <limits>
 
+#include "memory/memory_allocator.h"
+#include "memory/slab_memory_allocator.h"
 #include "port/port.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/db.h"
@@ -42,6 +44,10 @@ DEFINE_double(resident_ratio, 0.25,
 DEFINE_uint64(ops_per_thread, 0,
               "Number of operations per thread. (Default: 5 * keyspace size)");
 DEFINE_uint32(value_bytes, 8 * KiB, "Size of each value added.");
+DEFINE_uint32(value_bytes_spread, 0,
+              "If > 0, the size of each value is picked uniformly from "
+              "value_bytes - value_bytes_spread to value_bytes + "
+              "value_bytes_spread, like the sizes of compressed blocks.");
 
 DEFINE_uint32(skew, 5, "Degree of skew in key selection");
 DEFINE_bool(populate_cache, true, "Populate cache before operations");
@@ -55,8 +61,25 @@ DEFINE_uint32(lookup_percent, 10,
               "Ratio of lookup to total workload (expressed as a percentage)");
 DEFINE_uint32(erase_percent, 1,
               "Ratio of erase to total workload (expressed as a percentage)");
+DEFINE_uint32(scan_percent, 0,
+              "Ratio of scans to total workload (expressed as a percentage). "
+              "A scan looks up scan_length keys read only once, and inserts "
+              "them.");
+DEFINE_uint32(scan_length, 100, "Number of keys read by a scan.");
 
 DEFINE_bool(use_clock_cache, false, "");
+DEFINE_bool(admission_control, false,
+            "Enable TinyLFU admission control in the LRU cache.");
+DEFINE_bool(use_slab_allocator, false,
+            "Allocate the values with the slab memory allocator of the cache "
+            "instead of new[]. Compare the resident memory reported at the "
+            "end, and the TLB misses (e.g. perf stat -e dTLB-load-misses), "
+            "with and without it.");
+DEFINE_bool(slab_allocator_use_huge_pages, true,
+            "Back the slabs of the slab allocator with huge pages.");
+DEFINE_double(probation_pool_ratio, 0.0,
+              "Ratio of the LRU cache for the probation FIFO of the entries "
+              "not hit since their insertion.");
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -122,9 +145,12 @@ struct ThreadState {
   uint32_t tid;
   Random64 rnd;
   SharedState* shared;
+  // Lookups of the keys picked from the key space, and how many of them hit.
+  uint64_t lookups;
+  uint64_t hits;
 
   ThreadState(uint32_t index, SharedState* _shared)
-      : tid(index), rnd(1000 + index), shared(_shared) {}
+      : tid(index), rnd(1000 + index), shared(_shared), lookups(0), hits(0) {}
 };
 
 struct KeyGen {
@@ -136,7 +162,10 @@ struct KeyGen {
     for (uint32_t i = 0; i < FLAGS_skew; ++i) {
       raw = std::min(raw, rnd.Next());
     }
-    uint64_t key = fastrange64(raw, max_key);
+    return Get(fastrange64(raw, max_key));
+  }
+
+  Slice Get(uint64_t key) {
     // Variable size and alignment
     size_t off = key % 8;
     key_data[0] = char{42};
@@ -149,17 +178,49 @@ struct KeyGen {
   }
 };
 
-char* createValue(Random64& rnd) {
-  char* rv = new char[FLAGS_value_bytes];
+// The memory allocator of the cache, if any, to free the values.
+MemoryAllocator* value_allocator = nullptr;
+
+uint32_t ValueSize(Random64& rnd) {
+  if (FLAGS_value_bytes_spread == 0) {
+    return FLAGS_value_bytes;
+  }
+  return FLAGS_value_bytes - FLAGS_value_bytes_spread +
+         static_cast<uint32_t>(rnd.Uniform(2 * FLAGS_value_bytes_spread + 1));
+}
+
+char* createValue(Random64& rnd, uint32_t value_bytes) {
+  char* rv = AllocateBlock(value_bytes, value_allocator).release();
   // Fill with some filler data, and take some CPU time
-  for (uint32_t i = 0; i < FLAGS_value_bytes; i += 8) {
+  for (uint32_t i = 0; i + 8 <= value_bytes; i += 8) {
     EncodeFixed64(rv + i, rnd.Next());
   }
   return rv;
 }
 
 void deleter(const Slice& /*key*/, void* value) {
-  delete[] static_cast<char*>(value);
+  CustomDeleter value_deleter(value_allocator);
+  value_deleter(static_cast<char*>(value));
+}
+
+// Returns the resident memory of the process, or 0 if unknown.
+uint64_t GetResidentMemory() {
+#ifdef OS_LINUX
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return 0;
+  }
+  unsigned long long size = 0;
+  unsigned long long resident = 0;
+  int matched = fscanf(statm, "%llu %llu", &size, &resident);
+  fclose(statm);
+  if (matched != 2) {
+    return 0;
+  }
+  return resident * port::kPageSize;
+#else
+  return 0;
+#endif
 }
 }  // namespace
 
@@ -178,8 +239,10 @@ class CacheBench {
         lookup_threshold_(insert_threshold_ +
                           kHundredthUint64 * FLAGS_lookup_percent),
         erase_threshold_(lookup_threshold_ +
-                         kHundredthUint64 * FLAGS_erase_percent) {
-    if (erase_threshold_ != 100U * kHundredthUint64) {
+                         kHundredthUint64 * FLAGS_erase_percent),
+        scan_threshold_(erase_threshold_ +
+                        kHundredthUint64 * FLAGS_scan_percent) {
+    if (scan_threshold_ != 100U * kHundredthUint64) {
       fprintf(stderr, "Percentages must add to 100.\n");
       exit(1);
     }
@@ -190,8 +253,33 @@ class CacheBench {
         exit(1);
       }
     } else {
-      cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
+      LRUCacheOptions opts(FLAGS_cache_size, FLAGS_num_shard_bits,
+                           false /* strict_capacity_limit */,
+                           0.5 /* high_pri_pool_ratio */);
+      if (FLAGS_use_slab_allocator) {
+        SlabAllocatorOptions slab_opts;
+        slab_opts.use_huge_pages = FLAGS_slab_allocator_use_huge_pages;
+        slab_opts.max_slab_allocation_size =
+            std::max<size_t>(slab_opts.max_slab_allocation_size,
+                             FLAGS_value_bytes + FLAGS_value_bytes_spread);
+        while (slab_opts.slab_size <
+               4 * (slab_opts.max_slab_allocation_size +
+                    SlabMemoryAllocator::kHeaderSize)) {
+          slab_opts.slab_size *= 2;
+        }
+        Status s =
+            NewSlabMemoryAllocator(slab_opts, &opts.memory_allocator);
+        if (!s.ok()) {
+          fprintf(stderr, "Slab allocator: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+      }
+      opts.high_pri_admission_control = FLAGS_admission_control;
+      opts.low_pri_admission_control = FLAGS_admission_control;
+      opts.probation_pool_ratio = FLAGS_probation_pool_ratio;
+      cache_ = NewLRUCache(opts);
     }
+    value_allocator = cache_->memory_allocator();
     if (FLAGS_ops_per_thread == 0) {
       FLAGS_ops_per_thread = 5 * max_key_;
     }
@@ -199,12 +287,18 @@ class CacheBench {
 
   ~CacheBench() {}
 
+  void InsertValue(const Slice& key, Random64& rnd,
+                   Cache::Handle** handle = nullptr) {
+    uint32_t value_bytes = ValueSize(rnd);
+    cache_->Insert(key, createValue(rnd, value_bytes), value_bytes, &deleter,
+                   handle);
+  }
+
   void PopulateCache() {
     Random64 rnd(1);
     KeyGen keygen;
     for (uint64_t i = 0; i < 2 * FLAGS_cache_size; i += FLAGS_value_bytes) {
-      cache_->Insert(keygen.GetRand(rnd, max_key_), createValue(rnd),
-                     FLAGS_value_bytes, &deleter);
+      InsertValue(keygen.GetRand(rnd, max_key_), rnd);
     }
   }
 
@@ -242,6 +336,16 @@ class CacheBench {
           static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
       fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
     }
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    for (uint32_t i = 0; i < FLAGS_threads; i++) {
+      lookups += threads[i]->lookups;
+      hits += threads[i]->hits;
+    }
+    if (lookups > 0) {
+      fprintf(stdout, "Hit ratio = %.2f%%\n", 100.0 * hits / lookups);
+    }
+    PrintMemoryUsage();
     return true;
   }
 
@@ -253,6 +357,7 @@ class CacheBench {
   const uint64_t insert_threshold_;
   const uint64_t lookup_threshold_;
   const uint64_t erase_threshold_;
+  const uint64_t scan_threshold_;
 
   static void ThreadBody(void* v) {
     ThreadState* thread = static_cast<ThreadState*>(v);
@@ -285,6 +390,7 @@ class CacheBench {
     // To hold handles for a non-trivial amount of time
     Cache::Handle* handle = nullptr;
     KeyGen gen;
+    uint64_t scan_key_num = 0;
     for (uint64_t i = 0; i < FLAGS_ops_per_thread; i++) {
       Slice key = gen.GetRand(thread->rnd, max_key_);
       uint64_t random_op = thread->rnd.Next();
@@ -295,14 +401,15 @@ class CacheBench {
         }
         // do lookup
         handle = cache_->Lookup(key);
+        thread->lookups++;
         if (handle) {
+          thread->hits++;
           // do something with the data
           result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                             FLAGS_value_bytes);
+                             cache_->GetCharge(handle));
         } else {
           // do insert
-          cache_->Insert(key, createValue(thread->rnd), FLAGS_value_bytes,
-                         &deleter, &handle);
+          InsertValue(key, thread->rnd, &handle);
         }
       } else if (random_op < insert_threshold_) {
         if (handle) {
@@ -310,8 +417,7 @@ class CacheBench {
           handle = nullptr;
         }
         // do insert
-        cache_->Insert(key, createValue(thread->rnd), FLAGS_value_bytes,
-                       &deleter, &handle);
+        InsertValue(key, thread->rnd, &handle);
       } else if (random_op < lookup_threshold_) {
         if (handle) {
           cache_->Release(handle);
@@ -319,14 +425,28 @@ class CacheBench {
         }
         // do lookup
         handle = cache_->Lookup(key);
+        thread->lookups++;
         if (handle) {
+          thread->hits++;
           // do something with the data
           result += NPHash64(static_cast<char*>(cache_->Value(handle)),
-                             FLAGS_value_bytes);
+                             cache_->GetCharge(handle));
         }
       } else if (random_op < erase_threshold_) {
         // do erase
         cache_->Erase(key);
+      } else if (random_op < scan_threshold_) {
+        // do scan, of keys past the key space that are never read again
+        for (uint32_t j = 0; j < FLAGS_scan_length; j++) {
+          Slice scan_key = gen.Get(max_key_ + (uint64_t{thread->tid} << 40) +
+                                   scan_key_num++);
+          Cache::Handle* scan_handle = cache_->Lookup(scan_key);
+          if (scan_handle) {
+            cache_->Release(scan_handle);
+          } else {
+            InsertValue(scan_key, thread->rnd);
+          }
+        }
       } else {
         // Should be extremely unlikely (noop)
         assert(random_op >= kHundredthUint64 * 100U);
@@ -338,6 +458,27 @@ class CacheBench {
     }
   }
 
+  // Prints the memory used by the process and the allocator against the
+  // usage of the cache, to compare the fragmentation of the allocators.
+  void PrintMemoryUsage() const {
+    double usage = static_cast<double>(cache_->GetUsage());
+    fprintf(stdout, "Cache usage = %.1f MB\n", usage / MiB);
+    uint64_t resident = GetResidentMemory();
+    if (resident > 0) {
+      fprintf(stdout, "Resident memory = %.1f MB (%.3f x cache usage)\n",
+              static_cast<double>(resident) / MiB, resident / usage);
+    }
+    if (FLAGS_use_slab_allocator && value_allocator != nullptr) {
+      auto* allocator = static_cast<SlabMemoryAllocator*>(value_allocator);
+      double total = static_cast<double>(allocator->GetTotalMemory());
+      fprintf(stdout,
+              "Slab allocator memory = %.1f MB (%.3f x cache usage, "
+              "%.1f MB on explicit huge pages)\n",
+              total / MiB, total / usage,
+              static_cast<double>(allocator->GetHugePageMemory()) / MiB);
+    }
+  }
+
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
     printf("Number of threads   : %u\n", FLAGS_threads);
@@ -352,6 +493,12 @@ class CacheBench {
     printf("Insert percentage   : %u%%\n", FLAGS_insert_percent);
     printf("Lookup percentage   : %u%%\n", FLAGS_lookup_percent);
     printf("Erase percentage    : %u%%\n", FLAGS_erase_percent);
+    printf("Scan percentage     : %u%%\n", FLAGS_scan_percent);
+    printf("Scan length         : %u\n", FLAGS_scan_length);
+    printf("Admission control   : %d\n", int{FLAGS_admission_control});
+    printf("Probation pool ratio: %g\n", FLAGS_probation_pool_ratio);
+    printf("Value size spread   : %u\n", FLAGS_value_bytes_spread);
+    printf("Slab allocator      : %d\n", int{FLAGS_use_slab_allocator});
     printf("----------------------------\n");
   }
 };
@@ -0,0 +1,86 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/cache_entry_roles.h"
+
+#include <mutex>
+
+namespace ROCKSDB_NAMESPACE {
+
+const std::array<const char*, kNumCacheEntryRoles>
+    kCacheEntryRoleToHyphenString{{
+        "data-block",
+        "filter-block",
+        "index-block",
+        "compression-dictionary-block",
+        "other-block",
+        "write-buffer",
+        "filter-construction",
+        "block-based-table-reader",
+        "misc",
+    }};
+
+namespace {
+
+struct Registry {
+  std::mutex mutex;
+  std::unordered_map<Cache::DeleterFn, CacheEntryRole> role_map;
+};
+
+Registry& GetRegistry() {
+  // Leaked, so that deleters can still be looked up during static
+  // destruction.
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+template <CacheEntryRole R>
+Cache::DeleterFn GetNoopDeleter() {
+  static Cache::DeleterFn fn = RegisterCacheDeleterRole(
+      [](const Slice& /*key*/, void* /*value*/) {}, R);
+  return fn;
+}
+
+}  // namespace
+
+Cache::DeleterFn RegisterCacheDeleterRole(Cache::DeleterFn fn,
+                                          CacheEntryRole role) {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.role_map[fn] = role;
+  return fn;
+}
+
+std::unordered_map<Cache::DeleterFn, CacheEntryRole> CopyCacheDeleterRoleMap() {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  return registry.role_map;
+}
+
+Cache::DeleterFn GetNoopDeleterForRole(CacheEntryRole role) {
+  switch (role) {
+    case CacheEntryRole::kDataBlock:
+      return GetNoopDeleter<CacheEntryRole::kDataBlock>();
+    case CacheEntryRole::kFilterBlock:
+      return GetNoopDeleter<CacheEntryRole::kFilterBlock>();
+    case CacheEntryRole::kIndexBlock:
+      return GetNoopDeleter<CacheEntryRole::kIndexBlock>();
+    case CacheEntryRole::kCompressionDictionaryBlock:
+      return GetNoopDeleter<CacheEntryRole::kCompressionDictionaryBlock>();
+    case CacheEntryRole::kOtherBlock:
+      return GetNoopDeleter<CacheEntryRole::kOtherBlock>();
+    case CacheEntryRole::kWriteBuffer:
+      return GetNoopDeleter<CacheEntryRole::kWriteBuffer>();
+    case CacheEntryRole::kFilterConstruction:
+      return GetNoopDeleter<CacheEntryRole::kFilterConstruction>();
+    case CacheEntryRole::kBlockBasedTableReader:
+      return GetNoopDeleter<CacheEntryRole::kBlockBasedTableReader>();
+    case CacheEntryRole::kMisc:
+      break;
+  }
+  return GetNoopDeleter<CacheEntryRole::kMisc>();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
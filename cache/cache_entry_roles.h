@@ -0,0 +1,69 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <unordered_map>
+
+#include "rocksdb/cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// What a block cache entry holds. The role of an entry is recorded through
+// its deleter, so that the usage of a cache can be broken down without
+// growing the cache handles.
+enum class CacheEntryRole {
+  // Block-based table data block
+  kDataBlock,
+  // Block-based table filter block (full or partitioned)
+  kFilterBlock,
+  // Block-based table index block
+  kIndexBlock,
+  // Block-based table compression dictionary block
+  kCompressionDictionaryBlock,
+  // Other kinds of block-based table block
+  kOtherBlock,
+  // WriteBufferManager reservations to account for memtable usage
+  kWriteBuffer,
+  // Reservations for the filters of the tables being built
+  kFilterConstruction,
+  // Reservations for the memory of open block-based table readers
+  kBlockBasedTableReader,
+  // Entries of unknown role
+  kMisc,
+};
+constexpr size_t kNumCacheEntryRoles =
+    static_cast<size_t>(CacheEntryRole::kMisc) + 1;
+
+// Names of the roles, such as "data-block", as used in DB properties.
+extern const std::array<const char*, kNumCacheEntryRoles>
+    kCacheEntryRoleToHyphenString;
+
+// Records that the entries inserted with this deleter have this role, and
+// returns the deleter.
+Cache::DeleterFn RegisterCacheDeleterRole(Cache::DeleterFn fn,
+                                          CacheEntryRole role);
+
+// Returns a snapshot of the roles of the registered deleters, to look up
+// many entries without locking.
+std::unordered_map<Cache::DeleterFn, CacheEntryRole> CopyCacheDeleterRoleMap();
+
+// Returns a deleter for entries that hold a T allocated with new, registered
+// with role R.
+template <typename T, CacheEntryRole R>
+Cache::DeleterFn GetCacheEntryDeleterForRole() {
+  static Cache::DeleterFn fn = RegisterCacheDeleterRole(
+      [](const Slice& /*key*/, void* value) { delete static_cast<T*>(value); },
+      R);
+  return fn;
+}
+
+// Returns a deleter that does nothing, registered with this role, for
+// entries that only take up capacity, such as reservations.
+Cache::DeleterFn GetNoopDeleterForRole(CacheEntryRole role);
+
+}  // namespace ROCKSDB_NAMESPACE
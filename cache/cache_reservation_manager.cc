@@ -0,0 +1,130 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/cache_reservation_manager.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+const size_t CacheReservationManager::kSizeDummyEntry;
+
+CacheReservationManager::CacheReservationManager(std::shared_ptr<Cache> cache,
+                                                 CacheEntryRole role)
+    : cache_(std::move(cache)),
+      deleter_(GetNoopDeleterForRole(role)),
+      memory_used_(0),
+      next_cache_key_id_(0) {
+  assert(cache_ != nullptr);
+  memset(cache_key_, 0, kCacheKeyPrefix);
+  size_t pointer_size = sizeof(const void*);
+  assert(pointer_size <= kCacheKeyPrefix);
+  memcpy(cache_key_, static_cast<const void*>(this), pointer_size);
+}
+
+CacheReservationManager::~CacheReservationManager() {
+  for (auto* handle : dummy_handles_) {
+    cache_->Release(handle, true);
+  }
+}
+
+Status CacheReservationManager::UpdateCacheReservation(
+    size_t new_memory_used) {
+  MutexLock l(&mutex_);
+  return UpdateCacheReservationLocked(new_memory_used);
+}
+
+Status CacheReservationManager::MakeCacheReservation(
+    size_t incremental_memory_used,
+    std::unique_ptr<CacheReservationHandle>* handle) {
+  assert(handle != nullptr);
+  handle->reset();
+  {
+    MutexLock l(&mutex_);
+    size_t old_memory_used = memory_used_;
+    Status s =
+        UpdateCacheReservationLocked(old_memory_used + incremental_memory_used);
+    if (!s.ok()) {
+      // Shrinking the reservation cannot fail.
+      UpdateCacheReservationLocked(old_memory_used).PermitUncheckedError();
+      return s;
+    }
+  }
+  handle->reset(
+      new CacheReservationHandle(incremental_memory_used, shared_from_this()));
+  return Status::OK();
+}
+
+void CacheReservationManager::ReleaseCacheReservation(size_t memory_used) {
+  MutexLock l(&mutex_);
+  assert(memory_used_ >= memory_used);
+  UpdateCacheReservationLocked(memory_used_ - memory_used)
+      .PermitUncheckedError();
+}
+
+size_t CacheReservationManager::GetTotalReservedCacheSize() const {
+  MutexLock l(&mutex_);
+  return dummy_handles_.size() * kSizeDummyEntry;
+}
+
+size_t CacheReservationManager::GetTotalMemoryUsed() const {
+  MutexLock l(&mutex_);
+  return memory_used_;
+}
+
+Status CacheReservationManager::UpdateCacheReservationLocked(
+    size_t new_memory_used) {
+  mutex_.AssertHeld();
+  memory_used_ = new_memory_used;
+  Status s;
+  size_t reserved = dummy_handles_.size() * kSizeDummyEntry;
+  while (reserved < new_memory_used) {
+    Cache::Handle* handle = nullptr;
+    s = cache_->Insert(GetNextCacheKey(), nullptr, kSizeDummyEntry, deleter_,
+                       &handle);
+    if (!s.ok()) {
+      s = Status::MemoryLimit("Cannot reserve " +
+                              ToString(new_memory_used - reserved) +
+                              " bytes in cache: " + s.ToString());
+      break;
+    }
+    dummy_handles_.push_back(handle);
+    reserved += kSizeDummyEntry;
+  }
+  // Keep up to one dummy entry in excess, unless nothing is used any more.
+  while (!dummy_handles_.empty() &&
+         (new_memory_used == 0 ||
+          reserved > new_memory_used + kSizeDummyEntry)) {
+    cache_->Release(dummy_handles_.back(), true);
+    dummy_handles_.pop_back();
+    reserved -= kSizeDummyEntry;
+  }
+  return s;
+}
+
+Slice CacheReservationManager::GetNextCacheKey() {
+  memset(cache_key_ + kCacheKeyPrefix, 0, kMaxVarint64Length);
+  char* end =
+      EncodeVarint64(cache_key_ + kCacheKeyPrefix, next_cache_key_id_++);
+  return Slice(cache_key_, static_cast<size_t>(end - cache_key_));
+}
+
+CacheReservationHandle::CacheReservationHandle(
+    size_t incremental_memory_used,
+    std::shared_ptr<CacheReservationManager> manager)
+    : incremental_memory_used_(incremental_memory_used),
+      manager_(std::move(manager)) {
+  assert(manager_ != nullptr);
+}
+
+CacheReservationHandle::~CacheReservationHandle() {
+  manager_->ReleaseCacheReservation(incremental_memory_used_);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
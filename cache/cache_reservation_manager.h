@@ -0,0 +1,104 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "cache/cache_entry_roles.h"
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/status.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CacheReservationHandle;
+
+// Charges memory allocated outside of a cache against its capacity, the way
+// WriteBufferManager charges memtables: dummy entries of kSizeDummyEntry
+// bytes, with no value and a deleter registered with the role of the memory,
+// are inserted until they cover the memory used. The memory used is then
+// bounded by the capacity of the cache together with the blocks, and shows up
+// under its role in the cache entry stats.
+//
+// Thread-safe. Must be owned by a shared_ptr to make reservations through
+// MakeCacheReservation().
+class CacheReservationManager
+    : public std::enable_shared_from_this<CacheReservationManager> {
+ public:
+  static const size_t kSizeDummyEntry = 256 * 1024;
+
+  CacheReservationManager(std::shared_ptr<Cache> cache, CacheEntryRole role);
+  // Releases all the dummy entries.
+  ~CacheReservationManager();
+
+  // No copying allowed
+  CacheReservationManager(const CacheReservationManager&) = delete;
+  CacheReservationManager& operator=(const CacheReservationManager&) = delete;
+
+  // Sets the memory to charge to new_memory_used bytes. The reservation
+  // grows right away, and shrinks once it exceeds the memory used by more
+  // than one dummy entry, so that fluctuating usage does not insert and
+  // erase entries repeatedly. Returns MemoryLimit if the cache has a strict
+  // capacity limit and could not fit the reservation; the memory is then
+  // only partially charged.
+  Status UpdateCacheReservation(size_t new_memory_used);
+
+  // Charges incremental_memory_used more bytes until *handle is destroyed.
+  // On MemoryLimit nothing stays charged and *handle is left empty.
+  Status MakeCacheReservation(size_t incremental_memory_used,
+                              std::unique_ptr<CacheReservationHandle>* handle);
+
+  // Returns the capacity taken up by the dummy entries.
+  size_t GetTotalReservedCacheSize() const;
+
+  // Returns the memory charged.
+  size_t GetTotalMemoryUsed() const;
+
+ private:
+  friend class CacheReservationHandle;
+
+  // Uncharges memory_used bytes, for a CacheReservationHandle.
+  void ReleaseCacheReservation(size_t memory_used);
+
+  Status UpdateCacheReservationLocked(size_t new_memory_used);
+  Slice GetNextCacheKey();
+
+  // The key will be longer than keys for blocks in SST files so they won't
+  // conflict.
+  static const size_t kCacheKeyPrefix = kMaxVarint64Length * 4 + 1;
+
+  std::shared_ptr<Cache> cache_;
+  const Cache::DeleterFn deleter_;
+  mutable port::Mutex mutex_;
+  size_t memory_used_;
+  std::vector<Cache::Handle*> dummy_handles_;
+  // The non-prefix part will be updated according to the ID to use.
+  char cache_key_[kCacheKeyPrefix + kMaxVarint64Length];
+  uint64_t next_cache_key_id_;
+};
+
+// A reservation made through CacheReservationManager::MakeCacheReservation(),
+// released when destroyed. Keeps the manager alive.
+class CacheReservationHandle {
+ public:
+  CacheReservationHandle(size_t incremental_memory_used,
+                         std::shared_ptr<CacheReservationManager> manager);
+  ~CacheReservationHandle();
+
+  // No copying allowed
+  CacheReservationHandle(const CacheReservationHandle&) = delete;
+  CacheReservationHandle& operator=(const CacheReservationHandle&) = delete;
+
+ private:
+  size_t incremental_memory_used_;
+  std::shared_ptr<CacheReservationManager> manager_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
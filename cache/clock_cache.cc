@@ -286,6 +286,9 @@ class ClockCacheShard final : public CacheShard {
   void EraseUnRefEntries() override;
   void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                               bool thread_safe) override;
+  void ApplyToAllEntries(
+      const std::function<void(const Slice& key, void* value, size_t charge,
+                               Cache::DeleterFn deleter)>& callback) override;
 
  private:
   static const uint32_t kInCacheBit = 1;
@@ -422,6 +425,18 @@ void ClockCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void ClockCacheShard::ApplyToAllEntries(
+    const std::function<void(const Slice& key, void* value, size_t charge,
+                             Cache::DeleterFn deleter)>& callback) {
+  MutexLock l(&mutex_);
+  for (auto& handle : list_) {
+    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
+    if (InCache(flags)) {
+      callback(handle.key, handle.value, handle.charge, handle.deleter);
+    }
+  }
+}
+
 void ClockCacheShard::RecycleHandle(CacheHandle* handle,
                                     CleanupContext* context) {
   mutex_.AssertHeld();
@@ -0,0 +1,98 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/frequency_sketch.h"
+
+#include <algorithm>
+
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const uint64_t kSeeds[] = {0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+                           0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+const uint64_t kResetMask = 0x7777777777777777ULL;
+const uint64_t kOneMask = 0x1111111111111111ULL;
+const size_t kMinEntries = 64;
+// Words per entry the sketch is sized for. A row of a key can only use four
+// counters of a word, so a narrower sketch overestimates the frequency of
+// many keys accessed once, which then evict hot ones.
+const size_t kWordsPerEntry = 4;
+}  // namespace
+
+const uint32_t FrequencySketch::kMaxFrequency;
+
+FrequencySketch::FrequencySketch()
+    : table_(kWordsPerEntry * kMinEntries, 0),
+      size_(0),
+      sample_size_(10 * kMinEntries) {}
+
+void FrequencySketch::EnsureCapacity(size_t num_entries) {
+  size_t entries = table_.size() / kWordsPerEntry;
+  if (num_entries <= entries) {
+    return;
+  }
+  while (entries < num_entries) {
+    entries *= 2;
+  }
+  table_.assign(kWordsPerEntry * entries, 0);
+  size_ = 0;
+  sample_size_ = 10 * entries;
+}
+
+void FrequencySketch::Locate(uint32_t hash, int row, size_t* index,
+                             int* shift) const {
+  // The 32-bit hash is spread over 64 bits per row, so that the bits used to
+  // pick the cache shard also affect the position.
+  uint64_t h = (static_cast<uint64_t>(hash) + 1) * kSeeds[row];
+  h ^= h >> 32;
+  *index = static_cast<size_t>(h) & (table_.size() - 1);
+  // Each word holds 16 counters. The rows of a key use consecutive counters,
+  // starting at one of four positions picked by the hash.
+  *shift = static_cast<int>((((hash & 3) << 2) + row) << 2);
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  bool added = false;
+  for (int row = 0; row < 4; row++) {
+    size_t index;
+    int shift;
+    Locate(hash, row, &index, &shift);
+    uint64_t mask = uint64_t{0xf} << shift;
+    if ((table_[index] & mask) != mask) {
+      table_[index] += uint64_t{1} << shift;
+      added = true;
+    }
+  }
+  if (added && ++size_ >= sample_size_) {
+    Reset();
+  }
+}
+
+uint32_t FrequencySketch::Estimate(uint32_t hash) const {
+  uint32_t frequency = kMaxFrequency;
+  for (int row = 0; row < 4; row++) {
+    size_t index;
+    int shift;
+    Locate(hash, row, &index, &shift);
+    frequency = std::min(
+        frequency, static_cast<uint32_t>((table_[index] >> shift) & 0xf));
+  }
+  return frequency;
+}
+
+void FrequencySketch::Reset() {
+  // Halving truncates the odd counters. Each key increments four counters,
+  // so a quarter of the truncations are subtracted from the size.
+  size_t odd = 0;
+  for (auto& word : table_) {
+    odd += static_cast<size_t>(BitsSetToOne(word & kOneMask));
+    word = (word >> 1) & kResetMask;
+  }
+  size_ = size_ > odd / 4 ? (size_ - odd / 4) / 2 : 0;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
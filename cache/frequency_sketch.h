@@ -0,0 +1,54 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Estimates how often keys were accessed recently, for the TinyLFU admission
+// policy (Einziger et al., "TinyLFU: A Highly Efficient Cache Admission
+// Policy", ACM ToS 2017). It is a count-min sketch of four rows of 4-bit
+// counters, sixteen per 64-bit word. Once the number of increments reaches
+// ten times the number of entries the sketch is sized for, all counters are
+// halved, so that the estimates follow changes of the workload.
+//
+// Not thread-safe: the cache shard calls it under its mutex.
+class FrequencySketch {
+ public:
+  static const uint32_t kMaxFrequency = 15;
+
+  FrequencySketch();
+
+  // Grows the sketch, dropping the recorded accesses, if it is sized for
+  // fewer than num_entries keys.
+  void EnsureCapacity(size_t num_entries);
+
+  // Records an access of the key with this hash.
+  void Increment(uint32_t hash);
+
+  // Returns the estimated number of recent accesses of the key with this
+  // hash, at most kMaxFrequency.
+  uint32_t Estimate(uint32_t hash) const;
+
+ private:
+  // Position of the counter of the row in table_, and in its word.
+  void Locate(uint32_t hash, int row, size_t* index, int* shift) const;
+
+  // Halves all counters.
+  void Reset();
+
+  std::vector<uint64_t> table_;
+  // Number of increments since the last reset, less the ones halved.
+  size_t size_;
+  size_t sample_size_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
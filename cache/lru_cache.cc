@@ -12,6 +12,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
 #include <string>
 
 #include "util/mutexlock.h"
@@ -98,20 +99,39 @@ void LRUHandleTable::Resize() {
 LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                              double high_pri_pool_ratio,
                              bool use_adaptive_mutex,
-                             CacheMetadataChargePolicy metadata_charge_policy)
+                             CacheMetadataChargePolicy metadata_charge_policy,
+                             double miss_ratio_curve_sampling_rate,
+                             bool high_pri_admission_control,
+                             bool low_pri_admission_control,
+                             double probation_pool_ratio)
     : capacity_(0),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
       high_pri_pool_ratio_(high_pri_pool_ratio),
+      high_pri_admission_control_(high_pri_admission_control),
+      low_pri_admission_control_(low_pri_admission_control),
       high_pri_pool_capacity_(0),
+      probation_pool_ratio_(probation_pool_ratio),
+      probation_pool_capacity_(0),
+      partition_(0),
       usage_(0),
       lru_usage_(0),
+      probation_usage_(0),
       mutex_(use_adaptive_mutex) {
   set_metadata_charge_policy(metadata_charge_policy);
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
   lru_low_pri_ = &lru_;
+  probation_.next = &probation_;
+  probation_.prev = &probation_;
+  if (miss_ratio_curve_sampling_rate > 0) {
+    mrc_estimator_.reset(
+        new MissRatioCurveEstimator(miss_ratio_curve_sampling_rate));
+  }
+  if (high_pri_admission_control || low_pri_admission_control) {
+    admission_sketch_.reset(new FrequencySketch());
+  }
   SetCapacity(capacity);
 }
 
@@ -119,8 +139,8 @@ void LRUCacheShard::EraseUnRefEntries() {
   autovector<LRUHandle*> last_reference_list;
   {
     MutexLock l(&mutex_);
-    while (lru_.next != &lru_) {
-      LRUHandle* old = lru_.next;
+    while (lru_.next != &lru_ || probation_.next != &probation_) {
+      LRUHandle* old = lru_.next != &lru_ ? lru_.next : probation_.next;
       // LRU list contains only elements which can be evicted
       assert(old->InCache() && !old->HasRefs());
       LRU_Remove(old);
@@ -153,12 +173,26 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void LRUCacheShard::ApplyToAllEntries(
+    const std::function<void(const Slice& key, void* value, size_t charge,
+                             Cache::DeleterFn deleter)>& callback) {
+  MutexLock l(&mutex_);
+  table_.ApplyToAllCacheEntries([&callback](LRUHandle* h) {
+    callback(h->key(), h->value, h->charge, h->deleter);
+  });
+}
+
 void LRUCacheShard::TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri) {
   MutexLock l(&mutex_);
   *lru = &lru_;
   *lru_low_pri = lru_low_pri_;
 }
 
+void LRUCacheShard::TEST_GetProbationList(LRUHandle** probation) {
+  MutexLock l(&mutex_);
+  *probation = &probation_;
+}
+
 size_t LRUCacheShard::TEST_GetLRUSize() {
   MutexLock l(&mutex_);
   LRUHandle* lru_handle = lru_.next;
@@ -167,6 +201,11 @@ size_t LRUCacheShard::TEST_GetLRUSize() {
     lru_size++;
     lru_handle = lru_handle->next;
   }
+  lru_handle = probation_.next;
+  while (lru_handle != &probation_) {
+    lru_size++;
+    lru_handle = lru_handle->next;
+  }
   return lru_size;
 }
 
@@ -191,19 +230,33 @@ void LRUCacheShard::LRU_Remove(LRUHandle* e) {
     assert(high_pri_pool_usage_ >= total_charge);
     high_pri_pool_usage_ -= total_charge;
   }
+  if (e->InProbationPool()) {
+    assert(probation_usage_ >= total_charge);
+    probation_usage_ -= total_charge;
+  }
 }
 
 void LRUCacheShard::LRU_Insert(LRUHandle* e) {
   assert(e->next == nullptr);
   assert(e->prev == nullptr);
   size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
-  if (high_pri_pool_ratio_ > 0 && (e->IsHighPri() || e->HasHit())) {
+  if (probation_pool_ratio_ > 0 && !e->IsHighPri() && !e->HasHit()) {
+    // Insert "e" to the tail of the probation list.
+    e->next = &probation_;
+    e->prev = probation_.prev;
+    e->prev->next = e;
+    e->next->prev = e;
+    e->SetInHighPriPool(false);
+    e->SetInProbationPool(true);
+    probation_usage_ += total_charge;
+  } else if (high_pri_pool_ratio_ > 0 && (e->IsHighPri() || e->HasHit())) {
     // Inset "e" to head of LRU list.
     e->next = &lru_;
     e->prev = lru_.prev;
     e->prev->next = e;
     e->next->prev = e;
     e->SetInHighPriPool(true);
+    e->SetInProbationPool(false);
     high_pri_pool_usage_ += total_charge;
     MaintainPoolSize();
   } else {
@@ -214,6 +267,7 @@ void LRUCacheShard::LRU_Insert(LRUHandle* e) {
     e->prev->next = e;
     e->next->prev = e;
     e->SetInHighPriPool(false);
+    e->SetInProbationPool(false);
     lru_low_pri_ = e;
   }
   lru_usage_ += total_charge;
@@ -232,10 +286,19 @@ void LRUCacheShard::MaintainPoolSize() {
   }
 }
 
+LRUHandle* LRUCacheShard::NextToEvict() {
+  if (probation_.next != &probation_ &&
+      (probation_usage_ >= probation_pool_capacity_ || lru_.next == &lru_)) {
+    return probation_.next;
+  }
+  return lru_.next;
+}
+
 void LRUCacheShard::EvictFromLRU(size_t charge,
                                  autovector<LRUHandle*>* deleted) {
-  while ((usage_ + charge) > capacity_ && lru_.next != &lru_) {
-    LRUHandle* old = lru_.next;
+  while ((usage_ + charge) > capacity_ &&
+         (lru_.next != &lru_ || probation_.next != &probation_)) {
+    LRUHandle* old = NextToEvict();
     // LRU list contains only elements which can be evicted
     assert(old->InCache() && !old->HasRefs());
     LRU_Remove(old);
@@ -248,12 +311,29 @@ void LRUCacheShard::EvictFromLRU(size_t charge,
   }
 }
 
+bool LRUCacheShard::Admit(const Slice& key, uint32_t hash,
+                          size_t total_charge) {
+  // Entries that fit without evicting others are always admitted, as well as
+  // the ones that would not evict any since all entries are referenced.
+  if (usage_ + total_charge <= capacity_ ||
+      (lru_.next == &lru_ && probation_.next == &probation_)) {
+    return true;
+  }
+  if (admission_sketch_->Estimate(hash) >
+      admission_sketch_->Estimate(NextToEvict()->hash)) {
+    return true;
+  }
+  // Do not leave a stale value of the key in the cache.
+  return table_.Lookup(key, hash) != nullptr;
+}
+
 void LRUCacheShard::SetCapacity(size_t capacity) {
   autovector<LRUHandle*> last_reference_list;
   {
     MutexLock l(&mutex_);
     capacity_ = capacity;
     high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+    probation_pool_capacity_ = capacity_ * probation_pool_ratio_;
     EvictFromLRU(0, &last_reference_list);
   }
 
@@ -280,6 +360,12 @@ Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
     e->Ref();
     e->SetHit();
   }
+  if (mrc_estimator_ != nullptr && mrc_estimator_->IsSampled(hash)) {
+    mrc_estimator_->Lookup(hash, capacity_);
+  }
+  if (admission_sketch_ != nullptr) {
+    admission_sketch_->Increment(hash);
+  }
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
@@ -311,8 +397,9 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
     if (last_reference && e->InCache()) {
       // The item is still in cache, and nobody else holds a reference to it
       if (usage_ > capacity_ || force_erase) {
-        // The LRU list must be empty since the cache is full
-        assert(lru_.next == &lru_ || force_erase);
+        // The LRU and probation lists must be empty since the cache is full
+        assert((lru_.next == &lru_ && probation_.next == &probation_) ||
+               force_erase);
         // Take this opportunity and remove the item
         table_.Remove(e->key(), e->hash);
         e->SetInCache(false);
@@ -353,6 +440,7 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   e->charge = charge;
   e->key_length = key.size();
   e->flags = 0;
+  e->partition = partition_;
   e->hash = hash;
   e->refs = 0;
   e->next = e->prev = nullptr;
@@ -364,17 +452,34 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   {
     MutexLock l(&mutex_);
 
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty
-    EvictFromLRU(total_charge, &last_reference_list);
+    if (mrc_estimator_ != nullptr && mrc_estimator_->IsSampled(hash)) {
+      mrc_estimator_->Insert(hash, total_charge, capacity_);
+    }
+
+    bool admitted = !(priority == Cache::Priority::HIGH
+                          ? high_pri_admission_control_
+                          : low_pri_admission_control_) ||
+                    (strict_capacity_limit_ && handle != nullptr) ||
+                    Admit(key, hash, total_charge);
+    if (admitted) {
+      // Free the space following strict LRU policy until enough space
+      // is freed or the lru list is empty
+      EvictFromLRU(total_charge, &last_reference_list);
+    }
 
-    if ((usage_ + total_charge) > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    if (!admitted || ((usage_ + total_charge) > capacity_ &&
+                      (strict_capacity_limit_ || handle == nullptr))) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
         // into cache and get evicted immediately.
         e->SetInCache(false);
         last_reference_list.push_back(e);
+      } else if (!admitted) {
+        // Likewise, but hand out the entry, which is freed on its release.
+        e->SetInCache(false);
+        e->Ref();
+        usage_ += total_charge;
+        *handle = reinterpret_cast<Cache::Handle*>(e);
       } else {
         delete[] reinterpret_cast<char*>(e);
         *handle = nullptr;
@@ -405,6 +510,9 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
         e->Ref();
         *handle = reinterpret_cast<Cache::Handle*>(e);
       }
+      if (admission_sketch_ != nullptr) {
+        admission_sketch_->EnsureCapacity(table_.GetOccupancyCount());
+      }
     }
   }
 
@@ -454,13 +562,26 @@ size_t LRUCacheShard::GetPinnedUsage() const {
   return usage_ - lru_usage_;
 }
 
+void LRUCacheShard::AddMissRatioCurveCounts(uint64_t* lookups,
+                                            uint64_t* hits) const {
+  MutexLock l(&mutex_);
+  if (mrc_estimator_ != nullptr) {
+    mrc_estimator_->AddCounts(lookups, hits);
+  }
+}
+
 std::string LRUCacheShard::GetPrintableOptions() const {
   const int kBufferSize = 200;
   char buffer[kBufferSize];
   {
     MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    high_pri_admission_control: %d\n"
+             "    low_pri_admission_control: %d\n"
+             "    probation_pool_ratio: %.3lf\n",
+             high_pri_pool_ratio_, high_pri_admission_control_,
+             low_pri_admission_control_, probation_pool_ratio_);
   }
   return std::string(buffer);
 }
@@ -469,17 +590,25 @@ LRUCache::LRUCache(size_t capacity, int num_shard_bits,
                    bool strict_capacity_limit, double high_pri_pool_ratio,
                    std::shared_ptr<MemoryAllocator> allocator,
                    bool use_adaptive_mutex,
-                   CacheMetadataChargePolicy metadata_charge_policy)
+                   CacheMetadataChargePolicy metadata_charge_policy,
+                   double miss_ratio_curve_sampling_rate,
+                   bool high_pri_admission_control,
+                   bool low_pri_admission_control,
+                   double probation_pool_ratio, int num_partitions)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
-                   std::move(allocator)) {
-  num_shards_ = 1 << num_shard_bits;
+                   std::move(allocator), num_partitions) {
+  num_shards_ = GetNumShards();
   shards_ = reinterpret_cast<LRUCacheShard*>(
       port::cacheline_aligned_alloc(sizeof(LRUCacheShard) * num_shards_));
   size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i])
         LRUCacheShard(per_shard, strict_capacity_limit, high_pri_pool_ratio,
-                      use_adaptive_mutex, metadata_charge_policy);
+                      use_adaptive_mutex, metadata_charge_policy,
+                      miss_ratio_curve_sampling_rate,
+                      high_pri_admission_control, low_pri_admission_control,
+                      probation_pool_ratio);
+    shards_[i].set_partition(static_cast<uint8_t>(i >> num_shard_bits));
   }
 }
 
@@ -513,6 +642,10 @@ uint32_t LRUCache::GetHash(Handle* handle) const {
   return reinterpret_cast<const LRUHandle*>(handle)->hash;
 }
 
+int LRUCache::GetPartition(Handle* handle) const {
+  return reinterpret_cast<const LRUHandle*>(handle)->partition;
+}
+
 void LRUCache::DisownData() {
 // Do not drop data if compile with ASAN to suppress leak warning.
 #if defined(__clang__)
@@ -528,6 +661,28 @@ void LRUCache::DisownData() {
 #endif  // __clang__
 }
 
+bool LRUCache::GetMissRatioCurve(
+    std::vector<MissRatioCurvePoint>* curve) const {
+  uint64_t lookups = 0;
+  uint64_t hits[MissRatioCurveEstimator::kNumPoints] = {};
+  for (int i = 0; i < num_shards_; i++) {
+    shards_[i].AddMissRatioCurveCounts(&lookups, hits);
+  }
+  if (lookups == 0) {
+    return false;
+  }
+  size_t capacity = GetCapacity();
+  curve->clear();
+  for (size_t i = 0; i < MissRatioCurveEstimator::kNumPoints; i++) {
+    MissRatioCurvePoint point;
+    point.capacity = static_cast<size_t>(
+        MissRatioCurveEstimator::kCapacityMultipliers[i] * capacity);
+    point.miss_ratio = 1.0 - static_cast<double>(hits[i]) / lookups;
+    curve->push_back(point);
+  }
+  return true;
+}
+
 size_t LRUCache::TEST_GetLRUSize() {
   size_t lru_size_of_all_shards = 0;
   for (int i = 0; i < num_shards_; i++) {
@@ -545,31 +700,50 @@ double LRUCache::GetHighPriPoolRatio() {
 }
 
 std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
-  return NewLRUCache(cache_opts.capacity, cache_opts.num_shard_bits,
-                     cache_opts.strict_capacity_limit,
-                     cache_opts.high_pri_pool_ratio,
-                     cache_opts.memory_allocator, cache_opts.use_adaptive_mutex,
-                     cache_opts.metadata_charge_policy);
-}
-
-std::shared_ptr<Cache> NewLRUCache(
-    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-    double high_pri_pool_ratio,
-    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
-    CacheMetadataChargePolicy metadata_charge_policy) {
-  if (num_shard_bits >= 20) {
+  if (cache_opts.num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+  if (cache_opts.high_pri_pool_ratio < 0.0 ||
+      cache_opts.high_pri_pool_ratio > 1.0) {
     // invalid high_pri_pool_ratio
     return nullptr;
   }
+  if (cache_opts.miss_ratio_curve_sampling_rate < 0.0 ||
+      cache_opts.miss_ratio_curve_sampling_rate > 1.0) {
+    return nullptr;
+  }
+  if (cache_opts.probation_pool_ratio < 0.0 ||
+      cache_opts.probation_pool_ratio > 1.0) {
+    return nullptr;
+  }
+  int num_shard_bits = cache_opts.num_shard_bits;
   if (num_shard_bits < 0) {
-    num_shard_bits = GetDefaultCacheShardBits(capacity);
+    num_shard_bits = GetDefaultCacheShardBits(cache_opts.capacity);
+  }
+  int num_partitions = 1;
+  if (cache_opts.numa_aware) {
+    // LRUHandle::partition is a uint8_t.
+    num_partitions = std::min(port::GetNumaNodeCount(), 64);
   }
   return std::make_shared<LRUCache>(
+      cache_opts.capacity, num_shard_bits, cache_opts.strict_capacity_limit,
+      cache_opts.high_pri_pool_ratio, cache_opts.memory_allocator,
+      cache_opts.use_adaptive_mutex, cache_opts.metadata_charge_policy,
+      cache_opts.miss_ratio_curve_sampling_rate,
+      cache_opts.high_pri_admission_control,
+      cache_opts.low_pri_admission_control, cache_opts.probation_pool_ratio,
+      num_partitions);
+}
+
+std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy) {
+  return NewLRUCache(LRUCacheOptions(
       capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
-      std::move(memory_allocator), use_adaptive_mutex, metadata_charge_policy);
+      std::move(memory_allocator), use_adaptive_mutex,
+      metadata_charge_policy));
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -8,8 +8,11 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <memory>
 #include <string>
 
+#include "cache/frequency_sketch.h"
+#include "cache/miss_ratio_curve.h"
 #include "cache/sharded_cache.h"
 
 #include "port/malloc.h"
@@ -69,10 +72,15 @@ struct LRUHandle {
     IN_HIGH_PRI_POOL = (1 << 2),
     // Wwhether this entry has had any lookups (hits).
     HAS_HIT = (1 << 3),
+    // Whether this entry is in the probation pool.
+    IN_PROBATION_POOL = (1 << 4),
   };
 
   uint8_t flags;
 
+  // The partition of the shard holding this entry. See ShardedCache.
+  uint8_t partition;
+
   // Beginning of the key (MUST BE THE LAST FIELD IN THIS STRUCT!)
   char key_data[1];
 
@@ -95,6 +103,7 @@ struct LRUHandle {
   bool IsHighPri() const { return flags & IS_HIGH_PRI; }
   bool InHighPriPool() const { return flags & IN_HIGH_PRI_POOL; }
   bool HasHit() const { return flags & HAS_HIT; }
+  bool InProbationPool() const { return flags & IN_PROBATION_POOL; }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -120,6 +129,14 @@ struct LRUHandle {
     }
   }
 
+  void SetInProbationPool(bool in_probation_pool) {
+    if (in_probation_pool) {
+      flags |= IN_PROBATION_POOL;
+    } else {
+      flags &= ~IN_PROBATION_POOL;
+    }
+  }
+
   void SetHit() { flags |= HAS_HIT; }
 
   void Free() {
@@ -160,6 +177,8 @@ class LRUHandleTable {
   LRUHandle* Insert(LRUHandle* h);
   LRUHandle* Remove(const Slice& key, uint32_t hash);
 
+  uint32_t GetOccupancyCount() const { return elems_; }
+
   template <typename T>
   void ApplyToAllCacheEntries(T func) {
     for (uint32_t i = 0; i < length_; i++) {
@@ -193,7 +212,11 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
  public:
   LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                 double high_pri_pool_ratio, bool use_adaptive_mutex,
-                CacheMetadataChargePolicy metadata_charge_policy);
+                CacheMetadataChargePolicy metadata_charge_policy,
+                double miss_ratio_curve_sampling_rate = 0.0,
+                bool high_pri_admission_control = false,
+                bool low_pri_admission_control = false,
+                double probation_pool_ratio = 0.0);
   virtual ~LRUCacheShard() override = default;
 
   // Separate from constructor so caller can easily make an array of LRUCache
@@ -229,12 +252,18 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
 
+  virtual void ApplyToAllEntries(
+      const std::function<void(const Slice& key, void* value, size_t charge,
+                               Cache::DeleterFn deleter)>& callback) override;
+
   virtual void EraseUnRefEntries() override;
 
   virtual std::string GetPrintableOptions() const override;
 
   void TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri);
 
+  void TEST_GetProbationList(LRUHandle** probation);
+
   //  Retrieves number of elements in LRU, for unit test purpose only
   //  not threadsafe
   size_t TEST_GetLRUSize();
@@ -242,6 +271,13 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   //  Retrives high pri pool ratio
   double GetHighPriPoolRatio();
 
+  // Adds the lookup counts of the miss ratio curve estimator of the shard, if
+  // any. See MissRatioCurveEstimator::AddCounts().
+  void AddMissRatioCurveCounts(uint64_t* lookups, uint64_t* hits) const;
+
+  // Sets the partition recorded in the entries of the shard.
+  void set_partition(uint8_t partition) { partition_ = partition; }
+
  private:
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
@@ -250,12 +286,24 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // high-pri pool is no larger than the size specify by high_pri_pool_pct.
   void MaintainPoolSize();
 
-  // Free some space following strict LRU policy until enough space
-  // to hold (usage_ + charge) is freed or the lru list is empty
+  // Returns the entry evicted first, which is the oldest entry of the
+  // probation list if it holds at least its share of the capacity or the LRU
+  // list is empty, and the least recently used entry otherwise. Requires one
+  // of the lists to be non-empty and mutex_ held.
+  LRUHandle* NextToEvict();
+
+  // Free some space until enough space to hold (usage_ + charge) is freed or
+  // the lru and probation lists are empty, in the order of NextToEvict().
   // This function is not thread safe - it needs to be executed while
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // Returns false if the entry should not be inserted because it would evict
+  // the least recently used entry, which was looked up as often or more
+  // recently. Only called with admission control enabled for the priority of
+  // the entry. Requires mutex_ held.
+  bool Admit(const Slice& key, uint32_t hash, size_t total_charge);
+
   // Initialized before use.
   size_t capacity_;
 
@@ -268,10 +316,23 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // Ratio of capacity reserved for high priority cache entries.
   double high_pri_pool_ratio_;
 
+  // Whether insertions of each priority are subject to admission control.
+  bool high_pri_admission_control_;
+  bool low_pri_admission_control_;
+
   // High-pri pool size, equals to capacity * high_pri_pool_ratio.
   // Remember the value to avoid recomputing each time.
   double high_pri_pool_capacity_;
 
+  // Ratio of capacity for low priority entries that have not been hit yet.
+  double probation_pool_ratio_;
+
+  // Probation pool size, equals to capacity * probation_pool_ratio.
+  double probation_pool_capacity_;
+
+  // The partition of the shard, recorded in its entries.
+  uint8_t partition_;
+
   // Dummy head of LRU list.
   // lru.prev is newest entry, lru.next is oldest entry.
   // LRU contains items which can be evicted, ie reference only by cache
@@ -280,6 +341,12 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // Pointer to head of low-pri pool in LRU list.
   LRUHandle* lru_low_pri_;
 
+  // Dummy head of the probation list, a FIFO of the evictable low priority
+  // entries not hit since their insertion when probation_pool_ratio > 0.
+  // probation.prev is newest entry, probation.next is oldest entry. A hit
+  // entry moves to the LRU list on its release.
+  LRUHandle probation_;
+
   // ------------^^^^^^^^^^^^^-----------
   // Not frequently modified data members
   // ------------------------------------
@@ -296,9 +363,19 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // Memory size for entries residing in the cache
   size_t usage_;
 
-  // Memory size for entries residing only in the LRU list
+  // Memory size for entries residing only in the LRU or probation list
   size_t lru_usage_;
 
+  // Memory size for entries in the probation list.
+  size_t probation_usage_;
+
+  // Estimates the miss ratio curve of the shard if enabled, or nullptr.
+  std::unique_ptr<MissRatioCurveEstimator> mrc_estimator_;
+
+  // Access frequencies of the looked up keys if admission control is enabled
+  // for some priority, or nullptr.
+  std::unique_ptr<FrequencySketch> admission_sketch_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
@@ -316,7 +393,11 @@ class LRUCache
            std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
            bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
            CacheMetadataChargePolicy metadata_charge_policy =
-               kDontChargeCacheMetadata);
+               kDontChargeCacheMetadata,
+           double miss_ratio_curve_sampling_rate = 0.0,
+           bool high_pri_admission_control = false,
+           bool low_pri_admission_control = false,
+           double probation_pool_ratio = 0.0, int num_partitions = 1);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -324,7 +405,10 @@ class LRUCache
   virtual void* Value(Handle* handle) override;
   virtual size_t GetCharge(Handle* handle) const override;
   virtual uint32_t GetHash(Handle* handle) const override;
+  virtual int GetPartition(Handle* handle) const override;
   virtual void DisownData() override;
+  virtual bool GetMissRatioCurve(
+      std::vector<MissRatioCurvePoint>* curve) const override;
 
   //  Retrieves number of elements in LRU, for unit test purpose only
   size_t TEST_GetLRUSize();
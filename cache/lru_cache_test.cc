@@ -7,8 +7,11 @@
 
 #include <string>
 #include <vector>
+#include "cache/cache_reservation_manager.h"
 #include "port/port.h"
+#include "test_util/sync_point.h"
 #include "test_util/testharness.h"
+#include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -26,13 +29,17 @@ class LRUCacheTest : public testing::Test {
   }
 
   void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
-                bool use_adaptive_mutex = kDefaultToAdaptiveMutex) {
+                bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+                double probation_pool_ratio = 0.0) {
     DeleteCache();
     cache_ = reinterpret_cast<LRUCacheShard*>(
         port::cacheline_aligned_alloc(sizeof(LRUCacheShard)));
-    new (cache_) LRUCacheShard(capacity, false /*strict_capcity_limit*/,
-                               high_pri_pool_ratio, use_adaptive_mutex,
-                               kDontChargeCacheMetadata);
+    new (cache_) LRUCacheShard(
+        capacity, false /*strict_capcity_limit*/, high_pri_pool_ratio,
+        use_adaptive_mutex, kDontChargeCacheMetadata,
+        0.0 /*miss_ratio_curve_sampling_rate*/,
+        false /*high_pri_admission_control*/,
+        false /*low_pri_admission_control*/, probation_pool_ratio);
   }
 
   void Insert(const std::string& key,
@@ -88,6 +95,20 @@ class LRUCacheTest : public testing::Test {
     ASSERT_EQ(num_high_pri_pool_keys, high_pri_pool_keys);
   }
 
+  void ValidateProbationList(std::vector<std::string> keys) {
+    LRUHandle* probation;
+    cache_->TEST_GetProbationList(&probation);
+    LRUHandle* iter = probation;
+    for (const auto& key : keys) {
+      iter = iter->next;
+      ASSERT_NE(probation, iter);
+      ASSERT_EQ(key, iter->key().ToString());
+      ASSERT_TRUE(iter->InProbationPool());
+      ASSERT_FALSE(iter->InHighPriPool());
+    }
+    ASSERT_EQ(probation, iter->next);
+  }
+
  private:
   LRUCacheShard* cache_ = nullptr;
 };
@@ -191,6 +212,362 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+
+TEST_F(LRUCacheTest, MissRatioCurveEstimator) {
+  // Cyclic accesses to 150 keys of charge 1 only hit in caches of capacity
+  // 150 or more.
+  MissRatioCurveEstimator estimator(1.0 /* sampling_rate */);
+  const size_t kCapacity = 100;
+  const int kNumKeys = 150;
+  const int kNumRounds = 10;
+  for (int round = 0; round < kNumRounds; round++) {
+    for (uint32_t key = 0; key < kNumKeys; key++) {
+      ASSERT_TRUE(estimator.IsSampled(key));
+      estimator.Lookup(key, kCapacity);
+      estimator.Insert(key, 1, kCapacity);
+    }
+  }
+  uint64_t lookups = 0;
+  uint64_t hits[MissRatioCurveEstimator::kNumPoints] = {};
+  estimator.AddCounts(&lookups, hits);
+  ASSERT_EQ(kNumKeys * kNumRounds, lookups);
+  for (size_t i = 0; i < MissRatioCurveEstimator::kNumPoints; i++) {
+    if (MissRatioCurveEstimator::kCapacityMultipliers[i] * kCapacity >=
+        kNumKeys) {
+      // All but the first round.
+      ASSERT_EQ(kNumKeys * (kNumRounds - 1), hits[i]);
+    } else {
+      ASSERT_EQ(0, hits[i]);
+    }
+  }
+}
+
+TEST_F(LRUCacheTest, SampledMissRatioCurve) {
+  LRUCacheOptions opts;
+  opts.capacity = 2000;
+  opts.num_shard_bits = 0;
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  std::vector<MissRatioCurvePoint> curve;
+  ASSERT_FALSE(cache->GetMissRatioCurve(&curve));
+
+  opts.miss_ratio_curve_sampling_rate = 0.1;
+  cache = NewLRUCache(opts);
+  ASSERT_FALSE(cache->GetMissRatioCurve(&curve));
+  // The working set fits in half of the cache.
+  const int kNumKeys = 1000;
+  const int kNumRounds = 10;
+  uint64_t misses = 0;
+  for (int round = 0; round < kNumRounds; round++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      std::string key = "key" + ToString(i);
+      Cache::Handle* handle = cache->Lookup(key);
+      if (handle != nullptr) {
+        cache->Release(handle);
+      } else {
+        misses++;
+        ASSERT_OK(cache->Insert(key, nullptr, 1, nullptr));
+      }
+    }
+  }
+  ASSERT_EQ(kNumKeys, misses);
+
+  ASSERT_TRUE(cache->GetMissRatioCurve(&curve));
+  ASSERT_EQ(MissRatioCurveEstimator::kNumPoints, curve.size());
+  for (size_t i = 0; i < curve.size(); i++) {
+    ASSERT_EQ(static_cast<size_t>(
+                  MissRatioCurveEstimator::kCapacityMultipliers[i] * 2000),
+              curve[i].capacity);
+    if (i > 0) {
+      ASSERT_LE(curve[i].miss_ratio, curve[i - 1].miss_ratio);
+    }
+    if (curve[i].capacity < 800) {
+      ASSERT_EQ(1.0, curve[i].miss_ratio);
+    } else if (curve[i].capacity > 1200) {
+      // Only the first round misses.
+      ASSERT_NEAR(1.0 / kNumRounds, curve[i].miss_ratio, 0.01);
+    }
+  }
+  ASSERT_NEAR(static_cast<double>(misses) / (kNumKeys * kNumRounds),
+              curve[3].miss_ratio, 0.01);
+
+  opts.miss_ratio_curve_sampling_rate = 1.5;
+  ASSERT_EQ(nullptr, NewLRUCache(opts));
+}
+
+TEST_F(LRUCacheTest, ProbationPool) {
+  // The probation pool takes 2 of the 5 entries.
+  NewCache(5, 0.0 /*high_pri_pool_ratio*/, kDefaultToAdaptiveMutex,
+           0.4 /*probation_pool_ratio*/);
+  for (char ch = 'a'; ch <= 'e'; ch++) {
+    Insert(ch);
+  }
+  ValidateLRUList({});
+  ValidateProbationList({"a", "b", "c", "d", "e"});
+
+  // Hit entries move to the LRU list.
+  ASSERT_TRUE(Lookup('a'));
+  ASSERT_TRUE(Lookup('b'));
+  ValidateLRUList({"a", "b"});
+  ValidateProbationList({"c", "d", "e"});
+
+  // Entries read once only replace each other while the probation pool is
+  // over its share.
+  for (char ch = 'f'; ch <= 'h'; ch++) {
+    Insert(ch);
+  }
+  ValidateLRUList({"a", "b"});
+  ValidateProbationList({"f", "g", "h"});
+  ASSERT_FALSE(Lookup('c'));
+  ASSERT_TRUE(Lookup('f'));
+  ValidateLRUList({"a", "b", "f"});
+  ValidateProbationList({"g", "h"});
+  Insert('i');
+  ValidateLRUList({"a", "b", "f"});
+  ValidateProbationList({"h", "i"});
+
+  // High priority entries are inserted into the LRU list directly.
+  Insert('X', Cache::Priority::HIGH);
+  ValidateLRUList({"a", "b", "f", "X"});
+  ValidateProbationList({"i"});
+
+  // Below its share, the probation pool grows at the expense of the LRU list.
+  Insert('j');
+  ValidateLRUList({"b", "f", "X"});
+  ValidateProbationList({"i", "j"});
+
+  // Re-inserting a key puts it back on probation.
+  Insert('b');
+  ValidateLRUList({"f", "X"});
+  ValidateProbationList({"j", "b"});
+  Erase("j");
+  ValidateProbationList({"b"});
+
+  LRUCacheOptions opts(5, 0 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.0 /*high_pri_pool_ratio*/);
+  opts.probation_pool_ratio = 1.5;
+  ASSERT_EQ(nullptr, NewLRUCache(opts));
+}
+
+TEST_F(LRUCacheTest, FrequencySketch) {
+  FrequencySketch sketch;
+  for (int i = 0; i < 5; i++) {
+    sketch.Increment(1);
+  }
+  sketch.Increment(2);
+  ASSERT_EQ(5, sketch.Estimate(1));
+  ASSERT_EQ(1, sketch.Estimate(2));
+  ASSERT_EQ(0, sketch.Estimate(3));
+  for (int i = 0; i < 20; i++) {
+    sketch.Increment(3);
+  }
+  ASSERT_EQ(FrequencySketch::kMaxFrequency, sketch.Estimate(3));
+
+  // The counts are halved once the increments reach ten times the number of
+  // entries the sketch is sized for.
+  sketch.EnsureCapacity(100);
+  ASSERT_EQ(0, sketch.Estimate(1));
+  for (int i = 0; i < 8; i++) {
+    sketch.Increment(1);
+  }
+  ASSERT_EQ(8, sketch.Estimate(1));
+  for (uint32_t key = 100; key < 100 + 10 * 128; key++) {
+    sketch.Increment(key);
+  }
+  // Other keys may share some of its counters.
+  ASSERT_GE(sketch.Estimate(1), 4);
+  ASSERT_LT(sketch.Estimate(1), 8);
+}
+
+TEST_F(LRUCacheTest, AdmissionControl) {
+  const int kNumHotKeys = 100;
+  const int kNumScanKeys = 500;
+  // Looks up the key, inserting it on a miss.
+  auto read = [](Cache* cache, const std::string& key,
+                 Cache::Priority priority) {
+    Cache::Handle* handle = cache->Lookup(key);
+    if (handle != nullptr) {
+      cache->Release(handle);
+      return true;
+    }
+    EXPECT_OK(
+        cache->Insert(key, nullptr, 1, nullptr, nullptr /*handle*/, priority));
+    return false;
+  };
+  for (bool admission_control : {false, true}) {
+    LRUCacheOptions opts(kNumHotKeys, 0 /*num_shard_bits*/,
+                         false /*strict_capacity_limit*/,
+                         0.0 /*high_pri_pool_ratio*/);
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.low_pri_admission_control = admission_control;
+    std::shared_ptr<Cache> cache = NewLRUCache(opts);
+    for (int round = 0; round < 3; round++) {
+      for (int i = 0; i < kNumHotKeys; i++) {
+        read(cache.get(), "hot" + ToString(i), Cache::Priority::LOW);
+      }
+    }
+    for (int i = 0; i < kNumScanKeys; i++) {
+      read(cache.get(), "scan" + ToString(i), Cache::Priority::LOW);
+    }
+    int hits = 0;
+    for (int i = 0; i < kNumHotKeys; i++) {
+      if (read(cache.get(), "hot" + ToString(i), Cache::Priority::LOW)) {
+        hits++;
+      }
+    }
+    ASSERT_EQ(admission_control ? kNumHotKeys : 0, hits);
+    ASSERT_EQ(kNumHotKeys, cache->GetUsage());
+    if (!admission_control) {
+      continue;
+    }
+
+    // A rejected entry can still be referenced until its release.
+    Cache::Handle* handle = nullptr;
+    ASSERT_OK(cache->Insert("pinned", nullptr, 1, nullptr, &handle));
+    ASSERT_NE(nullptr, handle);
+    ASSERT_EQ(kNumHotKeys + 1, cache->GetUsage());
+    ASSERT_EQ(1, cache->GetPinnedUsage());
+    ASSERT_EQ(nullptr, cache->Lookup("pinned"));
+    cache->Release(handle);
+    ASSERT_EQ(kNumHotKeys, cache->GetUsage());
+
+    // Entries of high priority are not subject to admission control.
+    ASSERT_FALSE(read(cache.get(), "high", Cache::Priority::HIGH));
+    ASSERT_TRUE(read(cache.get(), "high", Cache::Priority::HIGH));
+  }
+}
+
+TEST_F(LRUCacheTest, CacheReservationManager) {
+  const size_t kDummy = CacheReservationManager::kSizeDummyEntry;
+  LRUCacheOptions opts(16 * kDummy, 0 /*num_shard_bits*/,
+                       true /*strict_capacity_limit*/,
+                       0.0 /*high_pri_pool_ratio*/);
+  opts.metadata_charge_policy = kDontChargeCacheMetadata;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  auto manager = std::make_shared<CacheReservationManager>(
+      cache, CacheEntryRole::kFilterConstruction);
+
+  // The reservation is rounded up to whole dummy entries.
+  ASSERT_OK(manager->UpdateCacheReservation(3 * kDummy + 1));
+  ASSERT_EQ(4 * kDummy, manager->GetTotalReservedCacheSize());
+  ASSERT_EQ(4 * kDummy, cache->GetUsage());
+  // It keeps up to one dummy entry in excess.
+  ASSERT_OK(manager->UpdateCacheReservation(2 * kDummy + 1));
+  ASSERT_EQ(3 * kDummy, manager->GetTotalReservedCacheSize());
+  ASSERT_OK(manager->UpdateCacheReservation(kDummy));
+  ASSERT_EQ(2 * kDummy, manager->GetTotalReservedCacheSize());
+
+  // The dummy entries are accounted to the role of the manager.
+  auto role_map = CopyCacheDeleterRoleMap();
+  size_t count = 0;
+  cache->ApplyToAllEntries([&](const Slice& /*key*/, void* value,
+                               size_t charge, Cache::DeleterFn deleter) {
+    ASSERT_EQ(nullptr, value);
+    ASSERT_EQ(kDummy, charge);
+    ASSERT_EQ(CacheEntryRole::kFilterConstruction, role_map[deleter]);
+    count++;
+  });
+  ASSERT_EQ(2, count);
+
+  std::unique_ptr<CacheReservationHandle> handle;
+  ASSERT_OK(manager->MakeCacheReservation(4 * kDummy, &handle));
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(5 * kDummy, manager->GetTotalMemoryUsed());
+  ASSERT_EQ(5 * kDummy, manager->GetTotalReservedCacheSize());
+  handle.reset();
+  ASSERT_EQ(kDummy, manager->GetTotalMemoryUsed());
+  ASSERT_EQ(2 * kDummy, manager->GetTotalReservedCacheSize());
+
+  // A reservation over the strict capacity limit fails without a trace.
+  Status s = manager->MakeCacheReservation(16 * kDummy, &handle);
+  ASSERT_TRUE(s.IsMemoryLimit());
+  ASSERT_EQ(nullptr, handle);
+  ASSERT_EQ(kDummy, manager->GetTotalMemoryUsed());
+  ASSERT_EQ(2 * kDummy, manager->GetTotalReservedCacheSize());
+  ASSERT_EQ(2 * kDummy, cache->GetUsage());
+
+  ASSERT_OK(manager->UpdateCacheReservation(0));
+  ASSERT_EQ(0, manager->GetTotalReservedCacheSize());
+  ASSERT_EQ(0, cache->GetUsage());
+}
+
+TEST_F(LRUCacheTest, NumaPartitions) {
+  // Two partitions of two shards each, whatever the NUMA topology.
+  LRUCache cache(4 * 1024 * 1024, 1 /*num_shard_bits*/,
+                 false /*strict_capacity_limit*/, 0.0 /*high_pri_pool_ratio*/,
+                 nullptr /*memory_allocator*/, kDefaultToAdaptiveMutex,
+                 kDontChargeCacheMetadata, 0.0 /*miss_ratio_curve_sampling_rate*/,
+                 false /*high_pri_admission_control*/,
+                 false /*low_pri_admission_control*/,
+                 0.0 /*probation_pool_ratio*/, 2 /*num_partitions*/);
+  ASSERT_EQ(2, cache.GetNumPartitions());
+  ASSERT_EQ(4, cache.GetNumShards());
+
+  std::atomic<int> local_partition(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "ShardedCache::GetLocalPartition",
+      [&](void* arg) { *static_cast<int*>(arg) = local_partition.load(); });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto shard_usage = [&](int partition) {
+    return cache.GetShard(2 * partition)->GetUsage() +
+           cache.GetShard(2 * partition + 1)->GetUsage();
+  };
+
+  // Inserted into the partition of the inserting thread.
+  ASSERT_OK(cache.Insert("a", nullptr, 100, nullptr, nullptr,
+                         Cache::Priority::LOW));
+  ASSERT_EQ(100U, shard_usage(0));
+  ASSERT_EQ(0U, shard_usage(1));
+
+  // Found from the other partition too.
+  local_partition = 1;
+  Cache::Handle* handle = cache.Lookup("a", nullptr);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(0, cache.GetPartition(handle));
+  ASSERT_TRUE(cache.Ref(handle));
+  ASSERT_FALSE(cache.Release(handle));
+  ASSERT_FALSE(cache.Release(handle));
+  ASSERT_EQ(0U, cache.GetPinnedUsage());
+
+  // The local copy is found first.
+  ASSERT_OK(cache.Insert("a", nullptr, 200, nullptr, nullptr,
+                         Cache::Priority::LOW));
+  ASSERT_EQ(200U, shard_usage(1));
+  handle = cache.Lookup("a", nullptr);
+  ASSERT_NE(nullptr, handle);
+  ASSERT_EQ(1, cache.GetPartition(handle));
+  ASSERT_EQ(200U, cache.GetCharge(handle));
+  cache.Release(handle);
+
+  // Erased from all the partitions.
+  cache.Erase("a");
+  ASSERT_EQ(0U, cache.GetUsage());
+  local_partition = 0;
+  ASSERT_EQ(nullptr, cache.Lookup("a", nullptr));
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(LRUCacheTest, NumaAwareOption) {
+  // Without NUMA support, or on a single node, there is one partition.
+  LRUCacheOptions opts(1024 * 1024, 2 /*num_shard_bits*/,
+                       false /*strict_capacity_limit*/,
+                       0.0 /*high_pri_pool_ratio*/);
+  opts.numa_aware = true;
+  std::shared_ptr<Cache> cache = NewLRUCache(opts);
+  ASSERT_NE(nullptr, cache);
+  auto* sharded_cache = static_cast<ShardedCache*>(cache.get());
+  ASSERT_EQ(port::GetNumaNodeCount(), sharded_cache->GetNumPartitions());
+  ASSERT_EQ(4 * port::GetNumaNodeCount(), sharded_cache->GetNumShards());
+  ASSERT_OK(cache->Insert("a", nullptr, 1, nullptr));
+  Cache::Handle* handle = cache->Lookup("a");
+  ASSERT_NE(nullptr, handle);
+  cache->Release(handle);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
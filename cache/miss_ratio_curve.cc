@@ -0,0 +1,136 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/miss_ratio_curve.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ROCKSDB_NAMESPACE {
+
+const size_t MissRatioCurveEstimator::kNumPoints;
+const double MissRatioCurveEstimator::kCapacityMultipliers[kNumPoints] = {
+    0.25, 0.5, 0.75, 1.0, 1.25, 1.5, 2.0, 3.0, 4.0};
+
+MissRatioCurveEstimator::MissRatioCurveEstimator(double sampling_rate)
+    : sampling_rate_(sampling_rate),
+      sampling_threshold_(static_cast<uint32_t>(
+          std::min(sampling_rate, 1.0) * (kSamplingMask + 1.0))),
+      tree_(1024 + 1, 0),
+      clock_(0),
+      total_charge_(0),
+      lookups_(0) {
+  assert(sampling_rate > 0);
+  std::fill(hits_, hits_ + kNumPoints, 0);
+}
+
+void MissRatioCurveEstimator::Lookup(uint32_t hash, size_t capacity) {
+  auto it = index_.find(hash);
+  if (it != index_.end()) {
+    // Charge of the entries accessed since the previous access, including
+    // this one.
+    uint64_t distance = total_charge_ - TreeSum(it->second->time - 1);
+    double scaled_distance = distance / sampling_rate_;
+    for (size_t i = 0; i < kNumPoints; i++) {
+      if (scaled_distance <= kCapacityMultipliers[i] * capacity) {
+        hits_[i]++;
+      }
+    }
+  }
+  if (++lookups_ >= kDecayPeriod) {
+    lookups_ /= 2;
+    for (size_t i = 0; i < kNumPoints; i++) {
+      hits_[i] /= 2;
+    }
+  }
+  Touch(hash);
+  Evict(capacity);
+}
+
+void MissRatioCurveEstimator::Insert(uint32_t hash, size_t charge,
+                                     size_t capacity) {
+  auto e = Touch(hash);
+  TreeAdd(e->time, static_cast<int64_t>(charge) -
+                       static_cast<int64_t>(e->charge));
+  e->charge = charge;
+  Evict(capacity);
+}
+
+void MissRatioCurveEstimator::AddCounts(uint64_t* lookups,
+                                        uint64_t* hits) const {
+  *lookups += lookups_;
+  for (size_t i = 0; i < kNumPoints; i++) {
+    hits[i] += hits_[i];
+  }
+}
+
+std::list<MissRatioCurveEstimator::Entry>::iterator
+MissRatioCurveEstimator::Touch(uint32_t hash) {
+  if (clock_ + 1 >= tree_.size()) {
+    Renumber();
+  }
+  std::list<Entry>::iterator e;
+  auto it = index_.find(hash);
+  if (it != index_.end()) {
+    e = it->second;
+    TreeAdd(e->time, -static_cast<int64_t>(e->charge));
+    stack_.splice(stack_.begin(), stack_, e);
+  } else {
+    stack_.push_front(Entry{hash, 0, 0});
+    e = stack_.begin();
+    index_.emplace(hash, e);
+  }
+  e->time = ++clock_;
+  TreeAdd(e->time, static_cast<int64_t>(e->charge));
+  return e;
+}
+
+void MissRatioCurveEstimator::Evict(size_t capacity) {
+  // The next lookup of the least recently accessed entry has a distance of
+  // at least total_charge_, so it cannot hit if that is over the largest
+  // estimated capacity.
+  const double max_charge =
+      kCapacityMultipliers[kNumPoints - 1] * capacity * sampling_rate_;
+  while (!stack_.empty() &&
+         (stack_.size() > kMaxEntries || total_charge_ > max_charge)) {
+    const Entry& e = stack_.back();
+    TreeAdd(e.time, -static_cast<int64_t>(e.charge));
+    index_.erase(e.hash);
+    stack_.pop_back();
+  }
+}
+
+void MissRatioCurveEstimator::TreeAdd(size_t time, int64_t delta) {
+  assert(time > 0);
+  for (size_t i = time; i < tree_.size(); i += i & (~i + 1)) {
+    tree_[i] += static_cast<uint64_t>(delta);
+  }
+  total_charge_ += static_cast<uint64_t>(delta);
+}
+
+uint64_t MissRatioCurveEstimator::TreeSum(size_t time) const {
+  uint64_t sum = 0;
+  for (size_t i = time; i > 0; i -= i & (~i + 1)) {
+    sum += tree_[i];
+  }
+  return sum;
+}
+
+void MissRatioCurveEstimator::Renumber() {
+  size_t size = tree_.size() - 1;
+  // Keep at least half of the tree for the following accesses.
+  while (2 * (stack_.size() + 1) > size) {
+    size *= 2;
+  }
+  tree_.assign(size + 1, 0);
+  total_charge_ = 0;
+  clock_ = 0;
+  for (auto it = stack_.rbegin(); it != stack_.rend(); ++it) {
+    it->time = ++clock_;
+    TreeAdd(it->time, static_cast<int64_t>(it->charge));
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,97 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Estimates the miss ratio of an LRU cache at several multiples of its
+// capacity from the lookups it serves, following SHARDS (Waldspurger et al.,
+// "Efficient MRC Construction with SHARDS", FAST '15). Only the keys whose
+// hash falls below a threshold are tracked, and the reuse distance of each
+// lookup of a tracked key, in bytes of the distinct tracked entries accessed
+// since its previous access, is scaled by the sampling rate. A lookup hits in
+// an LRU cache of capacity C iff its scaled reuse distance is at most C.
+//
+// The counts decay by half periodically, so that the curve follows changes of
+// the workload. Not thread-safe: the cache shard calls it under its mutex.
+class MissRatioCurveEstimator {
+ public:
+  static const size_t kNumPoints = 9;
+  // The capacities at which the miss ratio is estimated, as multiples of the
+  // capacity of the cache.
+  static const double kCapacityMultipliers[kNumPoints];
+
+  // sampling_rate is the fraction of the keys tracked, in (0, 1].
+  explicit MissRatioCurveEstimator(double sampling_rate);
+
+  // Returns true if the key with this hash is tracked.
+  bool IsSampled(uint32_t hash) const {
+    return (hash & kSamplingMask) < sampling_threshold_;
+  }
+
+  // Records a lookup of a tracked key in a cache of the given capacity.
+  void Lookup(uint32_t hash, size_t capacity);
+
+  // Records the insertion of a tracked key with the given charge.
+  void Insert(uint32_t hash, size_t charge, size_t capacity);
+
+  // Adds the number of lookups recorded to *lookups, and the number of them
+  // that hit at each of the kNumPoints capacities to hits[].
+  void AddCounts(uint64_t* lookups, uint64_t* hits) const;
+
+ private:
+  static const uint32_t kSamplingMask = (1 << 24) - 1;
+  // The counts are halved after this many lookups.
+  static const uint64_t kDecayPeriod = 1 << 16;
+  // Bound on the tracked entries, including the ones never inserted.
+  static const size_t kMaxEntries = 1 << 16;
+
+  struct Entry {
+    uint32_t hash;
+    size_t charge;
+    // Position of the last access in tree_.
+    size_t time;
+  };
+
+  // Moves the entry to the top of the stack, inserting it if needed, and
+  // returns it.
+  std::list<Entry>::iterator Touch(uint32_t hash);
+
+  // Removes the least recently accessed entries that could not hit at any of
+  // the estimated capacities.
+  void Evict(size_t capacity);
+
+  // Fenwick tree of the charges of the entries indexed by access time.
+  void TreeAdd(size_t time, int64_t delta);
+  uint64_t TreeSum(size_t time) const;
+
+  // Assigns consecutive times to the entries when the clock reaches the
+  // size of the tree, growing the tree if needed.
+  void Renumber();
+
+  const double sampling_rate_;
+  const uint32_t sampling_threshold_;
+
+  // Most recently accessed first.
+  std::list<Entry> stack_;
+  std::unordered_map<uint32_t, std::list<Entry>::iterator> index_;
+  std::vector<uint64_t> tree_;
+  size_t clock_;
+  uint64_t total_charge_;
+
+  uint64_t lookups_;
+  uint64_t hits_[kNumPoints];
+};
+
+}  // namespace ROCKSDB_NAMESPACE
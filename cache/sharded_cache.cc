@@ -11,21 +11,24 @@
 
 #include <string>
 
+#include "test_util/sync_point.h"
 #include "util/mutexlock.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 ShardedCache::ShardedCache(size_t capacity, int num_shard_bits,
                            bool strict_capacity_limit,
-                           std::shared_ptr<MemoryAllocator> allocator)
+                           std::shared_ptr<MemoryAllocator> allocator,
+                           int num_partitions)
     : Cache(std::move(allocator)),
       num_shard_bits_(num_shard_bits),
+      num_partitions_(num_partitions),
       capacity_(capacity),
       strict_capacity_limit_(strict_capacity_limit),
       last_id_(1) {}
 
 void ShardedCache::SetCapacity(size_t capacity) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   const size_t per_shard = (capacity + (num_shards - 1)) / num_shards;
   MutexLock l(&capacity_mutex_);
   for (int s = 0; s < num_shards; s++) {
@@ -35,7 +38,7 @@ void ShardedCache::SetCapacity(size_t capacity) {
 }
 
 void ShardedCache::SetStrictCapacityLimit(bool strict_capacity_limit) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   MutexLock l(&capacity_mutex_);
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->SetStrictCapacityLimit(strict_capacity_limit);
@@ -47,28 +50,50 @@ Status ShardedCache::Insert(const Slice& key, void* value, size_t charge,
                             void (*deleter)(const Slice& key, void* value),
                             Handle** handle, Priority priority) {
   uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))
+  return GetShard(Shard(GetLocalPartition(), hash))
       ->Insert(key, hash, value, charge, deleter, handle, priority);
 }
 
 Cache::Handle* ShardedCache::Lookup(const Slice& key, Statistics* /*stats*/) {
   uint32_t hash = HashSlice(key);
-  return GetShard(Shard(hash))->Lookup(key, hash);
+  if (num_partitions_ == 1) {
+    return GetShard(Shard(hash))->Lookup(key, hash);
+  }
+  int local_partition = GetLocalPartition();
+  Handle* handle = GetShard(Shard(local_partition, hash))->Lookup(key, hash);
+  for (int p = 0; handle == nullptr && p < num_partitions_; p++) {
+    if (p != local_partition) {
+      handle = GetShard(Shard(p, hash))->Lookup(key, hash);
+    }
+  }
+  return handle;
 }
 
 bool ShardedCache::Ref(Handle* handle) {
   uint32_t hash = GetHash(handle);
-  return GetShard(Shard(hash))->Ref(handle);
+  return GetShard(Shard(GetPartition(handle), hash))->Ref(handle);
 }
 
 bool ShardedCache::Release(Handle* handle, bool force_erase) {
   uint32_t hash = GetHash(handle);
-  return GetShard(Shard(hash))->Release(handle, force_erase);
+  return GetShard(Shard(GetPartition(handle), hash))
+      ->Release(handle, force_erase);
 }
 
 void ShardedCache::Erase(const Slice& key) {
   uint32_t hash = HashSlice(key);
-  GetShard(Shard(hash))->Erase(key, hash);
+  for (int p = 0; p < num_partitions_; p++) {
+    GetShard(Shard(p, hash))->Erase(key, hash);
+  }
+}
+
+int ShardedCache::GetLocalPartition() {
+  if (num_partitions_ == 1) {
+    return 0;
+  }
+  int partition = port::GetCurrentNumaNode() % num_partitions_;
+  TEST_SYNC_POINT_CALLBACK("ShardedCache::GetLocalPartition", &partition);
+  return partition;
 }
 
 uint64_t ShardedCache::NewId() {
@@ -87,7 +112,7 @@ bool ShardedCache::HasStrictCapacityLimit() const {
 
 size_t ShardedCache::GetUsage() const {
   // We will not lock the cache when getting the usage from shards.
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   size_t usage = 0;
   for (int s = 0; s < num_shards; s++) {
     usage += GetShard(s)->GetUsage();
@@ -101,7 +126,7 @@ size_t ShardedCache::GetUsage(Handle* handle) const {
 
 size_t ShardedCache::GetPinnedUsage() const {
   // We will not lock the cache when getting the usage from shards.
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   size_t usage = 0;
   for (int s = 0; s < num_shards; s++) {
     usage += GetShard(s)->GetPinnedUsage();
@@ -111,14 +136,23 @@ size_t ShardedCache::GetPinnedUsage() const {
 
 void ShardedCache::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                           bool thread_safe) {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->ApplyToAllCacheEntries(callback, thread_safe);
   }
 }
 
+void ShardedCache::ApplyToAllEntries(
+    const std::function<void(const Slice& key, void* value, size_t charge,
+                             DeleterFn deleter)>& callback) {
+  int num_shards = GetNumShards();
+  for (int s = 0; s < num_shards; s++) {
+    GetShard(s)->ApplyToAllEntries(callback);
+  }
+}
+
 void ShardedCache::EraseUnRefEntries() {
-  int num_shards = 1 << num_shard_bits_;
+  int num_shards = GetNumShards();
   for (int s = 0; s < num_shards; s++) {
     GetShard(s)->EraseUnRefEntries();
   }
@@ -136,6 +170,8 @@ std::string ShardedCache::GetPrintableOptions() const {
     ret.append(buffer);
     snprintf(buffer, kBufferSize, "    num_shard_bits : %d\n", num_shard_bits_);
     ret.append(buffer);
+    snprintf(buffer, kBufferSize, "    num_partitions : %d\n", num_partitions_);
+    ret.append(buffer);
     snprintf(buffer, kBufferSize, "    strict_capacity_limit : %d\n",
              strict_capacity_limit_);
     ret.append(buffer);
@@ -38,6 +38,9 @@ class CacheShard {
   virtual size_t GetPinnedUsage() const = 0;
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
+  virtual void ApplyToAllEntries(
+      const std::function<void(const Slice& key, void* value, size_t charge,
+                               Cache::DeleterFn deleter)>& callback) = 0;
   virtual void EraseUnRefEntries() = 0;
   virtual std::string GetPrintableOptions() const { return ""; }
   void set_metadata_charge_policy(
@@ -52,10 +55,19 @@ class CacheShard {
 // Generic cache interface which shards cache by hash of keys. 2^num_shard_bits
 // shards will be created, with capacity split evenly to each of the shards.
 // Keys are sharded by the highest num_shard_bits bits of hash value.
+//
+// With num_partitions > 1, there are 2^num_shard_bits shards per partition,
+// one partition per NUMA node, and the shards of partition p are
+// GetShard(p << num_shard_bits) and up. Entries are inserted into the
+// partition of the NUMA node of the calling thread, so that their memory is
+// allocated on that node, and looked up there first before falling back to
+// the other partitions. A key inserted from several nodes may be cached once
+// per partition.
 class ShardedCache : public Cache {
  public:
   ShardedCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-               std::shared_ptr<MemoryAllocator> memory_allocator = nullptr);
+               std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
+               int num_partitions = 1);
   virtual ~ShardedCache() = default;
   virtual const char* Name() const override = 0;
   virtual CacheShard* GetShard(int shard) = 0;
@@ -64,6 +76,8 @@ class ShardedCache : public Cache {
   virtual size_t GetCharge(Handle* handle) const override = 0;
 
   virtual uint32_t GetHash(Handle* handle) const = 0;
+  // Returns the partition of the shard holding the handle.
+  virtual int GetPartition(Handle* /*handle*/) const { return 0; }
   virtual void DisownData() override = 0;
 
   virtual void SetCapacity(size_t capacity) override;
@@ -84,10 +98,15 @@ class ShardedCache : public Cache {
   virtual size_t GetPinnedUsage() const override;
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
+  virtual void ApplyToAllEntries(
+      const std::function<void(const Slice& key, void* value, size_t charge,
+                               DeleterFn deleter)>& callback) override;
   virtual void EraseUnRefEntries() override;
   virtual std::string GetPrintableOptions() const override;
 
   int GetNumShardBits() const { return num_shard_bits_; }
+  int GetNumPartitions() const { return num_partitions_; }
+  int GetNumShards() const { return num_partitions_ << num_shard_bits_; }
 
  private:
   static inline uint32_t HashSlice(const Slice& s) {
@@ -99,7 +118,15 @@ class ShardedCache : public Cache {
     return (num_shard_bits_ > 0) ? (hash >> (32 - num_shard_bits_)) : 0;
   }
 
+  uint32_t Shard(int partition, uint32_t hash) {
+    return (static_cast<uint32_t>(partition) << num_shard_bits_) | Shard(hash);
+  }
+
+  // Returns the partition of the NUMA node the calling thread runs on.
+  int GetLocalPartition();
+
   int num_shard_bits_;
+  int num_partitions_;
   mutable port::Mutex capacity_mutex_;
   size_t capacity_;
   bool strict_capacity_limit_;
@@ -887,6 +887,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // (a) concurrent compactions,
   // (b) CompactionFilter::Decision::kRemoveAndSkipUntil.
   read_options.total_order_seek = true;
+  read_options.rate_limiter_priority = GetRateLimiterPriority();
 
   // Although the v2 aggregator is what the level iterator(s) know about,
   // the AddTombstones calls will be propagated down to the v1 aggregator.
@@ -1614,7 +1615,7 @@ Status CompactionJob::OpenCompactionOutputFile(
     sub_compact->outputs.push_back(out);
   }
 
-  writable_file->SetIOPriority(Env::IOPriority::IO_LOW);
+  writable_file->SetIOPriority(GetRateLimiterPriority());
   writable_file->SetWriteLifeTimeHint(write_hint_);
   writable_file->SetPreallocationBlockSize(static_cast<size_t>(
       sub_compact->compaction->OutputFilePreallocationSize()));
@@ -1646,6 +1647,11 @@ Status CompactionJob::OpenCompactionOutputFile(
   return s;
 }
 
+Env::IOPriority CompactionJob::GetRateLimiterPriority() const {
+  return compact_->compaction->start_level() == 0 ? Env::IO_MID
+                                                  : Env::IO_LOW;
+}
+
 void CompactionJob::CleanupCompaction() {
   for (SubcompactionState& sub_compact : compact_->sub_compact_states) {
     const auto& sub_status = sub_compact.status;
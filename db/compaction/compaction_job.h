@@ -130,6 +130,10 @@ class CompactionJob {
   Status InstallCompactionResults(const MutableCFOptions& mutable_cf_options);
   void RecordCompactionIOStats();
   Status OpenCompactionOutputFile(SubcompactionState* sub_compact);
+  // Compactions that read L0 unblock flushes and write stalls, so their reads
+  // and writes are charged to the rate limiter at IO_MID, ahead of the other
+  // compactions at IO_LOW.
+  Env::IOPriority GetRateLimiterPriority() const;
   void CleanupCompaction();
   void UpdateCompactionJobStats(
     const InternalStats::CompactionStats& stats) const;
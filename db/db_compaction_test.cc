@@ -5616,6 +5616,50 @@ TEST_F(DBCompactionTest, ChangeLevelCompactRangeConflictsWithManual) {
   refit_level_thread.join();
 }
 
+TEST_F(DBCompactionTest, AsyncCompactionReadahead) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compaction_readahead_size = 16 << 10;
+  options.async_compaction_readahead = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+  ASSERT_GT(env_->GetBackgroundThreads(Env::Priority::USER), 0);
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 200; ++j) {
+      std::string key = Key(j * 4 + i);
+      expected[key] = rnd.RandomString(500);
+      ASSERT_OK(Put(key, expected[key]));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  std::atomic<int> num_async_hits(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::TryReadFromAsyncBuffer:Hit",
+      [&](void* /*arg*/) { num_async_hits++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(num_async_hits.load(), 0);
+
+  ASSERT_EQ("0,1", FilesPerLevel(0));
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  auto it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+    ASSERT_TRUE(it != expected.end());
+    ASSERT_EQ(it->first, iter->key().ToString());
+    ASSERT_EQ(it->second, iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(it == expected.end());
+}
+
 #endif  // !defined(ROCKSDB_LITE)
 
 }  // namespace ROCKSDB_NAMESPACE
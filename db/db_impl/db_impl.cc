@@ -143,6 +143,17 @@ void DumpSupportInfo(Logger* logger) {
   ROCKS_LOG_HEADER(logger, "Fast CRC32 supported: %s",
                    crc32c::IsFastCrc32Supported().c_str());
 }
+
+// Marks the thread local tracer reference of a thread while it is in use.
+int local_tracer_in_use_dummy = 0;
+void* const kLocalTracerInUse = &local_tracer_in_use_dummy;
+
+void LocalTracerUnrefHandler(void* ptr) {
+  // Called when a thread exits or when the DB is closed, so the reference is
+  // not in use.
+  assert(ptr != kLocalTracerInUse);
+  delete static_cast<std::shared_ptr<Tracer>*>(ptr);
+}
 }  // namespace
 
 DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
@@ -156,6 +167,9 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       fs_(immutable_db_options_.fs, io_tracer_),
       mutable_db_options_(initial_db_options_),
       stats_(immutable_db_options_.statistics.get()),
+      tracing_(false),
+      local_tracer_(new ThreadLocalPtr(&LocalTracerUnrefHandler)),
+      trace_dropped_records_(0),
       mutex_(stats_, env_, DB_MUTEX_WAIT_MICROS,
              immutable_db_options_.use_adaptive_mutex),
       default_cf_handle_(nullptr),
@@ -1562,6 +1576,30 @@ class GetWithTimestampReadCallback : public ReadCallback {
 };
 }  // namespace
 
+std::shared_ptr<Tracer>* DBImpl::PinLocalTracer() {
+  void* ptr = local_tracer_->Swap(kLocalTracerInUse);
+  assert(ptr != kLocalTracerInUse);
+  if (ptr != nullptr) {
+    return static_cast<std::shared_ptr<Tracer>*>(ptr);
+  }
+  InstrumentedMutexLock lock(&trace_mutex_);
+  if (tracer_ == nullptr) {
+    void* expected = kLocalTracerInUse;
+    local_tracer_->CompareAndSwap(nullptr, expected);
+    return nullptr;
+  }
+  return new std::shared_ptr<Tracer>(tracer_);
+}
+
+void DBImpl::UnpinLocalTracer(std::shared_ptr<Tracer>* local) {
+  void* expected = kLocalTracerInUse;
+  if (!local_tracer_->CompareAndSwap(local, expected)) {
+    // The trace was started or ended since the reference was pinned, and the
+    // thread local references were reset.
+    delete local;
+  }
+}
+
 Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
                        GetImplOptions& get_impl_options) {
   assert(get_impl_options.value != nullptr ||
@@ -1590,14 +1628,9 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
       get_impl_options.column_family);
   auto cfd = cfh->cfd();
 
-  if (tracer_) {
-    // TODO: This mutex should be removed later, to improve performance when
-    // tracing is enabled.
-    InstrumentedMutexLock lock(&trace_mutex_);
-    if (tracer_) {
-      tracer_->Get(get_impl_options.column_family, key);
-    }
-  }
+  CallTracer([&](Tracer* tracer) {
+    tracer->Get(get_impl_options.column_family, key);
+  });
 
   // Acquire SuperVersion
   SuperVersion* sv = GetAndRefSuperVersion(cfd);
@@ -1772,6 +1805,8 @@ std::vector<Status> DBImpl::MultiGet(
   StopWatch sw(env_, stats_, DB_MULTIGET);
   PERF_TIMER_GUARD(get_snapshot_time);
 
+  CallTracer([&](Tracer* tracer) { tracer->MultiGet(column_family, keys); });
+
 #ifndef NDEBUG
   for (const auto* cfh : column_family) {
     assert(cfh);
@@ -2064,6 +2099,8 @@ void DBImpl::MultiGet(const ReadOptions& read_options, const size_t num_keys,
     return;
   }
 
+  CallTracer([&](Tracer* tracer) { tracer->MultiGet(num_keys, column_families, keys); });
+
 #ifndef NDEBUG
   for (size_t i = 0; i < num_keys; ++i) {
     ColumnFamilyHandle* cfh = column_families[i];
@@ -2234,6 +2271,8 @@ void DBImpl::MultiGet(const ReadOptions& read_options,
                       const Slice* keys, PinnableSlice* values,
                       std::string* timestamps, Status* statuses,
                       const bool sorted_input) {
+  CallTracer([&](Tracer* tracer) { tracer->MultiGet(num_keys, column_family, keys); });
+
   autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_context;
   autovector<KeyContext*, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
   sorted_keys.resize(num_keys);
@@ -3733,6 +3772,148 @@ Status DB::DestroyColumnFamilyHandle(ColumnFamilyHandle* column_family) {
   return Status::OK();
 }
 
+namespace {
+// Owns the bounds of an iterator returned by DB::NewParallelIterators() and
+// keeps the snapshot shared by all of them alive.
+struct ParallelIteratorState {
+  std::string lower;
+  std::string upper;
+  Slice lower_slice;
+  Slice upper_slice;
+  std::shared_ptr<const Snapshot> snapshot;
+};
+
+void CleanupParallelIteratorState(void* arg1, void* /*arg2*/) {
+  delete reinterpret_cast<ParallelIteratorState*>(arg1);
+}
+}  // namespace
+
+Status DB::NewParallelIterators(const ReadOptions& options,
+                                ColumnFamilyHandle* column_family,
+                                const Slice* begin, const Slice* end,
+                                size_t num_ranges,
+                                std::vector<Iterator*>* iterators) {
+  iterators->clear();
+  if (num_ranges == 0) {
+    return Status::InvalidArgument("num_ranges must be positive");
+  }
+  const Comparator* ucmp = column_family->GetComparator();
+
+  // Candidate split points are the smallest keys of the table files that
+  // fall strictly inside the range.
+  std::vector<std::string> split_keys;
+  if (num_ranges > 1) {
+    ColumnFamilyMetaData cf_meta;
+    GetColumnFamilyMetaData(column_family, &cf_meta);
+    std::vector<std::string> candidates;
+    std::string min_key;
+    std::string max_key;
+    bool has_files = false;
+    for (const auto& level : cf_meta.levels) {
+      for (const auto& file : level.files) {
+        if (!has_files || ucmp->Compare(file.smallestkey, min_key) < 0) {
+          min_key = file.smallestkey;
+        }
+        if (!has_files || ucmp->Compare(file.largestkey, max_key) > 0) {
+          max_key = file.largestkey;
+        }
+        has_files = true;
+        if ((begin == nullptr || ucmp->Compare(file.smallestkey, *begin) > 0) &&
+            (end == nullptr || ucmp->Compare(file.smallestkey, *end) < 0)) {
+          candidates.push_back(file.smallestkey);
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [ucmp](const std::string& a, const std::string& b) {
+                return ucmp->Compare(a, b) < 0;
+              });
+    candidates.erase(
+        std::unique(candidates.begin(), candidates.end(),
+                    [ucmp](const std::string& a, const std::string& b) {
+                      return ucmp->Compare(a, b) == 0;
+                    }),
+        candidates.end());
+
+    if (!candidates.empty()) {
+      // sizes[i] approximates the data between candidates[i - 1] and
+      // candidates[i], with the ends of the range at either side.
+      std::vector<Range> ranges;
+      ranges.reserve(candidates.size() + 1);
+      Slice prev = begin != nullptr ? *begin : Slice(min_key);
+      for (const auto& key : candidates) {
+        ranges.emplace_back(prev, key);
+        prev = key;
+      }
+      ranges.emplace_back(prev, end != nullptr ? *end : Slice(max_key));
+      std::vector<uint64_t> sizes(ranges.size());
+      SizeApproximationOptions size_options;
+      size_options.include_memtabtles = true;
+      Status s =
+          GetApproximateSizes(size_options, column_family, ranges.data(),
+                              static_cast<int>(ranges.size()), sizes.data());
+      if (!s.ok()) {
+        return s;
+      }
+      uint64_t total = 0;
+      for (uint64_t size : sizes) {
+        total += size;
+      }
+      // Cut at the first candidate at which the running total reaches the
+      // next multiple of total / num_ranges.
+      uint64_t sum = 0;
+      for (size_t i = 0; i < candidates.size(); ++i) {
+        sum += sizes[i];
+        if (split_keys.size() + 1 == num_ranges) {
+          break;
+        }
+        if (sum > 0 && sum * num_ranges >= total * (split_keys.size() + 1)) {
+          split_keys.push_back(candidates[i]);
+        }
+      }
+    }
+  }
+
+  ReadOptions iter_options = options;
+  std::shared_ptr<const Snapshot> snapshot;
+  if (options.snapshot == nullptr) {
+    iter_options.snapshot = GetSnapshot();
+    if (iter_options.snapshot != nullptr) {
+      snapshot.reset(iter_options.snapshot,
+                     [this](const Snapshot* snap) { ReleaseSnapshot(snap); });
+    }
+  }
+  for (size_t i = 0; i <= split_keys.size(); ++i) {
+    ParallelIteratorState* state = new ParallelIteratorState();
+    state->snapshot = snapshot;
+    iter_options.iterate_lower_bound = nullptr;
+    iter_options.iterate_upper_bound = nullptr;
+    if (i > 0 || begin != nullptr) {
+      state->lower = i > 0 ? split_keys[i - 1] : begin->ToString();
+      state->lower_slice = state->lower;
+      iter_options.iterate_lower_bound = &state->lower_slice;
+    }
+    if (i < split_keys.size() || end != nullptr) {
+      state->upper = i < split_keys.size() ? split_keys[i] : end->ToString();
+      state->upper_slice = state->upper;
+      iter_options.iterate_upper_bound = &state->upper_slice;
+    }
+    Iterator* iter = NewIterator(iter_options, column_family);
+    iter->RegisterCleanup(&CleanupParallelIteratorState, state, nullptr);
+    Status s = iter->status();
+    if (!s.ok()) {
+      delete iter;
+      for (auto* it : *iterators) {
+        delete it;
+      }
+      iterators->clear();
+      return s;
+    }
+    iterators->push_back(iter);
+  }
+  return Status::OK();
+}
+
 DB::~DB() {}
 
 Status DBImpl::Close() {
@@ -4732,23 +4913,57 @@ void DBImpl::WaitForIngestFile() {
 
 Status DBImpl::StartTrace(const TraceOptions& trace_options,
                           std::unique_ptr<TraceWriter>&& trace_writer) {
-  InstrumentedMutexLock lock(&trace_mutex_);
-  tracer_.reset(new Tracer(env_, trace_options, std::move(trace_writer)));
+  std::shared_ptr<Tracer> old_tracer;
+  {
+    InstrumentedMutexLock lock(&trace_mutex_);
+    old_tracer = std::move(tracer_);
+    tracer_.reset(new Tracer(env_, trace_options, std::move(trace_writer)));
+    tracing_.store(true, std::memory_order_relaxed);
+    ResetLocalTracers();
+    if (old_tracer != nullptr) {
+      trace_dropped_records_ += old_tracer->GetDroppedCount();
+    }
+  }
   return Status::OK();
 }
 
 Status DBImpl::EndTrace() {
-  InstrumentedMutexLock lock(&trace_mutex_);
-  Status s;
-  if (tracer_ != nullptr) {
-    s = tracer_->Close();
-    tracer_.reset();
-  } else {
-    return Status::IOError("No trace file to close");
+  std::shared_ptr<Tracer> tracer;
+  {
+    InstrumentedMutexLock lock(&trace_mutex_);
+    if (tracer_ == nullptr) {
+      return Status::IOError("No trace file to close");
+    }
+    tracer = std::move(tracer_);
+    tracing_.store(false, std::memory_order_relaxed);
+    ResetLocalTracers();
   }
+  // Threads may still be calling a buffered tracer. Close() stops writing
+  // their traces, and the tracer is freed with its last reference.
+  Status s = tracer->Close();
+  InstrumentedMutexLock lock(&trace_mutex_);
+  trace_dropped_records_ += tracer->GetDroppedCount();
   return s;
 }
 
+void DBImpl::ResetLocalTracers() {
+  trace_mutex_.AssertHeld();
+  autovector<void*> locals;
+  local_tracer_->Scrape(&locals, nullptr);
+  for (void* local : locals) {
+    // A reference in use is released by its thread on unpin.
+    if (local != kLocalTracerInUse) {
+      delete static_cast<std::shared_ptr<Tracer>*>(local);
+    }
+  }
+}
+
+uint64_t DBImpl::GetTraceDroppedRecords() {
+  InstrumentedMutexLock lock(&trace_mutex_);
+  return trace_dropped_records_ +
+         (tracer_ != nullptr ? tracer_->GetDroppedCount() : 0);
+}
+
 Status DBImpl::StartBlockCacheTrace(
     const TraceOptions& trace_options,
     std::unique_ptr<TraceWriter>&& trace_writer) {
@@ -4761,29 +4976,6 @@ Status DBImpl::EndBlockCacheTrace() {
   return Status::OK();
 }
 
-Status DBImpl::TraceIteratorSeek(const uint32_t& cf_id, const Slice& key) {
-  Status s;
-  if (tracer_) {
-    InstrumentedMutexLock lock(&trace_mutex_);
-    if (tracer_) {
-      s = tracer_->IteratorSeek(cf_id, key);
-    }
-  }
-  return s;
-}
-
-Status DBImpl::TraceIteratorSeekForPrev(const uint32_t& cf_id,
-                                        const Slice& key) {
-  Status s;
-  if (tracer_) {
-    InstrumentedMutexLock lock(&trace_mutex_);
-    if (tracer_) {
-      s = tracer_->IteratorSeekForPrev(cf_id, key);
-    }
-  }
-  return s;
-}
-
 Status DBImpl::ReserveFileNumbersBeforeIngestion(
     ColumnFamilyData* cfd, uint64_t num,
     std::unique_ptr<std::list<uint64_t>::iterator>& pending_output_elem,
@@ -575,8 +575,26 @@ class DBImpl : public DB {
                                  bool* found_record_for_key,
                                  bool* is_blob_index = nullptr);
 
-  Status TraceIteratorSeek(const uint32_t& cf_id, const Slice& key);
-  Status TraceIteratorSeekForPrev(const uint32_t& cf_id, const Slice& key);
+  void TraceIteratorSeek(const uint32_t& cf_id, const Slice& key,
+                         uint64_t iter_id) {
+    CallTracer([&](Tracer* tracer) {
+      tracer->IteratorSeek(cf_id, key, iter_id);
+    });
+  }
+  void TraceIteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
+                                uint64_t iter_id) {
+    CallTracer([&](Tracer* tracer) {
+      tracer->IteratorSeekForPrev(cf_id, key, iter_id);
+    });
+  }
+  void TraceIteratorNext(const uint32_t& cf_id, uint64_t iter_id) {
+    CallTracer(
+        [&](Tracer* tracer) { tracer->IteratorNext(cf_id, iter_id); });
+  }
+
+  // Number of query traces dropped since the DB was opened because the trace
+  // buffer of their thread was full.
+  uint64_t GetTraceDroppedRecords();
 #endif  // ROCKSDB_LITE
 
   // Similar to GetSnapshot(), but also lets the db know that this snapshot
@@ -1014,6 +1032,44 @@ class DBImpl : public DB {
   void DumpStats();
 
  protected:
+  // Calls trace_fn with the query tracer if a trace is in progress. The
+  // calling thread keeps a reference to the tracer in local_tracer_, so that a
+  // buffered tracer is called without taking trace_mutex_. The other tracers
+  // are still called under trace_mutex_.
+  template <typename TraceFn>
+  void CallTracer(const TraceFn& trace_fn) {
+    if (!tracing_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    std::shared_ptr<Tracer>* local = PinLocalTracer();
+    if (local == nullptr) {
+      return;
+    }
+    Tracer* tracer = local->get();
+    if (tracer->IsBuffered()) {
+      trace_fn(tracer);
+    } else {
+      InstrumentedMutexLock lock(&trace_mutex_);
+      // The trace may have ended since the tracer was pinned.
+      if (tracer_.get() == tracer) {
+        trace_fn(tracer);
+      }
+    }
+    UnpinLocalTracer(local);
+  }
+
+  // Returns the tracer reference of the calling thread, creating it if
+  // needed, and marks it in use. Returns nullptr if no trace is in progress.
+  std::shared_ptr<Tracer>* PinLocalTracer();
+
+  // Gives back the reference returned by PinLocalTracer(), or releases it if
+  // the trace was started or ended since.
+  void UnpinLocalTracer(std::shared_ptr<Tracer>* local);
+
+  // Releases the thread local tracer references after tracer_ changed.
+  // REQUIRES: trace_mutex_ held.
+  void ResetLocalTracers();
+
   const std::string dbname_;
   std::string db_id_;
   // db_session_id_ is an identifier that gets reset
@@ -1031,8 +1087,18 @@ class DBImpl : public DB {
   Statistics* stats_;
   std::unordered_map<std::string, RecoveredTransaction*>
       recovered_transactions_;
-  std::unique_ptr<Tracer> tracer_;
+  // The query tracer. Protected by trace_mutex_.
+  std::shared_ptr<Tracer> tracer_;
   InstrumentedMutex trace_mutex_;
+  // True while tracer_ is set, to skip the tracing code cheaply otherwise.
+  std::atomic<bool> tracing_;
+  // Thread local copies of tracer_, so that the threads can call a buffered
+  // tracer without taking trace_mutex_. Declared after tracer_ so that it is
+  // destroyed first, and never releases the last reference to the tracer.
+  std::unique_ptr<ThreadLocalPtr> local_tracer_;
+  // Query traces dropped by the tracers that were closed. Protected by
+  // trace_mutex_.
+  uint64_t trace_dropped_records_;
   BlockCacheTracer block_cache_tracer_;
 
   // State below is protected by mutex_
@@ -69,6 +69,11 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
                                            Env::Priority::LOW);
   result.env->IncBackgroundThreadsIfNeeded(bg_job_limits.max_flushes,
                                            Env::Priority::HIGH);
+  if (result.async_compaction_readahead) {
+    // One in-flight readahead per running compaction.
+    result.env->IncBackgroundThreadsIfNeeded(bg_job_limits.max_compactions,
+                                             Env::Priority::USER);
+  }
 
   if (result.rate_limiter.get() != nullptr) {
     if (result.bytes_per_sync == 0) {
@@ -12,19 +12,116 @@
 #include "logging/auto_roll_logger.h"
 #include "monitoring/perf_context_imp.h"
 #include "util/cast_util.h"
+#include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 #ifndef ROCKSDB_LITE
 DBImplSecondary::DBImplSecondary(const DBOptions& db_options,
                                  const std::string& dbname)
-    : DBImpl(db_options, dbname) {
+    : DBImpl(db_options, dbname), last_catch_up_micros_(0) {
   ROCKS_LOG_INFO(immutable_db_options_.info_log,
                  "Opening the db in secondary mode");
   LogFlush(immutable_db_options_.info_log);
 }
 
-DBImplSecondary::~DBImplSecondary() {}
+DBImplSecondary::~DBImplSecondary() { StopCatchUpThread(); }
+
+Status DBImplSecondary::Close() {
+  StopCatchUpThread();
+  return DBImpl::Close();
+}
+
+void DBImplSecondary::MaybeStartCatchUpThread() {
+  uint64_t period = immutable_db_options_.secondary_catch_up_period_micros;
+  if (period == 0) {
+    return;
+  }
+  catch_up_thread_.reset(new RepeatableThread(
+      [this]() {
+        Status s = TryCatchUpWithPrimary();
+        if (!s.ok()) {
+          ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                         "Failed to catch up with the primary: %s",
+                         s.ToString().c_str());
+        }
+      },
+      "catchup", env_, period, period /* initial_delay_us */));
+}
+
+void DBImplSecondary::StopCatchUpThread() {
+  if (catch_up_thread_ != nullptr) {
+    catch_up_thread_->cancel();
+    catch_up_thread_.reset();
+  }
+}
+
+bool DBImplSecondary::GetProperty(ColumnFamilyHandle* column_family,
+                                  const Slice& property, std::string* value) {
+  uint64_t int_value;
+  if (GetSecondaryIntProperty(property, &int_value)) {
+    *value = ToString(int_value);
+    return true;
+  }
+  return DBImpl::GetProperty(column_family, property, value);
+}
+
+bool DBImplSecondary::GetIntProperty(ColumnFamilyHandle* column_family,
+                                     const Slice& property, uint64_t* value) {
+  if (GetSecondaryIntProperty(property, value)) {
+    return true;
+  }
+  return DBImpl::GetIntProperty(column_family, property, value);
+}
+
+bool DBImplSecondary::GetSecondaryIntProperty(const Slice& property,
+                                              uint64_t* value) {
+  if (property == DB::Properties::kSecondaryCaughtUpSequence) {
+    *value = versions_->LastSequence();
+  } else if (property == DB::Properties::kSecondaryWalBytesBehind) {
+    *value = GetWalBytesBehind();
+  } else if (property == DB::Properties::kSecondaryCatchUpAgeMicros) {
+    uint64_t now = env_->NowMicros();
+    uint64_t last = last_catch_up_micros_.load(std::memory_order_relaxed);
+    *value = now > last ? now - last : 0;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+uint64_t DBImplSecondary::GetWalBytesBehind() {
+  // The WAL being tailed, and how far it has been read
+  uint64_t log_number = 0;
+  uint64_t read_offset = 0;
+  {
+    InstrumentedMutexLock lock_guard(&mutex_);
+    if (!log_readers_.empty()) {
+      auto iter = log_readers_.rbegin();
+      log_number = iter->first;
+      read_offset = iter->second->reader_->GetReadOffset();
+    }
+  }
+  std::vector<std::string> filenames;
+  env_->GetChildren(immutable_db_options_.wal_dir, &filenames);  // ignore error
+  uint64_t bytes_behind = 0;
+  for (const auto& fname : filenames) {
+    uint64_t number;
+    FileType type;
+    uint64_t file_size;
+    if (ParseFileName(fname, &number, &type) && type == kLogFile &&
+        number >= log_number &&
+        env_->GetFileSize(immutable_db_options_.wal_dir + "/" + fname,
+                          &file_size)
+            .ok()) {
+      if (number == log_number) {
+        file_size -= std::min(file_size, read_offset);
+      }
+      bytes_behind += file_size;
+    }
+  }
+  return bytes_behind;
+}
 
 Status DBImplSecondary::Recover(
     const std::vector<ColumnFamilyDescriptor>& column_families,
@@ -325,12 +422,7 @@ Status DBImplSecondary::GetImpl(const ReadOptions& read_options,
 
   auto cfh = static_cast<ColumnFamilyHandleImpl*>(column_family);
   ColumnFamilyData* cfd = cfh->cfd();
-  if (tracer_) {
-    InstrumentedMutexLock lock(&trace_mutex_);
-    if (tracer_) {
-      tracer_->Get(column_family, key);
-    }
-  }
+  CallTracer([&](Tracer* tracer) { tracer->Get(column_family, key); });
   // Acquire SuperVersion
   SuperVersion* super_version = GetAndRefSuperVersion(cfd);
   SequenceNumber snapshot = versions_->LastSequence();
@@ -540,6 +632,8 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
       s = Status::OK();
     }
     if (s.ok()) {
+      last_catch_up_micros_.store(env_->NowMicros(),
+                                  std::memory_order_relaxed);
       for (auto cfd : cfds_changed) {
         cfd->imm()->RemoveOldMemTables(cfd->GetLogNumber(),
                                        &job_context.memtables_to_free);
@@ -645,6 +739,9 @@ Status DB::OpenAsSecondary(
       impl->NewThreadStatusCfInfo(
           static_cast_with_check<ColumnFamilyHandleImpl>(h)->cfd());
     }
+    impl->last_catch_up_micros_.store(impl->env_->NowMicros(),
+                                      std::memory_order_relaxed);
+    impl->MaybeStartCatchUpThread();
   } else {
     for (auto h : *handles) {
       delete h;
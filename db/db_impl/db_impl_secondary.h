@@ -7,9 +7,11 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include "db/db_impl/db_impl.h"
+#include "util/repeatable_thread.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -210,6 +212,17 @@ class DBImplSecondary : public DBImpl {
   // method can take long time due to all the I/O and CPU costs.
   Status TryCatchUpWithPrimary() override;
 
+  // Stops the catch-up thread, if any, before closing the DB.
+  Status Close() override;
+
+  // Also handles the "rocksdb.secondary-*" properties.
+  using DBImpl::GetProperty;
+  bool GetProperty(ColumnFamilyHandle* column_family, const Slice& property,
+                   std::string* value) override;
+
+  using DBImpl::GetIntProperty;
+  bool GetIntProperty(ColumnFamilyHandle* column_family, const Slice& property,
+                      uint64_t* value) override;
 
   // Try to find log reader using log_number from log_readers_ map, initialize
   // if it doesn't exist
@@ -316,6 +329,19 @@ class DBImplSecondary : public DBImpl {
                          std::unordered_set<ColumnFamilyData*>* cfds_changed,
                          JobContext* job_context);
 
+  // Starts a thread calling TryCatchUpWithPrimary() every
+  // secondary_catch_up_period_micros, if set.
+  void MaybeStartCatchUpThread();
+  void StopCatchUpThread();
+
+  // Returns the value of a "rocksdb.secondary-*" property in *value, or false
+  // if property is not one of them.
+  bool GetSecondaryIntProperty(const Slice& property, uint64_t* value);
+
+  // Number of bytes the primary has written to its WAL files that are not
+  // read yet.
+  uint64_t GetWalBytesBehind();
+
   std::unique_ptr<log::FragmentBufferedReader> manifest_reader_;
   std::unique_ptr<log::Reader::Reporter> manifest_reporter_;
   std::unique_ptr<Status> manifest_reader_status_;
@@ -326,6 +352,11 @@ class DBImplSecondary : public DBImpl {
 
   // Current WAL number replayed for each column family.
   std::unordered_map<ColumnFamilyData*, uint64_t> cfd_to_current_log_;
+
+  std::unique_ptr<RepeatableThread> catch_up_thread_;
+
+  // Time when the last successful catch-up with the primary finished.
+  std::atomic<uint64_t> last_catch_up_micros_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
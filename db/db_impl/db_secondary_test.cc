@@ -340,6 +340,72 @@ TEST_F(DBSecondaryTest, OpenAsSecondaryWALTailing) {
   verify_db_func("new_foo_value_1", "new_bar_value");
 }
 
+TEST_F(DBSecondaryTest, CatchUpInBackground) {
+  Options options;
+  options.env = env_;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "foo_value0"));
+
+  Options options1;
+  options1.env = env_;
+  options1.max_open_files = -1;
+  options1.secondary_catch_up_period_micros = 1000;
+  OpenSecondary(options1);
+
+  uint64_t seq = 0;
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondaryCaughtUpSequence, &seq));
+  ASSERT_EQ(db_->GetLatestSequenceNumber(), seq);
+  // Only secondary instances have these properties
+  ASSERT_FALSE(
+      db_->GetIntProperty(DB::Properties::kSecondaryCaughtUpSequence, &seq));
+
+  ASSERT_OK(Put("foo", "foo_value1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("bar", "bar_value1"));
+  const uint64_t latest_seq = db_->GetLatestSequenceNumber();
+  for (int i = 0; i < 60000 && seq < latest_seq; ++i) {
+    env_->SleepForMicroseconds(1000);
+    ASSERT_TRUE(db_secondary_->GetIntProperty(
+        DB::Properties::kSecondaryCaughtUpSequence, &seq));
+  }
+  ASSERT_EQ(latest_seq, seq);
+
+  std::string value;
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ("foo_value1", value);
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "bar", &value));
+  ASSERT_EQ("bar_value1", value);
+  uint64_t bytes_behind = 0;
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondaryWalBytesBehind, &bytes_behind));
+  ASSERT_EQ(0, bytes_behind);
+  ASSERT_TRUE(db_secondary_->GetProperty(
+      DB::Properties::kSecondaryCatchUpAgeMicros, &value));
+  ASSERT_OK(db_secondary_->Close());
+  CloseSecondary();
+
+  // Without the background thread, the secondary only moves on when asked
+  options1.secondary_catch_up_period_micros = 0;
+  OpenSecondary(options1);
+  ASSERT_OK(Put("bar", "bar_value2"));
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondaryWalBytesBehind, &bytes_behind));
+  ASSERT_GT(bytes_behind, 0);
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "bar", &value));
+  ASSERT_EQ("bar_value1", value);
+
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondaryWalBytesBehind, &bytes_behind));
+  ASSERT_EQ(0, bytes_behind);
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondaryCaughtUpSequence, &seq));
+  ASSERT_EQ(db_->GetLatestSequenceNumber(), seq);
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "bar", &value));
+  ASSERT_EQ("bar_value2", value);
+}
+
 TEST_F(DBSecondaryTest, OpenWithNonExistColumnFamily) {
   Options options;
   options.env = env_;
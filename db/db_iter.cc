@@ -123,6 +123,12 @@ void DBIter::Next() {
   assert(status_.ok());
 
   PERF_CPU_TIMER_GUARD(iter_next_cpu_nanos, env_);
+#ifndef ROCKSDB_LITE
+  if (db_impl_ != nullptr && cfd_ != nullptr) {
+    db_impl_->TraceIteratorNext(cfd_->GetID(),
+                                reinterpret_cast<uintptr_t>(this));
+  }
+#endif  // ROCKSDB_LITE
   // Release temporarily pinned blocks from last operation
   ReleaseTempPinnedData();
   local_stats_.skip_count_ += num_internal_keys_skipped_;
@@ -1209,7 +1215,8 @@ void DBIter::Seek(const Slice& target) {
 
 #ifndef ROCKSDB_LITE
   if (db_impl_ != nullptr && cfd_ != nullptr) {
-    db_impl_->TraceIteratorSeek(cfd_->GetID(), target);
+    db_impl_->TraceIteratorSeek(cfd_->GetID(), target,
+                                reinterpret_cast<uintptr_t>(this));
   }
 #endif  // ROCKSDB_LITE
 
@@ -1270,7 +1277,8 @@ void DBIter::SeekForPrev(const Slice& target) {
 
 #ifndef ROCKSDB_LITE
   if (db_impl_ != nullptr && cfd_ != nullptr) {
-    db_impl_->TraceIteratorSeekForPrev(cfd_->GetID(), target);
+    db_impl_->TraceIteratorSeekForPrev(cfd_->GetID(), target,
+                                       reinterpret_cast<uintptr_t>(this));
   }
 #endif  // ROCKSDB_LITE
 
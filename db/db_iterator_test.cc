@@ -2883,6 +2883,91 @@ TEST_P(DBIteratorTest, IterateWithLowerBoundAcrossFileBoundary) {
   ASSERT_OK(iter->status());
 }
 
+TEST_P(DBIteratorTest, ParallelIterators) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 16 << 10;
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 1000;
+  Random rnd(301);
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+    if (i % 100 == 99) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(dbfull()->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  // Leave some data in the memtable too.
+  ASSERT_OK(Put(Key(kNumKeys), "v"));
+
+  std::vector<std::string> expected;
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      expected.push_back(iter->key().ToString());
+    }
+    ASSERT_OK(iter->status());
+  }
+
+  // Concatenating the sub-ranges scanned in parallel gives the whole range.
+  std::vector<Iterator*> iterators;
+  ASSERT_OK(db_->NewParallelIterators(ReadOptions(), db_->DefaultColumnFamily(),
+                                      nullptr, nullptr, 4, &iterators));
+  ASSERT_GT(iterators.size(), 1);
+  ASSERT_LE(iterators.size(), 4);
+  // Writes after the call are not visible to any of the iterators.
+  ASSERT_OK(Put(Key(kNumKeys + 1), "v"));
+  ASSERT_OK(Delete(Key(0)));
+  std::vector<std::vector<std::string>> scanned(iterators.size());
+  std::vector<port::Thread> threads;
+  for (size_t i = 0; i < iterators.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      Iterator* iter = iterators[i];
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        scanned[i].push_back(iter->key().ToString());
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  std::vector<std::string> actual;
+  for (size_t i = 0; i < iterators.size(); ++i) {
+    ASSERT_OK(iterators[i]->status());
+    // No sub-range is left empty.
+    ASSERT_FALSE(scanned[i].empty());
+    actual.insert(actual.end(), scanned[i].begin(), scanned[i].end());
+    delete iterators[i];
+  }
+  ASSERT_EQ(expected, actual);
+
+  // Sub-ranges stay within [begin, end).
+  std::string begin_key = Key(100);
+  std::string end_key = Key(900);
+  Slice begin(begin_key);
+  Slice end(end_key);
+  ASSERT_OK(db_->NewParallelIterators(ReadOptions(), db_->DefaultColumnFamily(),
+                                      &begin, &end, 3, &iterators));
+  ASSERT_GT(iterators.size(), 1);
+  ASSERT_LE(iterators.size(), 3);
+  int count = 0;
+  for (auto* iter : iterators) {
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(100 + count), iter->key().ToString());
+      ++count;
+    }
+    ASSERT_OK(iter->status());
+    delete iter;
+  }
+  ASSERT_EQ(800, count);
+
+  ASSERT_TRUE(db_->NewParallelIterators(ReadOptions(),
+                                        db_->DefaultColumnFamily(), nullptr,
+                                        nullptr, 0, &iterators)
+                  .IsInvalidArgument());
+}
+
 INSTANTIATE_TEST_CASE_P(DBIteratorTestInstance, DBIteratorTest,
                         testing::Values(true, false));
 
@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <string>
 
+#include "cache/cache_entry_roles.h"
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
 #include "rocksdb/listener.h"
@@ -1700,6 +1701,109 @@ TEST_F(DBPropertiesTest, BlockCacheProperties) {
   ASSERT_EQ(0, value);
 }
 
+
+TEST_F(DBPropertiesTest, BlockCacheMissRatioCurve) {
+  Options options;
+  BlockBasedTableOptions table_options;
+  LRUCacheOptions co;
+  co.capacity = 1000;
+  co.num_shard_bits = 0;
+  co.metadata_charge_policy = kDontChargeCacheMetadata;
+  table_options.block_cache = NewLRUCache(co);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  std::string value;
+  // Not estimated by default.
+  ASSERT_FALSE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &value));
+
+  co.miss_ratio_curve_sampling_rate = 1.0;
+  auto block_cache = NewLRUCache(co);
+  table_options.block_cache = block_cache;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  // Cyclic lookups of 400 items of charge 1 hit in caches of capacity 400 or
+  // more, once the items are inserted.
+  for (int round = 0; round < 4; round++) {
+    for (int i = 0; i < 400; i++) {
+      std::string key = "item" + ToString(i);
+      Cache::Handle* handle = block_cache->Lookup(key);
+      if (handle != nullptr) {
+        block_cache->Release(handle);
+      } else {
+        ASSERT_OK(block_cache->Insert(key, nullptr /*value*/, 1,
+                                      nullptr /*deleter*/));
+      }
+    }
+  }
+  ASSERT_TRUE(
+      db_->GetProperty(DB::Properties::kBlockCacheMissRatioCurve, &value));
+  ASSERT_EQ(
+      "250 1.0000\n"
+      "500 0.2500\n"
+      "750 0.2500\n"
+      "1000 0.2500\n"
+      "1250 0.2500\n"
+      "1500 0.2500\n"
+      "2000 0.2500\n"
+      "3000 0.2500\n"
+      "4000 0.2500\n",
+      value);
+}
+
+TEST_F(DBPropertiesTest, BlockCacheEntryStats) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(64 << 20, 0 /* num_shard_bits */);
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  // The index and filter blocks are held by the table reader, which is
+  // charged to the block cache.
+  table_options.cache_index_and_filter_blocks = false;
+  table_options.reserve_table_reader_memory = true;
+  table_options.reserve_table_builder_memory = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.write_buffer_manager.reset(
+      new WriteBufferManager(32 << 20, table_options.block_cache));
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1", FilesPerLevel());
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ("value", Get(Key(i)));
+  }
+
+  std::map<std::string, std::string> values;
+  ASSERT_TRUE(
+      db_->GetMapProperty(DB::Properties::kBlockCacheEntryStats, &values));
+  ASSERT_NE("0", values["count.data-block"]);
+  ASSERT_EQ("0", values["count.filter-block"]);
+  ASSERT_EQ("0", values["count.index-block"]);
+  // The reader of the file is charged with one dummy entry.
+  ASSERT_EQ("1", values["count.block-based-table-reader"]);
+  ASSERT_EQ(ToString(256 << 10), values["bytes.block-based-table-reader"]);
+  // The filter buffers are released once the file is written.
+  ASSERT_EQ("0", values["count.filter-construction"]);
+  ASSERT_NE("0", values["count.write-buffer"]);
+  ASSERT_EQ("0", values["count.misc"]);
+
+  std::string value;
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kBlockCacheEntryStats, &value));
+  ASSERT_NE(std::string::npos,
+            value.find("block-based-table-reader: count 1 bytes 262144\n"));
+
+  // The reservation of the reader is released with it.
+  Close();
+  auto role_map = CopyCacheDeleterRoleMap();
+  table_options.block_cache->ApplyToAllEntries(
+      [&](const Slice& /*key*/, void* /*value*/, size_t /*charge*/,
+          Cache::DeleterFn deleter) {
+        ASSERT_NE(CacheEntryRole::kBlockBasedTableReader, role_map[deleter]);
+      });
+}
+
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
 
@@ -1665,6 +1665,130 @@ TEST_F(DBRangeDelTest, OverlappedKeys) {
   ASSERT_EQ(0, NumTableFilesAtLevel(1));
 }
 
+TEST_F(DBRangeDelTest, IteratorSkipsFilesCoveredByRangeTombstone) {
+  const int kNumFiles = 4, kNumPerFile = 25;
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  for (int i = 0; i < kNumFiles; ++i) {
+    for (int j = 0; j < kNumPerFile; ++j) {
+      ASSERT_OK(Put(Key(i * kNumPerFile + j), "val"));
+    }
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(2);
+  }
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(2));
+
+  const Snapshot* snapshot = db_->GetSnapshot();
+  // Fully covers the second and third files.
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(kNumPerFile), Key(3 * kNumPerFile)));
+
+  int num_skipped = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "LevelIterator::SkipCoveredFile",
+      [&](void* /*arg*/) { ++num_skipped; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ReadOptions read_opts;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_opts));
+  int expected = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(expected), iter->key());
+    expected = expected == kNumPerFile - 1 ? 3 * kNumPerFile : expected + 1;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumFiles * kNumPerFile, expected);
+  ASSERT_EQ(2, num_skipped);
+
+  iter->Seek(Key(kNumPerFile + 5));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(3 * kNumPerFile), iter->key());
+  iter->SeekForPrev(Key(2 * kNumPerFile + 5));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(kNumPerFile - 1), iter->key());
+  iter.reset();
+
+  // The tombstone is not visible to an older snapshot, so nothing is skipped.
+  num_skipped = 0;
+  read_opts.snapshot = snapshot;
+  iter.reset(db_->NewIterator(read_opts));
+  expected = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(expected), iter->key());
+    ++expected;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumFiles * kNumPerFile, expected);
+  ASSERT_EQ(0, num_skipped);
+  iter.reset();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  db_->ReleaseSnapshot(snapshot);
+}
+
+TEST_F(DBRangeDelTest, CompactionDropsFilesCoveredByRangeTombstone) {
+  const int kNumFiles = 4, kNumPerFile = 25;
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  for (bool with_snapshot : {false, true}) {
+    DestroyAndReopen(options);
+    for (int i = 0; i < kNumFiles; ++i) {
+      for (int j = 0; j < kNumPerFile; ++j) {
+        ASSERT_OK(Put(Key(i * kNumPerFile + j), "val"));
+      }
+      ASSERT_OK(Flush());
+      MoveFilesToLevel(2);
+    }
+    const Snapshot* snapshot = with_snapshot ? db_->GetSnapshot() : nullptr;
+    ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                               Key(kNumPerFile), Key(3 * kNumPerFile)));
+    ASSERT_OK(Flush());
+    MoveFilesToLevel(1);
+
+    int num_skipped = 0;
+    SyncPoint::GetInstance()->SetCallBack(
+        "LevelIterator::SkipCoveredFile",
+        [&](void* /*arg*/) { ++num_skipped; });
+    SyncPoint::GetInstance()->EnableProcessing();
+    ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr, nullptr,
+                                          true /* disallow_trivial_move */));
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+
+    // A snapshot between the tombstone and the covered keys keeps them alive,
+    // so the covered files must be read and rewritten.
+    ASSERT_EQ(with_snapshot ? 0 : 2, num_skipped);
+    ASSERT_EQ(0, NumTableFilesAtLevel(1));
+
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int expected = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(expected), iter->key());
+      expected = expected == kNumPerFile - 1 ? 3 * kNumPerFile : expected + 1;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kNumFiles * kNumPerFile, expected);
+    iter.reset();
+
+    if (snapshot != nullptr) {
+      ReadOptions read_opts;
+      read_opts.snapshot = snapshot;
+      iter.reset(db_->NewIterator(read_opts));
+      expected = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        ASSERT_EQ(Key(expected), iter->key());
+        ++expected;
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(kNumFiles * kNumPerFile, expected);
+      iter.reset();
+      db_->ReleaseSnapshot(snapshot);
+    }
+  }
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -16,6 +16,7 @@
 #include "port/stack_trace.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/wal_filter.h"
+#include "util/hash.h"
 #include "util/random.h"
 #include "utilities/fault_injection_env.h"
 
@@ -3311,10 +3312,12 @@ TEST_F(DBTest2, RateLimitedCompactionReads) {
     ASSERT_EQ(0, NumTableFilesAtLevel(0));
 
     ASSERT_EQ(0, options.rate_limiter->GetTotalBytesThrough(Env::IO_HIGH));
+    // The compaction reads L0, so it is charged at IO_MID.
+    ASSERT_EQ(0, options.rate_limiter->GetTotalBytesThrough(Env::IO_LOW));
     // should be slightly above 512KB due to non-data blocks read. Arbitrarily
     // chose 1MB as the upper bound on the total bytes read.
     size_t rate_limited_bytes =
-        options.rate_limiter->GetTotalBytesThrough(Env::IO_LOW);
+        options.rate_limiter->GetTotalBytesThrough(Env::IO_MID);
     // Include the explicit prefetch of the footer in direct I/O case.
     size_t direct_io_extra = use_direct_io ? 512 * 1024 : 0;
     ASSERT_GE(
@@ -3330,10 +3333,16 @@ TEST_F(DBTest2, RateLimitedCompactionReads) {
       ASSERT_EQ(iter->value().ToString(), DummyString(kBytesPerKey));
     }
     delete iter;
-    // bytes read for user iterator shouldn't count against the rate limit.
+    // Only the readahead of the user iterator counts against the rate limit,
+    // at IO_USER.
     ASSERT_EQ(rate_limited_bytes,
               static_cast<size_t>(
-                  options.rate_limiter->GetTotalBytesThrough(Env::IO_LOW)));
+                  options.rate_limiter->GetTotalBytesThrough(Env::IO_MID)));
+    ASSERT_GT(options.rate_limiter->GetTotalBytesThrough(Env::IO_USER), 0);
+    ASSERT_LT(options.rate_limiter->GetTotalBytesThrough(Env::IO_USER),
+              static_cast<int64_t>(2 * kNumKeysPerFile * kBytesPerKey *
+                                       kNumL0Files +
+                                   direct_io_extra));
   }
 }
 #endif  // ROCKSDB_LITE
@@ -3970,6 +3979,312 @@ TEST_F(DBTest2, TraceWithFilter) {
   ASSERT_EQ(count, 6);
 }
 
+TEST_F(DBTest2, TracePerThreadReplay) {
+  Options options = CurrentOptions();
+  ReadOptions ro;
+  WriteOptions wo;
+  TraceOptions trace_opts;
+  EnvOptions env_opts;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace_per_thread";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, env_opts, trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(trace_opts, std::move(trace_writer)));
+
+  // Each thread overwrites its own key, so the final values depend on the
+  // order of the writes of each thread being kept by the replay.
+  const int kNumThreads = 3;
+  const int kNumWrites = 20;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumWrites; i++) {
+        ASSERT_OK(db_->Put(wo, handles_[1], "key" + ToString(t), ToString(i)));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_OK(Put(0, "a", "1"));
+  ASSERT_OK(Put(0, "b", "2"));
+  ASSERT_OK(Put(0, "c", "3"));
+
+  std::vector<Slice> keys = {"a", "b"};
+  std::vector<std::string> values;
+  std::vector<Status> statuses = db_->MultiGet(ro, keys, &values);
+  ASSERT_OK(statuses[0]);
+  ASSERT_OK(statuses[1]);
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+  int num_nexts = 0;
+  for (iter->Seek("a"); iter->Valid(); iter->Next()) {
+    num_nexts++;
+  }
+  iter.reset();
+  ASSERT_OK(db_->EndTrace());
+
+  std::string dbname2 = test::PerThreadDBPath(env_, "/db_replay_per_thread");
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2_init = nullptr;
+  options.create_if_missing = true;
+  ASSERT_OK(DB::Open(options, dbname2, &db2_init));
+  ColumnFamilyHandle* cf;
+  ASSERT_OK(
+      db2_init->CreateColumnFamily(ColumnFamilyOptions(), "pikachu", &cf));
+  delete cf;
+  delete db2_init;
+
+  DB* db2 = nullptr;
+  std::vector<ColumnFamilyDescriptor> column_families;
+  column_families.push_back(
+      ColumnFamilyDescriptor("default", ColumnFamilyOptions()));
+  column_families.push_back(
+      ColumnFamilyDescriptor("pikachu", ColumnFamilyOptions()));
+  std::vector<ColumnFamilyHandle*> handles;
+  ASSERT_OK(DB::Open(DBOptions(), dbname2, column_families, &handles, &db2));
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, env_opts, trace_filename, &trace_reader));
+  Replayer replayer(db2, handles, std::move(trace_reader));
+  ASSERT_TRUE(replayer.SetFastForward(0).IsInvalidArgument());
+  ASSERT_OK(replayer.SetFastForward(2.5));
+  ASSERT_OK(replayer.PerThreadReplay());
+
+  std::string value;
+  for (int t = 0; t < kNumThreads; t++) {
+    ASSERT_OK(db2->Get(ro, handles[1], "key" + ToString(t), &value));
+    ASSERT_EQ(ToString(kNumWrites - 1), value);
+  }
+  ASSERT_OK(db2->Get(ro, handles[0], "c", &value));
+  ASSERT_EQ("3", value);
+
+  ASSERT_EQ(kNumThreads * kNumWrites + 3,
+            replayer.GetLatencyHistogram(kTraceWrite).num());
+  ASSERT_EQ(1, replayer.GetLatencyHistogram(kTraceMultiGet).num());
+  ASSERT_EQ(1, replayer.GetLatencyHistogram(kTraceIteratorSeek).num());
+  ASSERT_EQ(num_nexts,
+            replayer.GetLatencyHistogram(kTraceIteratorNext).num());
+  ASSERT_EQ(0, replayer.GetLatencyHistogram(kTraceGet).num());
+
+  for (auto handle : handles) {
+    delete handle;
+  }
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+}
+
+namespace {
+// Returns the traces of a trace file, without its header and footer.
+std::vector<Trace> ReadTraces(Env* env, const std::string& trace_filename) {
+  std::vector<Trace> traces;
+  std::unique_ptr<TraceReader> trace_reader;
+  EXPECT_OK(
+      NewFileTraceReader(env, EnvOptions(), trace_filename, &trace_reader));
+  std::string encoded_trace;
+  while (trace_reader->Read(&encoded_trace).ok()) {
+    Trace trace;
+    EXPECT_OK(TracerHelper::DecodeTrace(encoded_trace, &trace));
+    if (trace.type != kTraceBegin && trace.type != kTraceEnd) {
+      traces.push_back(std::move(trace));
+    }
+  }
+  return traces;
+}
+
+// Collects the column families and keys of the traced writes.
+class TracedKeyCollector : public WriteBatch::Handler {
+ public:
+  Status PutCF(uint32_t cf_id, const Slice& key,
+               const Slice& /*value*/) override {
+    keys.emplace_back(cf_id, key.ToString());
+    return Status::OK();
+  }
+  Status DeleteCF(uint32_t cf_id, const Slice& key) override {
+    keys.emplace_back(cf_id, key.ToString());
+    return Status::OK();
+  }
+
+  std::vector<std::pair<uint32_t, std::string>> keys;
+};
+}  // namespace
+
+TEST_F(DBTest2, TraceBufferedWithKeySampling) {
+  Options options = CurrentOptions();
+  ReadOptions ro;
+  WriteOptions wo;
+  TraceOptions trace_opts;
+  trace_opts.buffer_size = 1 << 20;
+  trace_opts.key_sampling_frequency = 3;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace_buffered";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, EnvOptions(), trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(trace_opts, std::move(trace_writer)));
+
+  const int kNumThreads = 4;
+  const int kNumKeys = 100;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumKeys; i++) {
+        std::string key = "key" + ToString(t) + "_" + ToString(i);
+        ASSERT_OK(db_->Put(wo, key, "v"));
+        std::string value;
+        ASSERT_OK(db_->Get(ro, key, &value));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::set<std::string> expected_keys;
+  for (int t = 0; t < kNumThreads; t++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      std::string key = "key" + ToString(t) + "_" + ToString(i);
+      if (GetSliceNPHash64(key) % 3 == 0) {
+        expected_keys.insert(key);
+      }
+    }
+  }
+  ASSERT_GT(expected_keys.size(), 0);
+  std::set<std::string> expected_read_keys = expected_keys;
+  // A write batch is traced with its entries on sampled keys only.
+  WriteBatch batch;
+  for (int i = 0; i < kNumKeys; i++) {
+    std::string key = "batch" + ToString(i);
+    ASSERT_OK(batch.Put(key, "v"));
+    if (GetSliceNPHash64(key) % 3 == 0) {
+      expected_keys.insert(key);
+    }
+  }
+  ASSERT_OK(db_->Write(wo, &batch));
+  ASSERT_OK(db_->EndTrace());
+  uint64_t dropped = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kTraceDroppedRecords, &dropped));
+  ASSERT_EQ(0, dropped);
+
+  std::set<std::string> written_keys;
+  std::set<std::string> read_keys;
+  std::set<uint64_t> thread_ids;
+  for (const Trace& trace : ReadTraces(env_, trace_filename)) {
+    thread_ids.insert(trace.thread_id);
+    if (trace.type == kTraceWrite) {
+      WriteBatch traced_batch(trace.payload);
+      TracedKeyCollector collector;
+      ASSERT_OK(traced_batch.Iterate(&collector));
+      for (const auto& cf_and_key : collector.keys) {
+        written_keys.insert(cf_and_key.second);
+      }
+    } else {
+      ASSERT_EQ(kTraceGet, trace.type);
+      Slice payload(trace.payload);
+      uint32_t cf_id;
+      Slice key;
+      ASSERT_TRUE(GetFixed32(&payload, &cf_id));
+      ASSERT_TRUE(GetLengthPrefixedSlice(&payload, &key));
+      read_keys.insert(key.ToString());
+    }
+  }
+  ASSERT_EQ(expected_keys, written_keys);
+  ASSERT_EQ(expected_read_keys, read_keys);
+  ASSERT_EQ(kNumThreads + 1, thread_ids.size());
+}
+
+TEST_F(DBTest2, TraceBufferedDrops) {
+  Options options = CurrentOptions();
+  WriteOptions wo;
+  TraceOptions trace_opts;
+  // Too small for the traces of the writes below.
+  trace_opts.buffer_size = 128;
+  Reopen(options);
+
+  std::string trace_filename = dbname_ + "/rocksdb.trace_drops";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, EnvOptions(), trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(trace_opts, std::move(trace_writer)));
+  const int kNumWrites = 10;
+  for (int i = 0; i < kNumWrites; i++) {
+    ASSERT_OK(db_->Put(wo, "key" + ToString(i), std::string(200, 'v')));
+  }
+  // Fits in the buffer.
+  ASSERT_OK(db_->Put(wo, "a", "1"));
+  uint64_t dropped = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kTraceDroppedRecords, &dropped));
+  ASSERT_EQ(kNumWrites, dropped);
+  ASSERT_OK(db_->EndTrace());
+
+  std::vector<Trace> traces = ReadTraces(env_, trace_filename);
+  ASSERT_EQ(1, traces.size());
+  ASSERT_EQ(kTraceWrite, traces[0].type);
+
+  // The count survives the end of the trace.
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kTraceDroppedRecords, &dropped));
+  ASSERT_EQ(kNumWrites, dropped);
+}
+
+TEST_F(DBTest2, TraceWithColumnFamilyFilter) {
+  Options options = CurrentOptions();
+  ReadOptions ro;
+  WriteOptions wo;
+  TraceOptions trace_opts;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(0, "key" + ToString(i), "v"));
+    ASSERT_OK(Put(1, "key" + ToString(i), "v"));
+  }
+
+  trace_opts.column_family_ids = {handles_[1]->GetID()};
+  std::string trace_filename = dbname_ + "/rocksdb.trace_cf_filter";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(
+      NewFileTraceWriter(env_, EnvOptions(), trace_filename, &trace_writer));
+  ASSERT_OK(db_->StartTrace(trace_opts, std::move(trace_writer)));
+  ASSERT_OK(Put(0, "a", "1"));
+  ASSERT_OK(Put(1, "b", "2"));
+  std::string value;
+  ASSERT_OK(db_->Get(ro, handles_[0], "key1", &value));
+  ASSERT_OK(db_->Get(ro, handles_[1], "key2", &value));
+  int num_nexts = 0;
+  for (int cf = 0; cf < 2; cf++) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ro, handles_[cf]));
+    for (iter->Seek("key5"); iter->Valid(); iter->Next()) {
+      num_nexts++;
+    }
+  }
+  ASSERT_OK(db_->EndTrace());
+
+  // Only the operations on the second column family are traced, including
+  // the Next() calls of its iterator.
+  std::map<TraceType, int> counts;
+  for (const Trace& trace : ReadTraces(env_, trace_filename)) {
+    counts[trace.type]++;
+    Slice payload(trace.payload);
+    if (trace.type == kTraceWrite) {
+      WriteBatch traced_batch(trace.payload);
+      TracedKeyCollector collector;
+      ASSERT_OK(traced_batch.Iterate(&collector));
+      ASSERT_EQ(1, collector.keys.size());
+      ASSERT_EQ(handles_[1]->GetID(), collector.keys[0].first);
+      ASSERT_EQ("b", collector.keys[0].second);
+    } else {
+      uint32_t cf_id;
+      ASSERT_TRUE(GetFixed32(&payload, &cf_id));
+      ASSERT_EQ(handles_[1]->GetID(), cf_id);
+    }
+  }
+  ASSERT_EQ(1, counts[kTraceWrite]);
+  ASSERT_EQ(1, counts[kTraceGet]);
+  ASSERT_EQ(1, counts[kTraceIteratorSeek]);
+  ASSERT_EQ(num_nexts / 2, counts[kTraceIteratorNext]);
+}
+
 #endif  // ROCKSDB_LITE
 
 TEST_F(DBTest2, PinnableSliceAndMmapReads) {
@@ -5141,6 +5456,81 @@ TEST_F(DBTest2, PointInTimeRecoveryWithIOErrorWhileReadingWal) {
   Status s = TryReopen(options);
   ASSERT_TRUE(s.IsIOError());
 }
+
+TEST_F(DBTest2, AutoReadaheadAdaptsToAccessPattern) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // One key per data block.
+  Random rnd(301);
+  const int kNumKeys = 2000;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1000)));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<size_t> readahead_sizes;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockPrefetcher::PrefetchIfNeeded:Prefetch", [&](void* arg) {
+        readahead_sizes.push_back(*reinterpret_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // A long forward scan ramps the readahead size up to the maximum.
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int num_keys = 0;
+  for (iter->SeekToFirst(); iter->Valid() && num_keys < kNumKeys / 2;
+       iter->Next()) {
+    ++num_keys;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_GT(readahead_sizes.size(), 2);
+  ASSERT_EQ(8 * 1024, readahead_sizes.front());
+  ASSERT_EQ(256 * 1024, readahead_sizes.back());
+
+  // A new iterator on the same file starts from the readahead size learned
+  // by the previous scan. A seek far ahead halves it instead of resetting it.
+  readahead_sizes.clear();
+  iter.reset(db_->NewIterator(ReadOptions()));
+  iter->Seek(Key(0));
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(iter->Valid());
+    iter->Next();
+  }
+  iter->Seek(Key(kNumKeys * 3 / 4));
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(iter->Valid());
+    iter->Next();
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(2, readahead_sizes.size());
+  ASSERT_EQ(256 * 1024, readahead_sizes[0]);
+  ASSERT_EQ(128 * 1024, readahead_sizes[1]);
+
+  // Nothing is read ahead past the block containing the upper bound.
+  readahead_sizes.clear();
+  std::string ub_str = Key(1) + "x";
+  Slice ub(ub_str);
+  ReadOptions read_options;
+  read_options.iterate_upper_bound = &ub;
+  iter.reset(db_->NewIterator(read_options));
+  num_keys = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ++num_keys;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(2, num_keys);
+  ASSERT_TRUE(readahead_sizes.empty());
+  iter.reset();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
 }  // namespace ROCKSDB_NAMESPACE
 
 #ifdef ROCKSDB_UNITTESTS_WITH_CUSTOM_OBJECTS_FROM_STATIC_LIBS
@@ -17,6 +17,7 @@
 #include <utility>
 #include <vector>
 
+#include "cache/cache_entry_roles.h"
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
 #include "table/block_based/block_based_table_factory.h"
@@ -257,7 +258,17 @@ static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
 static const std::string block_cache_pinned_usage = "block-cache-pinned-usage";
+static const std::string block_cache_miss_ratio_curve =
+    "block-cache-miss-ratio-curve";
+static const std::string block_cache_entry_stats = "block-cache-entry-stats";
 static const std::string options_statistics = "options-statistics";
+static const std::string trace_dropped_records = "trace-dropped-records";
+static const std::string secondary_caught_up_sequence =
+    "secondary-caught-up-sequence";
+static const std::string secondary_wal_bytes_behind =
+    "secondary-wal-bytes-behind";
+static const std::string secondary_catch_up_age_micros =
+    "secondary-catch-up-age-micros";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -345,8 +356,21 @@ const std::string DB::Properties::kBlockCacheUsage =
     rocksdb_prefix + block_cache_usage;
 const std::string DB::Properties::kBlockCachePinnedUsage =
     rocksdb_prefix + block_cache_pinned_usage;
+const std::string DB::Properties::kBlockCacheMissRatioCurve =
+    rocksdb_prefix + block_cache_miss_ratio_curve;
+const std::string DB::Properties::kBlockCacheEntryStats =
+    rocksdb_prefix + block_cache_entry_stats;
 const std::string DB::Properties::kOptionsStatistics =
     rocksdb_prefix + options_statistics;
+const std::string DB::Properties::kTraceDroppedRecords =
+    rocksdb_prefix + trace_dropped_records;
+// Handled by DBImplSecondary, which is why they are not in ppt_name_to_info.
+const std::string DB::Properties::kSecondaryCaughtUpSequence =
+    rocksdb_prefix + secondary_caught_up_sequence;
+const std::string DB::Properties::kSecondaryWalBytesBehind =
+    rocksdb_prefix + secondary_wal_bytes_behind;
+const std::string DB::Properties::kSecondaryCatchUpAgeMicros =
+    rocksdb_prefix + secondary_catch_up_age_micros;
 
 const std::unordered_map<std::string, DBPropertyInfo>
     InternalStats::ppt_name_to_info = {
@@ -483,9 +507,18 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kBlockCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlockCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kBlockCacheMissRatioCurve,
+         {false, &InternalStats::HandleBlockCacheMissRatioCurve, nullptr,
+          nullptr, nullptr}},
+        {DB::Properties::kBlockCacheEntryStats,
+         {false, &InternalStats::HandleBlockCacheEntryStats, nullptr,
+          &InternalStats::HandleBlockCacheEntryStatsMap, nullptr}},
         {DB::Properties::kOptionsStatistics,
          {false, nullptr, nullptr, nullptr,
           &DBImpl::GetPropertyHandleOptionsStatistics}},
+        {DB::Properties::kTraceDroppedRecords,
+         {false, nullptr, &InternalStats::HandleTraceDroppedRecords, nullptr,
+          nullptr}},
 };
 
 const DBPropertyInfo* GetPropertyInfo(const Slice& property) {
@@ -955,6 +988,84 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return true;
 }
 
+bool InternalStats::HandleBlockCacheMissRatioCurve(std::string* value,
+                                                   Slice /*suffix*/) {
+  Cache* block_cache;
+  std::vector<MissRatioCurvePoint> curve;
+  if (!HandleBlockCacheStat(&block_cache) ||
+      !block_cache->GetMissRatioCurve(&curve)) {
+    return false;
+  }
+  value->clear();
+  char buf[100];
+  for (const auto& point : curve) {
+    snprintf(buf, sizeof(buf), "%" ROCKSDB_PRIszt " %.4f\n", point.capacity,
+             point.miss_ratio);
+    value->append(buf);
+  }
+  return true;
+}
+
+bool InternalStats::CollectBlockCacheEntryStats(std::vector<uint64_t>* counts,
+                                                std::vector<uint64_t>* bytes) {
+  Cache* block_cache;
+  if (!HandleBlockCacheStat(&block_cache)) {
+    return false;
+  }
+  counts->assign(kNumCacheEntryRoles, 0);
+  bytes->assign(kNumCacheEntryRoles, 0);
+  auto role_map = CopyCacheDeleterRoleMap();
+  block_cache->ApplyToAllEntries(
+      [&](const Slice& /*key*/, void* /*value*/, size_t charge,
+          Cache::DeleterFn deleter) {
+        auto it = role_map.find(deleter);
+        size_t role = static_cast<size_t>(it == role_map.end()
+                                              ? CacheEntryRole::kMisc
+                                              : it->second);
+        (*counts)[role]++;
+        (*bytes)[role] += charge;
+      });
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheEntryStats(std::string* value,
+                                               Slice /*suffix*/) {
+  std::vector<uint64_t> counts;
+  std::vector<uint64_t> bytes;
+  if (!CollectBlockCacheEntryStats(&counts, &bytes)) {
+    return false;
+  }
+  value->clear();
+  char buf[200];
+  for (size_t i = 0; i < kNumCacheEntryRoles; i++) {
+    snprintf(buf, sizeof(buf), "%s: count %" PRIu64 " bytes %" PRIu64 "\n",
+             kCacheEntryRoleToHyphenString[i], counts[i], bytes[i]);
+    value->append(buf);
+  }
+  return true;
+}
+
+bool InternalStats::HandleBlockCacheEntryStatsMap(
+    std::map<std::string, std::string>* values) {
+  std::vector<uint64_t> counts;
+  std::vector<uint64_t> bytes;
+  if (!CollectBlockCacheEntryStats(&counts, &bytes)) {
+    return false;
+  }
+  for (size_t i = 0; i < kNumCacheEntryRoles; i++) {
+    std::string role = kCacheEntryRoleToHyphenString[i];
+    (*values)["count." + role] = ToString(counts[i]);
+    (*values)["bytes." + role] = ToString(bytes[i]);
+  }
+  return true;
+}
+
+bool InternalStats::HandleTraceDroppedRecords(uint64_t* value, DBImpl* db,
+                                              Version* /*version*/) {
+  *value = db->GetTraceDroppedRecords();
+  return true;
+}
+
 void InternalStats::DumpDBStats(std::string* value) {
   char buf[1000];
   // DB-level stats, only available from default column family
@@ -414,6 +414,10 @@ class InternalStats {
   void DumpCFFileHistogram(std::string* value);
 
   bool HandleBlockCacheStat(Cache** block_cache);
+  // Adds up the number and charge of the block cache entries of each
+  // CacheEntryRole.
+  bool CollectBlockCacheEntryStats(std::vector<uint64_t>* counts,
+                                   std::vector<uint64_t>* bytes);
 
   // Per-DB stats
   std::atomic<uint64_t> db_stats_[kIntStatsNumMax];
@@ -527,6 +531,10 @@ class InternalStats {
   bool HandleSsTables(std::string* value, Slice suffix);
   bool HandleAggregatedTableProperties(std::string* value, Slice suffix);
   bool HandleAggregatedTablePropertiesAtLevel(std::string* value, Slice suffix);
+  bool HandleBlockCacheMissRatioCurve(std::string* value, Slice suffix);
+  bool HandleBlockCacheEntryStats(std::string* value, Slice suffix);
+  bool HandleBlockCacheEntryStatsMap(
+      std::map<std::string, std::string>* values);
   bool HandleNumImmutableMemTable(uint64_t* value, DBImpl* db,
                                   Version* version);
   bool HandleNumImmutableMemTableFlushed(uint64_t* value, DBImpl* db,
@@ -581,6 +589,8 @@ class InternalStats {
   bool HandleBlockCacheUsage(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* db,
                                    Version* version);
+  bool HandleTraceDroppedRecords(uint64_t* value, DBImpl* db,
+                                 Version* version);
   // Total number of background errors encountered. Every time a flush task
   // or compaction task fails, this counter is incremented. The failure can
   // be caused by any possible reason, including file system errors, out of
@@ -311,6 +311,39 @@ bool RangeDelAggregator::StripeRep::IsRangeOverlapped(const Slice& start,
   return false;
 }
 
+bool RangeDelAggregator::StripeRep::IsRangeCovered(
+    const Slice& start, const Slice& end, SequenceNumber smallest_seqno,
+    SequenceNumber largest_seqno) {
+  if (IsEmpty() || !InStripe(smallest_seqno) || !InStripe(largest_seqno)) {
+    return false;
+  }
+  Invalidate();
+
+  // The range must be covered from the first internal key of `start` with a
+  // sequence number no greater than `largest_seqno`, up to and including the
+  // last internal key of `end` with a sequence number no less than
+  // `smallest_seqno`. Comparing internal keys keeps this correct for
+  // tombstones truncated at file boundaries.
+  ParsedInternalKey end_ikey(end, smallest_seqno, static_cast<ValueType>(0));
+  for (auto& iter : iters_) {
+    ParsedInternalKey covered_until(start, largest_seqno, kValueTypeForSeek);
+    // Walk the contiguous fragments of this iterator starting at the one
+    // covering `start`. A gap, or a fragment whose newest visible tombstone
+    // is not newer than `largest_seqno`, ends the walk.
+    for (iter->Seek(start); iter->Valid(); iter->Next()) {
+      if (iter->seq() <= largest_seqno ||
+          icmp_->Compare(iter->start_key(), covered_until) > 0) {
+        break;
+      }
+      covered_until = iter->end_key();
+      if (icmp_->Compare(covered_until, end_ikey) > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 void ReadRangeDelAggregator::AddTombstones(
     std::unique_ptr<FragmentedRangeTombstoneIterator> input_iter,
     const InternalKey* smallest, const InternalKey* largest) {
@@ -333,6 +366,13 @@ bool ReadRangeDelAggregator::IsRangeOverlapped(const Slice& start,
   return rep_.IsRangeOverlapped(start, end);
 }
 
+bool ReadRangeDelAggregator::IsRangeCovered(const Slice& start,
+                                            const Slice& end,
+                                            SequenceNumber smallest_seqno,
+                                            SequenceNumber largest_seqno) {
+  return rep_.IsRangeCovered(start, end, smallest_seqno, largest_seqno);
+}
+
 void CompactionRangeDelAggregator::AddTombstones(
     std::unique_ptr<FragmentedRangeTombstoneIterator> input_iter,
     const InternalKey* smallest, const InternalKey* largest) {
@@ -369,6 +409,16 @@ bool CompactionRangeDelAggregator::ShouldDelete(const ParsedInternalKey& parsed,
   return it->second.ShouldDelete(parsed, mode);
 }
 
+bool CompactionRangeDelAggregator::IsRangeCovered(
+    const Slice& start, const Slice& end, SequenceNumber smallest_seqno,
+    SequenceNumber largest_seqno) {
+  auto it = reps_.lower_bound(largest_seqno);
+  if (it == reps_.end()) {
+    return false;
+  }
+  return it->second.IsRangeCovered(start, end, smallest_seqno, largest_seqno);
+}
+
 namespace {
 
 class TruncatedRangeDelMergingIter : public InternalIterator {
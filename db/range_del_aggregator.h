@@ -295,6 +295,16 @@ class RangeDelAggregator {
 
   virtual bool IsEmpty() const = 0;
 
+  // Returns true if every key in the user key range [start, end] whose
+  // sequence number lies in [smallest_seqno, largest_seqno] is deleted by a
+  // range tombstone already added to this aggregator. This is used to skip
+  // whole files that a newer DeleteRange has made obsolete. The check is
+  // conservative: tombstones from different sources are not combined, so a
+  // false return does not imply that some key in the range is live.
+  virtual bool IsRangeCovered(const Slice& start, const Slice& end,
+                              SequenceNumber smallest_seqno,
+                              SequenceNumber largest_seqno) = 0;
+
   bool AddFile(uint64_t file_number) {
     return files_seen_.insert(file_number).second;
   }
@@ -328,6 +338,10 @@ class RangeDelAggregator {
 
     bool IsRangeOverlapped(const Slice& start, const Slice& end);
 
+    bool IsRangeCovered(const Slice& start, const Slice& end,
+                        SequenceNumber smallest_seqno,
+                        SequenceNumber largest_seqno);
+
    private:
     bool InStripe(SequenceNumber seq) const {
       return lower_bound_ <= seq && seq <= upper_bound_;
@@ -375,6 +389,10 @@ class ReadRangeDelAggregator final : public RangeDelAggregator {
 
   bool IsRangeOverlapped(const Slice& start, const Slice& end);
 
+  bool IsRangeCovered(const Slice& start, const Slice& end,
+                      SequenceNumber smallest_seqno,
+                      SequenceNumber largest_seqno) override;
+
   void InvalidateRangeDelMapPositions() override { rep_.Invalidate(); }
 
   bool IsEmpty() const override { return rep_.IsEmpty(); }
@@ -404,6 +422,13 @@ class CompactionRangeDelAggregator : public RangeDelAggregator {
 
   bool IsRangeOverlapped(const Slice& start, const Slice& end);
 
+  // Only tombstones in the same snapshot stripe as the whole range
+  // [smallest_seqno, largest_seqno] are considered, since a tombstone cannot
+  // drop a key during compaction if a snapshot separates them.
+  bool IsRangeCovered(const Slice& start, const Slice& end,
+                      SequenceNumber smallest_seqno,
+                      SequenceNumber largest_seqno) override;
+
   void InvalidateRangeDelMapPositions() override {
     for (auto& rep : reps_) {
       rep.second.Invalidate();
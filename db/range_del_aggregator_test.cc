@@ -65,6 +65,14 @@ struct ShouldDeleteTestCase {
   bool result;
 };
 
+struct IsRangeCoveredTestCase {
+  Slice start;
+  Slice end;
+  SequenceNumber smallest_seqno;
+  SequenceNumber largest_seqno;
+  bool result;
+};
+
 struct IsRangeOverlappedTestCase {
   Slice start;
   Slice end;
@@ -166,6 +174,17 @@ void VerifyIsRangeOverlapped(
   }
 }
 
+void VerifyIsRangeCovered(
+    RangeDelAggregator* range_del_agg,
+    const std::vector<IsRangeCoveredTestCase>& test_cases) {
+  for (const auto& test_case : test_cases) {
+    EXPECT_EQ(test_case.result,
+              range_del_agg->IsRangeCovered(test_case.start, test_case.end,
+                                            test_case.smallest_seqno,
+                                            test_case.largest_seqno));
+  }
+}
+
 void CheckIterPosition(const RangeTombstone& tombstone,
                        const FragmentedRangeTombstoneIterator* iter) {
   // Test InternalIterator interface.
@@ -365,6 +384,13 @@ TEST_F(RangeDelAggregatorTest, SingleIterInAggregator) {
                                            {"a", "c", true},
                                            {"d", "f", true},
                                            {"g", "l", false}});
+
+  VerifyIsRangeCovered(&range_del_agg, {{"a", "d", 0, 9, true},
+                                        {"a", "e", 0, 9, false},
+                                        {"b", "d", 0, 10, false},
+                                        {"a", "f", 0, 7, true},
+                                        {"a", "g", 0, 7, false},
+                                        {"_", "b", 0, 5, false}});
 }
 
 TEST_F(RangeDelAggregatorTest, MultipleItersInAggregator) {
@@ -588,6 +614,16 @@ TEST_F(RangeDelAggregatorTest, CompactionAggregatorWithSnapshots) {
                                                               {"e", "g", 8},
                                                               {"h", "i", 25},
                                                               {"ii", "j", 15}});
+
+  VerifyIsRangeCovered(&range_del_agg,
+                       {
+                           {"c", "f", 0, 7, true},     // [0, 9]
+                           {"a", "d", 0, 7, false},    // [0, 9]
+                           {"c", "f", 5, 12, false},   // [0, 9], [10, 19]
+                           {"a", "d", 10, 12, false},  // [10, 19]
+                           {"ii", "iz", 10, 14, true},  // [10, 19]
+                           {"h", "h", 20, 24, true}  // [20, kMaxSequenceNumber]
+                       });
 }
 
 TEST_F(RangeDelAggregatorTest, CompactionAggregatorEmptyIteratorLeft) {
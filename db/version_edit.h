@@ -171,6 +171,7 @@ struct FileMetaData {
   // single-threaded LogAndApply thread
   uint64_t num_entries = 0;     // the number of entries.
   uint64_t num_deletions = 0;   // the number of deletion entries.
+  uint64_t num_range_deletions = 0;  // the number of range deletion entries.
   uint64_t raw_key_size = 0;    // total uncompressed key size.
   uint64_t raw_value_size = 0;  // total uncompressed value size.
 
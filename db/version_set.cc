@@ -1009,6 +1009,25 @@ class LevelIterator final : public InternalIterator {
         largest_compaction_key, allow_unprepared_value_);
   }
 
+  // Returns true if range tombstones already collected from newer data
+  // delete every key of the file at file_index_, in which case the file
+  // does not need to be opened at all.
+  bool FileCoveredByRangeTombstone() {
+    if (range_del_agg_ == nullptr || range_del_agg_->IsEmpty()) {
+      return false;
+    }
+    const FdWithKeyRange& file = flevel_->files[file_index_];
+    if (!range_del_agg_->IsRangeCovered(ExtractUserKey(file.smallest_key),
+                                        ExtractUserKey(file.largest_key),
+                                        file.fd.smallest_seqno,
+                                        file.fd.largest_seqno)) {
+      return false;
+    }
+    TEST_SYNC_POINT_CALLBACK("LevelIterator::SkipCoveredFile",
+                             file.file_metadata);
+    return true;
+  }
+
   // Check if current file being fully within iterate_lower_bound.
   //
   // Note MyRocks may update iterate bounds between seek. To workaround it,
@@ -1114,8 +1133,8 @@ void LevelIterator::SeekForPrev(const Slice& target) {
   InitFileIterator(new_file_index);
   if (file_iter_.iter() != nullptr) {
     file_iter_.SeekForPrev(target);
-    SkipEmptyFileBackward();
   }
+  SkipEmptyFileBackward();
   CheckMayBeOutOfLowerBound();
 }
 
@@ -1237,6 +1256,12 @@ void LevelIterator::InitFileIterator(size_t new_file_index) {
       // no need to change anything
     } else {
       file_index_ = new_file_index;
+      if (FileCoveredByRangeTombstone()) {
+        // Every key in the file is deleted by a newer range tombstone, so
+        // leave the file iterator empty and let the caller move past it.
+        SetFileIterator(nullptr);
+        return;
+      }
       InternalIterator* iter = NewFileIterator();
       SetFileIterator(iter);
     }
@@ -2170,6 +2195,7 @@ bool Version::MaybeInitializeFileMetaData(FileMetaData* file_meta) {
   if (tp.get() == nullptr) return false;
   file_meta->num_entries = tp->num_entries;
   file_meta->num_deletions = tp->num_deletions;
+  file_meta->num_range_deletions = tp->num_range_deletions;
   file_meta->raw_value_size = tp->raw_value_size;
   file_meta->raw_key_size = tp->raw_key_size;
 
@@ -2284,11 +2310,43 @@ void VersionStorageInfo::ComputeCompensatedSizes() {
               (file_meta->num_deletions * 2 - file_meta->num_entries) *
               average_value_size * kDeletionWeightOnCompaction;
         }
+        // A range tombstone may obsolete whole files below it. Compensating
+        // for their size makes the compaction that drops them be picked
+        // sooner, reclaiming the space without waiting for the level to
+        // grow past its target.
+        if (compaction_style_ == kCompactionStyleLevel &&
+            file_meta->num_range_deletions > 0) {
+          file_meta->compensated_file_size +=
+              EstimateRangeDeletionCoveredBytes(level, file_meta);
+        }
       }
     }
   }
 }
 
+uint64_t VersionStorageInfo::EstimateRangeDeletionCoveredBytes(
+    int level, const FileMetaData* f) const {
+  int next_level = level + 1;
+  while (next_level < num_levels_ && files_[next_level].empty()) {
+    ++next_level;
+  }
+  if (next_level >= num_levels_) {
+    return 0;
+  }
+  const Slice smallest_user_key = f->smallest.user_key();
+  const Slice largest_user_key = f->largest.user_key();
+  uint64_t covered_bytes = 0;
+  for (const auto* next_file : files_[next_level]) {
+    if (user_comparator_->Compare(next_file->smallest.user_key(),
+                                  smallest_user_key) >= 0 &&
+        user_comparator_->Compare(next_file->largest.user_key(),
+                                  largest_user_key) <= 0) {
+      covered_bytes += next_file->fd.GetFileSize();
+    }
+  }
+  return covered_bytes;
+}
+
 int VersionStorageInfo::MaxInputLevel() const {
   if (compaction_style_ == kCompactionStyleLevel) {
     return num_levels() - 2;
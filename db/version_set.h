@@ -141,6 +141,13 @@ class VersionStorageInfo {
 
   void ComputeCompensatedSizes();
 
+  // Returns the total size of files in the first non-empty level below
+  // `level` whose key range lies entirely within the key range of `f`. When
+  // `f` holds range tombstones, these are the files a compaction of `f` may
+  // be able to drop without rewriting them.
+  uint64_t EstimateRangeDeletionCoveredBytes(int level,
+                                             const FileMetaData* f) const;
+
   // Updates internal structures that keep track of compaction scores
   // We use compaction scores to figure out which compaction to do next
   // REQUIRES: db_mutex held!!
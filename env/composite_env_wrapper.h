@@ -563,6 +563,10 @@ class CompositeEnvWrapper : public Env {
     env_target_->LowerThreadPoolCPUPriority(pool);
   }
 
+  void PinThreadPoolToNumaNodes(Priority pool) override {
+    env_target_->PinThreadPoolToNumaNodes(pool);
+  }
+
   Status LowerThreadPoolCPUPriority(Priority pool, CpuPriority pri) override {
     return env_target_->LowerThreadPoolCPUPriority(pool, pri);
   }
@@ -309,12 +309,12 @@ class PosixEnv : public CompositeEnvWrapper {
 
   // Allow increasing the number of worker threads.
   void SetBackgroundThreads(int num, Priority pri) override {
-    assert(pri >= Priority::BOTTOM && pri <= Priority::HIGH);
+    assert(pri >= Priority::BOTTOM && pri <= Priority::USER);
     thread_pools_[pri].SetBackgroundThreads(num);
   }
 
   int GetBackgroundThreads(Priority pri) override {
-    assert(pri >= Priority::BOTTOM && pri <= Priority::HIGH);
+    assert(pri >= Priority::BOTTOM && pri <= Priority::USER);
     return thread_pools_[pri].GetBackgroundThreads();
   }
 
@@ -325,7 +325,7 @@ class PosixEnv : public CompositeEnvWrapper {
 
   // Allow increasing the number of worker threads.
   void IncBackgroundThreadsIfNeeded(int num, Priority pri) override {
-    assert(pri >= Priority::BOTTOM && pri <= Priority::HIGH);
+    assert(pri >= Priority::BOTTOM && pri <= Priority::USER);
     thread_pools_[pri].IncBackgroundThreadsIfNeeded(num);
   }
 
@@ -349,6 +349,11 @@ class PosixEnv : public CompositeEnvWrapper {
     return Status::OK();
   }
 
+  void PinThreadPoolToNumaNodes(Priority pool) override {
+    assert(pool >= Priority::BOTTOM && pool <= Priority::HIGH);
+    thread_pools_[pool].PinToNumaNodes();
+  }
+
   std::string TimeToString(uint64_t secondsSince1970) override {
     const time_t seconds = (time_t)secondsSince1970;
     struct tm t;
@@ -419,7 +424,7 @@ PosixEnv::PosixEnv(const PosixEnv* default_env, std::shared_ptr<FileSystem> fs)
 
 void PosixEnv::Schedule(void (*function)(void* arg1), void* arg, Priority pri,
                         void* tag, void (*unschedFunction)(void* arg)) {
-  assert(pri >= Priority::BOTTOM && pri <= Priority::HIGH);
+  assert(pri >= Priority::BOTTOM && pri <= Priority::USER);
   thread_pools_[pri].Schedule(function, arg, tag, unschedFunction);
 }
 
@@ -428,7 +433,7 @@ int PosixEnv::UnSchedule(void* arg, Priority pri) {
 }
 
 unsigned int PosixEnv::GetThreadPoolQueueLen(Priority pri) const {
-  assert(pri >= Priority::BOTTOM && pri <= Priority::HIGH);
+  assert(pri >= Priority::BOTTOM && pri <= Priority::USER);
   return thread_pools_[pri].GetQueueLen();
 }
 
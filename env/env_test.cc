@@ -281,6 +281,34 @@ TEST_F(EnvPosixTest, LowerThreadPoolCpuPriority) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
+
+TEST_F(EnvPosixTest, PinThreadPoolToNumaNodes) {
+  std::atomic<int> pinned_node(-1);
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "ThreadPoolImpl::BGThread::PinnedToNumaNode",
+      [&](void* node) { pinned_node.store(*reinterpret_cast<int*>(node)); });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  env_->SetBackgroundThreads(1, Env::BOTTOM);
+  env_->PinThreadPoolToNumaNodes(Env::Priority::BOTTOM);
+
+  std::atomic<bool> called(false);
+  env_->Schedule(&SetBool, &called, Env::Priority::BOTTOM);
+  for (int i = 0; i < kDelayMicros; i++) {
+    if (called.load()) {
+      break;
+    }
+    Env::Default()->SleepForMicroseconds(1);
+  }
+  ASSERT_TRUE(called.load());
+  // The thread pins itself before running the next job, whether or not the
+  // machine has NUMA support.
+  ASSERT_GE(pinned_node.load(), 0);
+  ASSERT_LT(pinned_node.load(), port::GetNumaNodeCount());
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
 #endif
 
 TEST_F(EnvPosixTest, MemoryMappedFileBuffer) {
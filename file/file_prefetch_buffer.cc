@@ -18,9 +18,174 @@
 #include "port/port.h"
 #include "test_util/sync_point.h"
 #include "util/random.h"
+#include "util/mutexlock.h"
 #include "util/rate_limiter.h"
 
 namespace ROCKSDB_NAMESPACE {
+struct FilePrefetchBuffer::AsyncReadState {
+  explicit AsyncReadState(Env* _env) : env(_env), cv(&mu) {}
+
+  Env* const env;
+  port::Mutex mu;
+  port::CondVar cv;
+  // True while a background read into `buffer` is scheduled or running.
+  // Protected by mu. The fields below are owned by the background read while
+  // it is pending and by the FilePrefetchBuffer otherwise.
+  bool pending = false;
+  RandomAccessFileReader* reader = nullptr;
+  IOOptions opts;
+  bool for_compaction = false;
+  uint64_t offset = 0;
+  size_t len = 0;
+  AlignedBuffer buffer;
+  Status status;
+  // Set once a read comes back short. No more background reads are issued.
+  bool eof = false;
+};
+
+FilePrefetchBuffer::FilePrefetchBuffer(RandomAccessFileReader* file_reader,
+                                       size_t readadhead_size,
+                                       size_t max_readahead_size, bool enable,
+                                       bool track_min_offset, Env* async_env)
+    : buffer_offset_(0),
+      file_reader_(file_reader),
+      readahead_size_(readadhead_size),
+      max_readahead_size_(max_readahead_size),
+      min_offset_read_(port::kMaxSizet),
+      enable_(enable),
+      track_min_offset_(track_min_offset) {
+  // Without USER priority threads the background read would never run.
+  if (async_env != nullptr && file_reader_ != nullptr && enable_ &&
+      readahead_size_ > 0 &&
+      async_env->GetBackgroundThreads(Env::Priority::USER) > 0) {
+    async_state_.reset(new AsyncReadState(async_env));
+  }
+}
+
+FilePrefetchBuffer::~FilePrefetchBuffer() {
+  if (async_state_ == nullptr) {
+    return;
+  }
+  AsyncReadState* state = async_state_.get();
+  int unscheduled = state->env->UnSchedule(state, Env::Priority::USER);
+  MutexLock l(&state->mu);
+  if (unscheduled > 0) {
+    state->pending = false;
+  }
+  while (state->pending) {
+    state->cv.Wait();
+  }
+}
+
+void FilePrefetchBuffer::AsyncRead(void* arg) {
+  AsyncReadState* state = reinterpret_cast<AsyncReadState*>(arg);
+  Slice result;
+  Status s = state->reader->Read(state->opts, state->offset, state->len,
+                                 &result, state->buffer.BufferStart(),
+                                 nullptr, state->for_compaction);
+  MutexLock l(&state->mu);
+  state->status = s;
+  state->buffer.Size(s.ok() ? result.size() : 0);
+  state->pending = false;
+  state->cv.SignalAll();
+}
+
+void FilePrefetchBuffer::MaybeScheduleAsyncRead(const IOOptions& opts,
+                                                bool for_compaction) {
+  AsyncReadState* state = async_state_.get();
+  if (state->eof) {
+    return;
+  }
+  uint64_t next_offset = buffer_offset_ + buffer_.CurrentSize();
+  {
+    MutexLock l(&state->mu);
+    if (state->pending) {
+      return;
+    }
+  }
+  if (state->buffer.CurrentSize() > 0 && state->offset == next_offset) {
+    // The next chunk is already buffered.
+    return;
+  }
+  size_t alignment = file_reader_->file()->GetRequiredBufferAlignment();
+  if (next_offset % alignment != 0) {
+    // Only a read that hit the end of the file leaves the buffer unaligned.
+    return;
+  }
+  size_t len = Roundup(readahead_size_, alignment);
+  state->buffer.Alignment(alignment);
+  if (state->buffer.Capacity() < len) {
+    state->buffer.AllocateNewBuffer(len);
+  }
+  state->buffer.Size(0);
+  state->reader = file_reader_;
+  state->opts = opts;
+  state->for_compaction = for_compaction;
+  state->offset = next_offset;
+  state->len = len;
+  {
+    MutexLock l(&state->mu);
+    state->pending = true;
+  }
+  TEST_SYNC_POINT("FilePrefetchBuffer::MaybeScheduleAsyncRead:Schedule");
+  state->env->Schedule(&FilePrefetchBuffer::AsyncRead, state,
+                       Env::Priority::USER, state);
+}
+
+bool FilePrefetchBuffer::TryReadFromAsyncBuffer(uint64_t offset, size_t n) {
+  AsyncReadState* state = async_state_.get();
+  {
+    MutexLock l(&state->mu);
+    while (state->pending) {
+      state->cv.Wait();
+    }
+  }
+  if (!state->status.ok()) {
+    // Let the synchronous read retry and surface the error.
+    state->status = Status::OK();
+    state->buffer.Size(0);
+    return false;
+  }
+  size_t async_size = state->buffer.CurrentSize();
+  if (async_size < state->len) {
+    state->eof = true;
+  }
+  uint64_t buffer_end = buffer_offset_ + buffer_.CurrentSize();
+  if (async_size == 0 || offset + n > state->offset + async_size) {
+    state->buffer.Size(0);
+    return false;
+  }
+  if (offset >= state->offset) {
+    // The request lies entirely in the second buffer. Swap the buffers so
+    // that the old one is reused for the next background read.
+    std::swap(buffer_, state->buffer);
+    buffer_offset_ = state->offset;
+  } else if (buffer_.CurrentSize() > 0 && offset >= buffer_offset_ &&
+             buffer_end == state->offset) {
+    // The request straddles both buffers. Keep the tail of the current
+    // buffer starting at the request and append the second buffer to it.
+    size_t alignment = buffer_.Alignment();
+    size_t chunk_offset_in_buffer =
+        Rounddown(static_cast<size_t>(offset - buffer_offset_), alignment);
+    size_t chunk_len = buffer_.CurrentSize() - chunk_offset_in_buffer;
+    size_t new_size = chunk_len + async_size;
+    if (buffer_.Capacity() < new_size) {
+      buffer_.AllocateNewBuffer(new_size, true /* copy_data */,
+                                chunk_offset_in_buffer, chunk_len);
+    } else {
+      buffer_.RefitTail(chunk_offset_in_buffer, chunk_len);
+    }
+    buffer_.Append(state->buffer.BufferStart(), async_size);
+    buffer_offset_ += chunk_offset_in_buffer;
+  } else {
+    state->buffer.Size(0);
+    return false;
+  }
+  state->buffer.Size(0);
+  TEST_SYNC_POINT("FilePrefetchBuffer::TryReadFromAsyncBuffer:Hit");
+  return true;
+}
+
 Status FilePrefetchBuffer::Prefetch(const IOOptions& opts,
                                     RandomAccessFileReader* reader,
                                     uint64_t offset, size_t n,
@@ -122,18 +287,32 @@ bool FilePrefetchBuffer::TryReadFromCache(const IOOptions& opts,
     if (readahead_size_ > 0) {
       assert(file_reader_ != nullptr);
       assert(max_readahead_size_ >= readahead_size_);
-      Status s;
-      if (for_compaction) {
-        s = Prefetch(opts, file_reader_, offset, std::max(n, readahead_size_),
-                     for_compaction);
-      } else {
-        s = Prefetch(opts, file_reader_, offset, n + readahead_size_,
-                     for_compaction);
+      // Readahead for user reads is charged to the rate limiter at
+      // IO_USER unless the read asked for another priority.
+      IOOptions readahead_opts = opts;
+      if (!for_compaction &&
+          readahead_opts.rate_limiter_priority == Env::IO_TOTAL) {
+        readahead_opts.rate_limiter_priority = Env::IO_USER;
       }
-      if (!s.ok()) {
-        return false;
+      if (async_state_ == nullptr || !TryReadFromAsyncBuffer(offset, n)) {
+        Status s;
+        if (for_compaction) {
+          s = Prefetch(readahead_opts, file_reader_, offset,
+                       std::max(n, readahead_size_), for_compaction);
+        } else {
+          s = Prefetch(readahead_opts, file_reader_, offset,
+                       n + readahead_size_, for_compaction);
+        }
+        if (!s.ok()) {
+          return false;
+        }
       }
       readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
+      if (async_state_ != nullptr) {
+        // The consumer just moved into a new chunk; start reading the one
+        // after it.
+        MaybeScheduleAsyncRead(readahead_opts, for_compaction);
+      }
     } else {
       return false;
     }
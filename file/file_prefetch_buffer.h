@@ -9,6 +9,7 @@
 
 #pragma once
 #include <atomic>
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -38,6 +39,11 @@ class FilePrefetchBuffer {
   //   for the minimum offset if track_min_offset = true.
   // track_min_offset : Track the minimum offset ever read and collect stats on
   //   it. Used for adaptable readahead of the file footer/metadata.
+  // async_env : if non-null, the buffer is double-buffered. Once a readahead
+  //   refill is served, the next readahead chunk is read in the background on
+  //   the Env::Priority::USER thread pool of async_env, so that the consumer
+  //   does not block on the following refill. Ignored if that thread pool has
+  //   no threads.
   //
   // Automatic readhead is enabled for a file if file_reader, readahead_size,
   // and max_readahead_size are passed in.
@@ -47,14 +53,11 @@ class FilePrefetchBuffer {
   // `Prefetch` to load data into the buffer.
   FilePrefetchBuffer(RandomAccessFileReader* file_reader = nullptr,
                      size_t readadhead_size = 0, size_t max_readahead_size = 0,
-                     bool enable = true, bool track_min_offset = false)
-      : buffer_offset_(0),
-        file_reader_(file_reader),
-        readahead_size_(readadhead_size),
-        max_readahead_size_(max_readahead_size),
-        min_offset_read_(port::kMaxSizet),
-        enable_(enable),
-        track_min_offset_(track_min_offset) {}
+                     bool enable = true, bool track_min_offset = false,
+                     Env* async_env = nullptr);
+
+  // Waits for the in-flight background read, if any.
+  ~FilePrefetchBuffer();
 
   // Load data into the buffer from a file.
   // reader : the file reader.
@@ -82,6 +85,21 @@ class FilePrefetchBuffer {
   size_t min_offset_read() const { return min_offset_read_; }
 
  private:
+  struct AsyncReadState;
+
+  // Schedules a background read of the readahead_size_ bytes following the
+  // current buffer, unless one is already in flight or the end of the file
+  // was reached.
+  void MaybeScheduleAsyncRead(const IOOptions& opts, bool for_compaction);
+
+  // Waits for the in-flight background read and, if its data together with
+  // the tail of the current buffer covers [offset, offset + n), makes that
+  // the current buffer. Returns false if the request has to be served by a
+  // synchronous read instead.
+  bool TryReadFromAsyncBuffer(uint64_t offset, size_t n);
+
+  static void AsyncRead(void* arg);
+
   AlignedBuffer buffer_;
   uint64_t buffer_offset_;
   RandomAccessFileReader* file_reader_;
@@ -95,5 +113,8 @@ class FilePrefetchBuffer {
   // If true, track minimum `offset` ever passed to TryReadFromCache(), which
   // can be fetched from min_offset_read().
   bool track_min_offset_;
+  // Second buffer and its background read. Only set if async_env is passed
+  // in and has USER priority threads.
+  std::unique_ptr<AsyncReadState> async_state_;
 };
 }  // namespace ROCKSDB_NAMESPACE
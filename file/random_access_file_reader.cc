@@ -29,6 +29,12 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
   (void)aligned_buf;
 
   TEST_SYNC_POINT_CALLBACK("RandomAccessFileReader::Read", nullptr);
+  Env::IOPriority rate_limiter_priority = opts.rate_limiter_priority;
+  if (rate_limiter_priority == Env::IO_TOTAL && for_compaction) {
+    rate_limiter_priority = Env::IO_LOW;
+  }
+  const bool charge_rate_limiter =
+      rate_limiter_ != nullptr && rate_limiter_priority != Env::IO_TOTAL;
   Status s;
   uint64_t elapsed = 0;
   {
@@ -50,10 +56,10 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
       buf.AllocateNewBuffer(read_size);
       while (buf.CurrentSize() < read_size) {
         size_t allowed;
-        if (for_compaction && rate_limiter_ != nullptr) {
+        if (charge_rate_limiter) {
           allowed = rate_limiter_->RequestToken(
               buf.Capacity() - buf.CurrentSize(), buf.Alignment(),
-              Env::IOPriority::IO_LOW, stats_, RateLimiter::OpType::kRead);
+              rate_limiter_priority, stats_, RateLimiter::OpType::kRead);
         } else {
           assert(buf.CurrentSize() == 0);
           allowed = read_size;
@@ -70,10 +76,11 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
         {
           IOSTATS_CPU_TIMER_GUARD(cpu_read_nanos, env_);
           // Only user reads are expected to specify a timeout. And user reads
-          // are not subjected to rate_limiter and should go through only
-          // one iteration of this loop, so we don't need to check and adjust
-          // the opts.timeout before calling file_->Read
-          assert(!opts.timeout.count() || allowed == read_size);
+          // go through only one iteration of this loop unless they are
+          // charged to the rate limiter, in which case every iteration gets
+          // the whole opts.timeout
+          assert(!opts.timeout.count() || allowed == read_size ||
+                 charge_rate_limiter);
           s = file_->Read(aligned_offset + buf.CurrentSize(), allowed, opts,
                           &tmp, buf.Destination(), nullptr);
         }
@@ -105,12 +112,12 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
       const char* res_scratch = nullptr;
       while (pos < n) {
         size_t allowed;
-        if (for_compaction && rate_limiter_ != nullptr) {
+        if (charge_rate_limiter) {
           if (rate_limiter_->IsRateLimited(RateLimiter::OpType::kRead)) {
             sw.DelayStart();
           }
           allowed = rate_limiter_->RequestToken(n - pos, 0 /* alignment */,
-                                                Env::IOPriority::IO_LOW, stats_,
+                                                rate_limiter_priority, stats_,
                                                 RateLimiter::OpType::kRead);
           if (rate_limiter_->IsRateLimited(RateLimiter::OpType::kRead)) {
             sw.DelayStop();
@@ -130,10 +137,11 @@ Status RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
         {
           IOSTATS_CPU_TIMER_GUARD(cpu_read_nanos, env_);
           // Only user reads are expected to specify a timeout. And user reads
-          // are not subjected to rate_limiter and should go through only
-          // one iteration of this loop, so we don't need to check and adjust
-          // the opts.timeout before calling file_->Read
-          assert(!opts.timeout.count() || allowed == n);
+          // go through only one iteration of this loop unless they are
+          // charged to the rate limiter, in which case every iteration gets
+          // the whole opts.timeout
+          assert(!opts.timeout.count() || allowed == n ||
+                 charge_rate_limiter);
           s = file_->Read(offset + pos, allowed, opts, &tmp_result,
                           scratch + pos, nullptr);
         }
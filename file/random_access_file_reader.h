@@ -128,6 +128,9 @@ class RandomAccessFileReader {
   // 2. Otherwise, scratch is not used and can be null, the aligned_buf owns
   // the internally allocated buffer on return, and the result refers to a
   // region in aligned_buf.
+  //
+  // The read is charged to the rate limiter at opts.rate_limiter_priority,
+  // or at Env::IO_LOW if that is Env::IO_TOTAL and for_compaction is true.
   Status Read(const IOOptions& opts, uint64_t offset, size_t n, Slice* result,
               char* scratch, AlignedBuf* aligned_buf,
               bool for_compaction = false) const;
@@ -23,8 +23,10 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 #include "rocksdb/memory_allocator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
@@ -87,6 +89,48 @@ struct LRUCacheOptions {
   CacheMetadataChargePolicy metadata_charge_policy =
       kDefaultCacheMetadataChargePolicy;
 
+  // If > 0, the cache estimates its miss ratio at capacities from a quarter
+  // to four times its capacity, from the lookups of this fraction of the
+  // keys, picked by hash. See Cache::GetMissRatioCurve(). Each shard tracks up
+  // to 64K sampled keys, so 0.001 to 0.01 is enough for most caches. Must be
+  // at most 1.
+  double miss_ratio_curve_sampling_rate = 0.0;
+
+  // If set, an entry of high (resp. low) priority whose insertion would evict
+  // other entries is only admitted into the cache if its key was looked up
+  // more often recently than the key of the least recently used entry, as
+  // estimated by a frequency sketch of the shard (TinyLFU). This keeps keys
+  // read once, e.g. by scans, from pushing the hot entries out. A rejected
+  // entry is handled as if it were inserted and evicted right away: Insert()
+  // still returns OK, and the handle it returns, if any, refers to an entry
+  // outside of the cache that is freed on its release. With
+  // strict_capacity_limit, inserts that return a handle are always admitted.
+  //
+  // When used as block cache, data blocks are inserted with low priority,
+  // and index and filter blocks with high priority if
+  // BlockBasedTableOptions::cache_index_and_filter_blocks_with_high_priority
+  // is set.
+  bool high_pri_admission_control = false;
+  bool low_pri_admission_control = false;
+
+  // If greater than zero, low priority entries are first inserted into a
+  // probation FIFO, and only move to the LRU list when they are hit. While
+  // the probation entries take at least this ratio of the capacity, they are
+  // evicted first, oldest first. Blocks read once, e.g. by a scan, thus only
+  // replace each other instead of evicting the entries that are used
+  // repeatedly (as in the S3-FIFO and 2Q eviction policies). High priority
+  // entries are inserted into the LRU list directly. Must be at most 1.
+  double probation_pool_ratio = 0.0;
+
+  // If set, the shards are replicated once per NUMA node. Entries are
+  // inserted into the shards of the node of the inserting thread, and looked
+  // up there first, so that most hits read node-local memory, then in the
+  // shards of the other nodes. The capacity is split across all the shards.
+  // Without NUMA support (RocksDB built without -DNUMA, or a single node),
+  // there is a single set of shards as usual. Works best together with
+  // Env::PinThreadPoolToNumaNodes() and pinned foreground threads.
+  bool numa_aware = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -131,6 +175,14 @@ extern std::shared_ptr<Cache> NewClockCache(
     bool strict_capacity_limit = false,
     CacheMetadataChargePolicy metadata_charge_policy =
         kDefaultCacheMetadataChargePolicy);
+// A point of the miss ratio curve of a cache.
+struct MissRatioCurvePoint {
+  // Simulated capacity of the cache, in bytes.
+  size_t capacity;
+  // Estimated fraction of the lookups that miss in a cache of this capacity.
+  double miss_ratio;
+};
+
 class Cache {
  public:
   // Depending on implementation, cache entries with high priority could be less
@@ -167,6 +219,9 @@ class Cache {
   // Opaque handle to an entry stored in the cache.
   struct Handle {};
 
+  // The function the cache calls to destroy the value of an entry.
+  using DeleterFn = void (*)(const Slice& key, void* value);
+
   // The type of the Cache
   virtual const char* Name() const = 0;
 
@@ -279,12 +334,31 @@ class Cache {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
 
+  // Apply callback to all entries in the cache, passing their key, value,
+  // charge and deleter. The deleter tells what kind of object the value is,
+  // e.g. to break down the usage of the cache. Locks are held while the
+  // callback runs, so it must not call back into the cache. The default
+  // implementation visits no entry.
+  virtual void ApplyToAllEntries(
+      const std::function<void(const Slice& key, void* value, size_t charge,
+                               DeleterFn deleter)>& /*callback*/) {}
+
   // Remove all entries.
   // Prerequisite: no entry is referenced.
   virtual void EraseUnRefEntries() = 0;
 
   virtual std::string GetPrintableOptions() const { return ""; }
 
+  // Fills *curve with the estimated miss ratio of the cache at several
+  // capacities around its current one, in ascending capacity order. The
+  // estimate follows the recent lookups, so it can be used to right-size the
+  // cache without collecting traces. Returns false if the cache does not
+  // estimate it, or has not sampled any lookup yet.
+  virtual bool GetMissRatioCurve(
+      std::vector<MissRatioCurvePoint>* /*curve*/) const {
+    return false;
+  }
+
   MemoryAllocator* memory_allocator() const { return memory_allocator_.get(); }
 
  private:
@@ -699,6 +699,27 @@ class DB {
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) = 0;
 
+  // Splits the key range [*begin, *end) of a column family into at most
+  // num_ranges consecutive sub-ranges holding roughly the same amount of
+  // data, and returns one iterator per sub-range in key order. A nullptr
+  // begin or end means the range is unbounded on that side. The split points
+  // are chosen among the boundaries of the column family's table files,
+  // weighted by GetApproximateSizes(), so fewer iterators may be returned if
+  // the range covers few files.
+  //
+  // Each iterator is bounded to its sub-range; options.iterate_lower_bound
+  // and options.iterate_upper_bound are ignored. All iterators read from
+  // options.snapshot if set, otherwise from a snapshot taken by this call
+  // that is released once the last of them is deleted. The iterators share
+  // no state, so they can be used concurrently from different threads,
+  // e.g. to scan a whole column family in parallel. They are heap allocated
+  // and need to be deleted before the db is deleted.
+  virtual Status NewParallelIterators(const ReadOptions& options,
+                                      ColumnFamilyHandle* column_family,
+                                      const Slice* begin, const Slice* end,
+                                      size_t num_ranges,
+                                      std::vector<Iterator*>* iterators);
+
   // Return a handle to the current DB state.  Iterators created with
   // this handle will all observe a stable snapshot of the current DB
   // state.  The caller must call ReleaseSnapshot(result) when the
@@ -924,9 +945,45 @@ class DB {
     //      entries being pinned.
     static const std::string kBlockCachePinnedUsage;
 
+    // "rocksdb.block-cache-miss-ratio-curve" - returns multi-line string with
+    //      the estimated block cache miss ratio at capacities from a quarter
+    //      to four times the block cache capacity, one "<capacity in bytes>
+    //      <miss ratio>" line per capacity. Only available if the block cache
+    //      estimates it (see LRUCacheOptions::miss_ratio_curve_sampling_rate).
+    static const std::string kBlockCacheMissRatioCurve;
+
+    // "rocksdb.block-cache-entry-stats" - returns a multi-line string, or a
+    //      map with GetMapProperty(), with the number ("count.<role>") and
+    //      total charge ("bytes.<role>") of the block cache entries of each
+    //      role: "data-block", "filter-block", "index-block",
+    //      "compression-dictionary-block", "other-block", the reservations
+    //      "write-buffer", "filter-construction" and
+    //      "block-based-table-reader", and "misc". It scans the whole block
+    //      cache, so it should not be queried often.
+    static const std::string kBlockCacheEntryStats;
+
     // "rocksdb.options-statistics" - returns multi-line string
     //      of options.statistics
     static const std::string kOptionsStatistics;
+
+    //  "rocksdb.trace-dropped-records" - returns the number of query traces
+    //      dropped since the DB was opened because the trace buffer of their
+    //      thread was full (see TraceOptions::buffer_size).
+    static const std::string kTraceDroppedRecords;
+
+    // The following are only supported by secondary instances.
+
+    //  "rocksdb.secondary-caught-up-sequence" - returns the last sequence
+    //      number applied from the primary's MANIFEST and WAL files.
+    static const std::string kSecondaryCaughtUpSequence;
+
+    //  "rocksdb.secondary-wal-bytes-behind" - returns the number of bytes the
+    //      primary has written to its WAL files that are not applied yet.
+    static const std::string kSecondaryWalBytesBehind;
+
+    //  "rocksdb.secondary-catch-up-age-micros" - returns the time since the
+    //      last successful catch-up with the primary, in microseconds.
+    static const std::string kSecondaryCatchUpAgeMicros;
   };
 #endif /* ROCKSDB_LITE */
 
@@ -983,6 +1040,9 @@ class DB {
   //  "rocksdb.block-cache-capacity"
   //  "rocksdb.block-cache-usage"
   //  "rocksdb.block-cache-pinned-usage"
+  //  "rocksdb.secondary-caught-up-sequence"
+  //  "rocksdb.secondary-wal-bytes-behind"
+  //  "rocksdb.secondary-catch-up-age-micros"
   virtual bool GetIntProperty(ColumnFamilyHandle* column_family,
                               const Slice& property, uint64_t* value) = 0;
   virtual bool GetIntProperty(const Slice& property, uint64_t* value) {
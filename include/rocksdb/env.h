@@ -389,8 +389,17 @@ class Env {
 
   static std::string PriorityToString(Priority priority);
 
-  // Priority for requesting bytes in rate limiter scheduler
-  enum IOPriority { IO_LOW = 0, IO_HIGH = 1, IO_TOTAL = 2 };
+  // Priority for requesting bytes in rate limiter scheduler. From the lowest:
+  // compactions that do not read L0 and backups (IO_LOW), compactions that
+  // read L0 (IO_MID), flushes (IO_HIGH) and user reads (IO_USER). IO_TOTAL
+  // means the I/O is not charged to the rate limiter.
+  enum IOPriority {
+    IO_LOW = 0,
+    IO_MID = 1,
+    IO_HIGH = 2,
+    IO_USER = 3,
+    IO_TOTAL = 4
+  };
 
   // Arrange to run "(*function)(arg)" once in a background thread, in
   // the thread pool specified by pri. By default, jobs go to the 'LOW'
@@ -491,6 +500,12 @@ class Env {
   // Lower CPU priority for threads from the specified pool.
   virtual void LowerThreadPoolCPUPriority(Priority /*pool*/ = LOW) {}
 
+  // Run each thread from the specified pool on the CPUs of one NUMA node,
+  // allocating memory from that node, with the threads spread over the
+  // nodes. Does nothing on a single node, or if RocksDB was not built with
+  // NUMA support.
+  virtual void PinThreadPoolToNumaNodes(Priority /*pool*/ = LOW) {}
+
   // Converts seconds-since-Jan-01-1970 to a printable string
   virtual std::string TimeToString(uint64_t time) = 0;
 
@@ -1379,6 +1394,10 @@ class EnvWrapper : public Env {
     target_->LowerThreadPoolCPUPriority(pool);
   }
 
+  void PinThreadPoolToNumaNodes(Priority pool) override {
+    target_->PinThreadPoolToNumaNodes(pool);
+  }
+
   Status LowerThreadPoolCPUPriority(Priority pool, CpuPriority pri) override {
     return target_->LowerThreadPoolCPUPriority(pool, pri);
   }
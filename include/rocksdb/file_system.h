@@ -86,7 +86,15 @@ struct IOOptions {
   // Type of data being read/written
   IOType type;
 
-  IOOptions() : timeout(0), prio(IOPriority::kIOLow), type(IOType::kUnknown) {}
+  // Priority at which reads are charged to the rate limiter of the file
+  // reader. Env::IO_TOTAL means they are not charged.
+  Env::IOPriority rate_limiter_priority;
+
+  IOOptions()
+      : timeout(0),
+        prio(IOPriority::kIOLow),
+        type(IOType::kUnknown),
+        rate_limiter_priority(Env::IO_TOTAL) {}
 };
 
 // File scope options that control how a file is opened/created and accessed
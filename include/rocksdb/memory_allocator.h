@@ -74,4 +74,38 @@ extern Status NewJemallocNodumpAllocator(
     JemallocAllocatorOptions& options,
     std::shared_ptr<MemoryAllocator>* memory_allocator);
 
+struct SlabAllocatorOptions {
+  // Size of the slabs the allocations are carved from. Must be a multiple of
+  // the page size. To be backed by huge pages, it should be a multiple of the
+  // huge page size (2MB on x86-64).
+  size_t slab_size = 2 << 20;
+
+  // Allocations larger than this go to the system allocator. A slab must fit
+  // at least four of them. Up to this size, plus the 16 bytes header of an
+  // allocation, is left unused at the end of each slab.
+  size_t max_slab_allocation_size = 64 << 10;
+
+  // If true, slabs are mapped from the huge page pool (MAP_HUGETLB) while it
+  // has free pages, and otherwise aligned on 2MB and advised for transparent
+  // huge pages (MADV_HUGEPAGE). Linux only.
+  bool use_huge_pages = true;
+};
+
+// Generate a memory allocator tuned for cache blocks: allocations are rounded
+// up to size classes spaced by a quarter of a power of two and carved out of
+// large slabs, preferably backed by huge pages. A freed allocation is kept on
+// a free list of its size class, in the per-core shard of the allocator that
+// allocated it, for the next allocation of that class. Slabs are only
+// released when the allocator is destroyed.
+//
+// Used as the memory allocator of a block cache (see
+// LRUCacheOptions::memory_allocator), blocks replace the evicted ones in place
+// once the cache is full. This avoids the malloc overhead and the heap
+// fragmentation of millions of small blocks, and reduces TLB misses. The
+// memory used for the blocks is bounded by the capacity of the cache plus the
+// rounding, which is charged to the cache, plus the free allocations.
+extern Status NewSlabMemoryAllocator(
+    const SlabAllocatorOptions& options,
+    std::shared_ptr<MemoryAllocator>* memory_allocator);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -775,6 +775,15 @@ struct DBOptions {
   // Dynamically changeable through SetDBOptions() API.
   size_t compaction_readahead_size = 0;
 
+  // If true and compaction_readahead_size is non-zero, compaction input
+  // files are double-buffered: while compaction consumes one readahead
+  // chunk, the next one is read on the Env::Priority::USER thread pool.
+  // Background threads for that pool are added on DB open, up to the
+  // number of concurrent compactions.
+  //
+  // Default: false
+  bool async_compaction_readahead = false;
+
   // This is a maximum buffer size that is used by WinMmapReadableFile in
   // unbuffered disk I/O mode. We need to maintain an aligned buffer for
   // reads. We allow the buffer to grow until the specified value and then
@@ -1157,6 +1166,16 @@ struct DBOptions {
   //
   // Default: 1000000 (microseconds).
   uint64_t bgerror_resume_retry_interval = 1000000;
+
+  // Only used by secondary instances (see DB::OpenAsSecondary()). If
+  // non-zero, a background thread calls TryCatchUpWithPrimary() at this
+  // period, so that the secondary follows the primary without being polled.
+  // Each round only applies the MANIFEST and WAL records added since the
+  // previous one. See the "rocksdb.secondary-*" properties for how far
+  // behind the primary the secondary is.
+  //
+  // Default: 0 (microseconds, disabled)
+  uint64_t secondary_catch_up_period_micros = 0;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1387,6 +1406,12 @@ struct ReadOptions {
   // Default: std::numeric_limits<uint64_t>::max()
   uint64_t value_size_soft_limit;
 
+  // If not Env::IO_TOTAL, the file reads of this request are charged to
+  // DBOptions::rate_limiter at this priority, when its mode limits reads.
+  // Reads for iterator readahead are charged at Env::IO_USER in any case.
+  // Default: Env::IO_TOTAL
+  Env::IOPriority rate_limiter_priority;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -1623,7 +1648,11 @@ enum TraceFilterType : uint64_t {
   // Do not trace the get operations
   kTraceFilterGet = 0x1 << 0,
   // Do not trace the write operations
-  kTraceFilterWrite = 0x1 << 1
+  kTraceFilterWrite = 0x1 << 1,
+  // Do not trace the MultiGet operations
+  kTraceFilterMultiGet = 0x1 << 2,
+  // Do not trace the Next() calls of iterators
+  kTraceFilterIteratorNext = 0x1 << 3
 };
 
 // TraceOptions is used for StartTrace
@@ -1636,6 +1665,23 @@ struct TraceOptions {
   uint64_t sampling_frequency = 1;
   // Note: The filtering happens before sampling.
   uint64_t filter = kTraceFilterNone;
+  // If > 1, only the operations on one out of this many keys, picked by key
+  // hash, are traced, so that all the operations on a sampled key are
+  // captured. Write batches are traced with their entries on sampled keys
+  // only, and the Next() calls of an iterator are traced only if its last
+  // seek was.
+  uint64_t key_sampling_frequency = 1;
+  // If not empty, only the operations on the column families with these IDs
+  // are traced.
+  std::vector<uint32_t> column_family_ids;
+  // If > 0, each thread appends its traces to a lock-free ring buffer of this
+  // many bytes, from which a background thread writes them to the
+  // TraceWriter, instead of writing every trace synchronously under a
+  // DB-wide mutex. The traces that do not fit in the buffer of their thread
+  // are dropped and counted in the "rocksdb.trace-dropped-records" property.
+  // The traces of different threads may be written slightly out of
+  // timestamp order.
+  size_t buffer_size = 0;
 };
 
 // ImportColumnFamilyOptions is used by ImportColumnFamily()
@@ -313,6 +313,20 @@ struct BlockBasedTableOptions {
   // Align data blocks on lesser of page size and block size
   bool block_align = false;
 
+  // If true, the memory of open table readers that is not in the block cache,
+  // mostly index and filter blocks when cache_index_and_filter_blocks is
+  // false, is charged to the block cache by inserting dummy entries, so that
+  // the block cache capacity bounds it too. If the block cache has
+  // strict_capacity_limit set and cannot fit it, opening the table fails
+  // with Status::MemoryLimit.
+  bool reserve_table_reader_memory = false;
+
+  // If true, the memory buffered to build the filter of a new table is
+  // charged to the block cache the same way until the filter is written. If
+  // the block cache has strict_capacity_limit set and cannot fit it, building
+  // the table fails with Status::MemoryLimit.
+  bool reserve_table_builder_memory = false;
+
   // This enum allows trading off increased index size for improved iterator
   // seek performance in some situations, particularly when block cache is
   // disabled (ReadOptions::fill_cache = false) and direct IO is
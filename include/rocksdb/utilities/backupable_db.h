@@ -128,6 +128,16 @@ struct BackupableDBOptions {
   // Default: 1
   int max_background_operations;
 
+  // If non-zero, a file of at least twice this size is split into chunks of
+  // this size that are copied concurrently by up to max_background_operations
+  // threads, so that a few large files do not leave the other threads idle.
+  // The checksum of the whole file is combined from the chunk checksums.
+  // Files that need a custom checksum (see file_checksum_gen_factory), or
+  // whose destination Env does not support NewRandomRWFile(), are still
+  // copied sequentially.
+  // Default: 0
+  uint64_t parallel_copy_chunk_size;
+
   // During backup user can get callback every time next
   // callback_trigger_interval_size bytes being copied.
   // Default: 4194304
@@ -215,6 +225,7 @@ struct BackupableDBOptions {
         restore_rate_limit(_restore_rate_limit),
         share_files_with_checksum(false),
         max_background_operations(_max_background_operations),
+        parallel_copy_chunk_size(0),
         callback_trigger_interval_size(_callback_trigger_interval_size),
         max_valid_backups_to_open(_max_valid_backups_to_open),
         share_files_with_checksum_naming(_share_files_with_checksum_naming),
@@ -249,8 +260,17 @@ struct RestoreOptions {
   // Default: false
   bool keep_log_files;
 
-  explicit RestoreOptions(bool _keep_log_files = false)
-      : keep_log_files(_keep_log_files) {}
+  // If true, a file that already exists in db_dir or wal_dir with the size
+  // and checksum recorded in the backup is kept instead of being copied
+  // again, so restoring over an older restore of the same DB only fetches
+  // the missing files. Other DB files in those directories are deleted as
+  // usual.
+  // Default: false
+  bool incremental;
+
+  explicit RestoreOptions(bool _keep_log_files = false,
+                          bool _incremental = false)
+      : keep_log_files(_keep_log_files), incremental(_incremental) {}
 };
 
 typedef uint32_t BackupID;
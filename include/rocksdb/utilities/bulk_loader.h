@@ -0,0 +1,80 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A BulkLoader turns a stream of key/values into table files that are built
+// in parallel and ingested into a column family at once.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class DB;
+class ColumnFamilyHandle;
+
+struct BulkLoaderOptions {
+  // Directory for the table files that are built and for spill files. It is
+  // created if missing. It should be on the same file system as the DB so
+  // that the built files can be moved into the DB instead of copied.
+  std::string work_dir;
+
+  // If true, keys must be added in ascending order. They are then streamed
+  // straight to the table builders without sorting or spill files, and an
+  // out-of-order key fails Add().
+  bool sorted_input = false;
+
+  // Amount of unsorted input buffered in memory. When exceeded, the buffer
+  // is sorted and written to a spill file in work_dir, to be merged with the
+  // other spill files by Finish(). Unused if sorted_input is true.
+  size_t max_buffer_size = 256 << 20;
+
+  // Target size of the key/value data put in each built table file, before
+  // compression.
+  uint64_t target_file_size = 256 << 20;
+
+  // Number of table files built concurrently.
+  int num_threads = 4;
+
+  // Options for the final ingestion. The built files are moved into the DB by
+  // default.
+  IngestExternalFileOptions ingest_options;
+
+  BulkLoaderOptions() { ingest_options.move_files = true; }
+};
+
+class BulkLoader {
+ public:
+  // Creates a BulkLoader for a column family of db. The table files are built
+  // with the column family's current options.
+  static Status Create(DB* db, ColumnFamilyHandle* column_family,
+                       const BulkLoaderOptions& options,
+                       std::unique_ptr<BulkLoader>* loader);
+
+  virtual ~BulkLoader() {}
+
+  // Adds a key/value. If the same key is added more than once, the value
+  // added last is loaded.
+  virtual Status Add(const Slice& key, const Slice& value) = 0;
+
+  // Sorts and merges the input, waits for all table files to be built and
+  // ingests them with a single IngestExternalFile() call, so that they are
+  // added in one VersionEdit. The files do not overlap each other, so they
+  // are placed in the bottommost level unless they overlap data already in
+  // the column family. No key can be added afterwards.
+  virtual Status Finish() = 0;
+
+  // Number of table files built so far.
+  virtual uint64_t num_files() const = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // !ROCKSDB_LITE
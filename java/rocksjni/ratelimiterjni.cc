@@ -81,7 +81,7 @@ void Java_org_rocksdb_RateLimiter_request(JNIEnv* /*env*/, jobject /*jobj*/,
                                           jlong handle, jlong jbytes) {
   reinterpret_cast<std::shared_ptr<ROCKSDB_NAMESPACE::RateLimiter>*>(handle)
       ->get()
-      ->Request(jbytes, ROCKSDB_NAMESPACE::Env::IO_TOTAL);
+      ->Request(jbytes, ROCKSDB_NAMESPACE::Env::IO_USER);
 }
 
 /*
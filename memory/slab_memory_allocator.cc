@@ -0,0 +1,272 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memory/slab_memory_allocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+#ifdef ROCKSDB_PLATFORM_POSIX
+#include <sys/mman.h>
+#endif
+
+namespace ROCKSDB_NAMESPACE {
+
+const size_t SlabMemoryAllocator::kHeaderSize;
+const size_t SlabMemoryAllocator::kMinAllocationSize;
+
+namespace {
+
+// Precedes every allocation.
+struct AllocationHeader {
+  // Index in size_classes_, or kLargeAllocation.
+  uint32_t size_class;
+  // Index of the shard that allocated it.
+  uint32_t shard;
+  // Requested size of a large allocation.
+  uint64_t size;
+};
+static_assert(sizeof(AllocationHeader) == SlabMemoryAllocator::kHeaderSize,
+              "AllocationHeader does not match kHeaderSize");
+
+const uint32_t kLargeAllocation = UINT32_MAX;
+
+// Slabs mapped without MAP_HUGETLB are aligned to this size, so that they can
+// be backed by transparent huge pages.
+const size_t kTransparentHugePageSize = 2 << 20;
+
+AllocationHeader* GetHeader(void* p) {
+  return reinterpret_cast<AllocationHeader*>(static_cast<char*>(p) -
+                                             SlabMemoryAllocator::kHeaderSize);
+}
+
+}  // namespace
+
+SlabMemoryAllocator::SlabMemoryAllocator(const SlabAllocatorOptions& options)
+    : options_(options) {
+  // Four size classes per power of two, so that at most a fifth of an
+  // allocation is wasted on rounding.
+  size_t max_size = ((options_.max_slab_allocation_size + kHeaderSize - 1) |
+                     (kHeaderSize - 1)) +
+                    1;
+  for (size_t base = kMinAllocationSize;
+       size_classes_.empty() || size_classes_.back() < max_size; base *= 2) {
+    for (size_t i = 0; i < 4; i++) {
+      size_t size_class = std::min(base + i * base / 4, max_size);
+      if (size_classes_.empty() || size_class > size_classes_.back()) {
+        size_classes_.push_back(size_class);
+      }
+    }
+  }
+  for (size_t i = 0; i < shards_.Size(); i++) {
+    shards_.AccessAtCore(i)->free_lists.resize(size_classes_.size(), nullptr);
+  }
+}
+
+SlabMemoryAllocator::~SlabMemoryAllocator() {
+  for (size_t i = 0; i < shards_.Size(); i++) {
+    Shard* shard = shards_.AccessAtCore(i);
+    for (char* slab : shard->slabs) {
+      FreeSlab(slab);
+    }
+  }
+}
+
+size_t SlabMemoryAllocator::SizeClassFor(size_t total_size) const {
+  return static_cast<size_t>(
+      std::lower_bound(size_classes_.begin(), size_classes_.end(),
+                       total_size) -
+      size_classes_.begin());
+}
+
+void* SlabMemoryAllocator::Allocate(size_t size) {
+  size_t total_size = size + kHeaderSize;
+  size_t size_class = SizeClassFor(total_size);
+  auto shard_and_index = shards_.AccessElementAndIndex();
+  Shard* shard = shard_and_index.first;
+  char* mem;
+  if (size_class == size_classes_.size()) {
+    mem = new char[total_size];
+    std::lock_guard<SpinMutex> lock(shard->mutex);
+    shard->total_memory += total_size;
+    shard->allocated_memory += size;
+  } else {
+    size_t class_size = size_classes_[size_class];
+    std::lock_guard<SpinMutex> lock(shard->mutex);
+    void* free_allocation = shard->free_lists[size_class];
+    if (free_allocation != nullptr) {
+      shard->free_lists[size_class] = *static_cast<void**>(free_allocation);
+      mem = static_cast<char*>(free_allocation);
+    } else {
+      // The rest of the current slab is wasted if it is too small.
+      if (shard->slab_free_size < class_size && !AddSlab(shard)) {
+        throw std::bad_alloc();
+      }
+      mem = shard->slab_free;
+      shard->slab_free += class_size;
+      shard->slab_free_size -= class_size;
+    }
+    shard->allocated_memory += class_size - kHeaderSize;
+  }
+  AllocationHeader* header = reinterpret_cast<AllocationHeader*>(mem);
+  header->size_class = size_class == size_classes_.size()
+                           ? kLargeAllocation
+                           : static_cast<uint32_t>(size_class);
+  header->shard = static_cast<uint32_t>(shard_and_index.second);
+  header->size = size;
+  return mem + kHeaderSize;
+}
+
+void SlabMemoryAllocator::Deallocate(void* p) {
+  AllocationHeader* header = GetHeader(p);
+  Shard* shard = shards_.AccessAtCore(header->shard);
+  if (header->size_class == kLargeAllocation) {
+    size_t size = static_cast<size_t>(header->size);
+    {
+      std::lock_guard<SpinMutex> lock(shard->mutex);
+      shard->total_memory -= size + kHeaderSize;
+      shard->allocated_memory -= size;
+    }
+    delete[] reinterpret_cast<char*>(header);
+    return;
+  }
+  uint32_t size_class = header->size_class;
+  assert(size_class < size_classes_.size());
+  std::lock_guard<SpinMutex> lock(shard->mutex);
+  *reinterpret_cast<void**>(header) = shard->free_lists[size_class];
+  shard->free_lists[size_class] = header;
+  shard->allocated_memory -= size_classes_[size_class] - kHeaderSize;
+}
+
+size_t SlabMemoryAllocator::UsableSize(void* p, size_t allocation_size) const {
+  AllocationHeader* header = GetHeader(p);
+  if (header->size_class == kLargeAllocation) {
+    return allocation_size;
+  }
+  return size_classes_[header->size_class] - kHeaderSize;
+}
+
+bool SlabMemoryAllocator::AddSlab(Shard* shard) {
+  const size_t slab_size = options_.slab_size;
+  char* slab = nullptr;
+  bool is_huge_page = false;
+#ifdef ROCKSDB_PLATFORM_POSIX
+#ifdef MAP_HUGETLB
+  if (options_.use_huge_pages) {
+    void* addr = mmap(nullptr, slab_size, (PROT_READ | PROT_WRITE),
+                      (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB), -1, 0);
+    if (addr != MAP_FAILED) {
+      slab = static_cast<char*>(addr);
+      is_huge_page = true;
+    }
+  }
+#endif  // MAP_HUGETLB
+  if (slab == nullptr) {
+    // Fall back to regular pages, aligned for transparent huge pages.
+    size_t alignment = options_.use_huge_pages ? kTransparentHugePageSize : 0;
+    void* addr = mmap(nullptr, slab_size + alignment, (PROT_READ | PROT_WRITE),
+                      (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+    if (addr == MAP_FAILED) {
+      return false;
+    }
+    char* begin = static_cast<char*>(addr);
+    if (alignment > 0) {
+      uintptr_t misalignment =
+          reinterpret_cast<uintptr_t>(begin) & (alignment - 1);
+      slab = begin + (misalignment == 0 ? 0 : alignment - misalignment);
+      if (slab > begin) {
+        munmap(begin, static_cast<size_t>(slab - begin));
+      }
+      char* end = begin + slab_size + alignment;
+      if (end > slab + slab_size) {
+        munmap(slab + slab_size, static_cast<size_t>(end - slab - slab_size));
+      }
+#ifdef MADV_HUGEPAGE
+      madvise(slab, slab_size, MADV_HUGEPAGE);
+#endif
+    } else {
+      slab = begin;
+    }
+  }
+#else
+  slab = new char[slab_size];
+#endif  // ROCKSDB_PLATFORM_POSIX
+  shard->slabs.push_back(slab);
+  shard->slab_free = slab;
+  shard->slab_free_size = slab_size;
+  shard->total_memory += slab_size;
+  if (is_huge_page) {
+    shard->huge_page_memory += slab_size;
+  }
+  return true;
+}
+
+void SlabMemoryAllocator::FreeSlab(char* slab) const {
+#ifdef ROCKSDB_PLATFORM_POSIX
+  munmap(slab, options_.slab_size);
+#else
+  delete[] slab;
+#endif
+}
+
+size_t SlabMemoryAllocator::GetTotalMemory() const {
+  size_t total = 0;
+  for (size_t i = 0; i < shards_.Size(); i++) {
+    Shard* shard = shards_.AccessAtCore(i);
+    std::lock_guard<SpinMutex> lock(shard->mutex);
+    total += shard->total_memory;
+  }
+  return total;
+}
+
+size_t SlabMemoryAllocator::GetAllocatedMemory() const {
+  size_t total = 0;
+  for (size_t i = 0; i < shards_.Size(); i++) {
+    Shard* shard = shards_.AccessAtCore(i);
+    std::lock_guard<SpinMutex> lock(shard->mutex);
+    total += shard->allocated_memory;
+  }
+  return total;
+}
+
+size_t SlabMemoryAllocator::GetHugePageMemory() const {
+  size_t total = 0;
+  for (size_t i = 0; i < shards_.Size(); i++) {
+    Shard* shard = shards_.AccessAtCore(i);
+    std::lock_guard<SpinMutex> lock(shard->mutex);
+    total += shard->huge_page_memory;
+  }
+  return total;
+}
+
+Status NewSlabMemoryAllocator(
+    const SlabAllocatorOptions& options,
+    std::shared_ptr<MemoryAllocator>* memory_allocator) {
+  if (memory_allocator == nullptr) {
+    return Status::InvalidArgument("memory_allocator must be non-null.");
+  }
+  if (options.max_slab_allocation_size == 0) {
+    return Status::InvalidArgument(
+        "max_slab_allocation_size must be positive.");
+  }
+  if (options.slab_size <
+      4 * (options.max_slab_allocation_size +
+           SlabMemoryAllocator::kHeaderSize)) {
+    return Status::InvalidArgument(
+        "slab_size must fit at least four allocations of "
+        "max_slab_allocation_size.");
+  }
+#ifdef ROCKSDB_PLATFORM_POSIX
+  if (options.slab_size % port::kPageSize != 0) {
+    return Status::InvalidArgument(
+        "slab_size must be a multiple of the page size.");
+  }
+#endif  // ROCKSDB_PLATFORM_POSIX
+  memory_allocator->reset(new SlabMemoryAllocator(options));
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
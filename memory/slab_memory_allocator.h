@@ -0,0 +1,91 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/memory_allocator.h"
+#include "util/core_local.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A MemoryAllocator for cache blocks that carves allocations of up to
+// max_slab_allocation_size bytes out of slab_size slabs, preferably backed
+// by huge pages, and rounds them up to size classes spaced by a quarter of a
+// power of two. A freed allocation goes to a free list of its size class in
+// the core-local shard that allocated it, for the next allocation of that
+// class in the shard. Slabs are only unmapped when the allocator is
+// destroyed: after the cache fills up, blocks are allocated in place of the
+// evicted ones, without calling malloc and with few TLB entries. Larger
+// allocations go to the system allocator.
+//
+// Every allocation is preceded by a kHeaderSize bytes header recording its
+// size class and shard.
+class SlabMemoryAllocator : public MemoryAllocator {
+ public:
+  static const size_t kHeaderSize = 16;
+  static const size_t kMinAllocationSize = 64;
+
+  explicit SlabMemoryAllocator(const SlabAllocatorOptions& options);
+  ~SlabMemoryAllocator() override;
+
+  // No copying allowed
+  SlabMemoryAllocator(const SlabMemoryAllocator&) = delete;
+  SlabMemoryAllocator& operator=(const SlabMemoryAllocator&) = delete;
+
+  const char* Name() const override { return "SlabMemoryAllocator"; }
+  void* Allocate(size_t size) override;
+  void Deallocate(void* p) override;
+  size_t UsableSize(void* p, size_t allocation_size) const override;
+
+  // Returns the memory of the slabs and of the larger allocations.
+  size_t GetTotalMemory() const;
+
+  // Returns the usable size of the live allocations.
+  size_t GetAllocatedMemory() const;
+
+  // Returns the memory of the slabs backed by explicit (MAP_HUGETLB) huge
+  // pages.
+  size_t GetHugePageMemory() const;
+
+  // Returns the sizes of the size classes, headers included.
+  const std::vector<size_t>& GetSizeClasses() const { return size_classes_; }
+
+ private:
+  struct Shard {
+    SpinMutex mutex;
+    // The unused end of the current slab.
+    char* slab_free = nullptr;
+    size_t slab_free_size = 0;
+    // The first free allocation of each size class, linked through their
+    // first bytes.
+    std::vector<void*> free_lists;
+    // The slabs, to unmap them.
+    std::vector<char*> slabs;
+    size_t total_memory = 0;
+    size_t allocated_memory = 0;
+    size_t huge_page_memory = 0;
+  };
+
+  // Returns the index of the smallest size class that fits total_size, or
+  // size_classes_.size() if none does.
+  size_t SizeClassFor(size_t total_size) const;
+
+  // Maps a new slab into the shard. Returns false if out of memory.
+  bool AddSlab(Shard* shard);
+
+  void FreeSlab(char* slab) const;
+
+  const SlabAllocatorOptions options_;
+  std::vector<size_t> size_classes_;
+  CoreLocalArray<Shard> shards_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
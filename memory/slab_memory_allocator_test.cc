@@ -0,0 +1,198 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memory/slab_memory_allocator.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/db.h"
+#include "rocksdb/table.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class SlabMemoryAllocatorTest : public testing::Test {
+ public:
+  SlabMemoryAllocatorTest() {
+    options_.slab_size = 1 << 20;
+    options_.max_slab_allocation_size = 32 << 10;
+    options_.use_huge_pages = false;
+  }
+
+  SlabMemoryAllocator* NewAllocator() {
+    EXPECT_OK(NewSlabMemoryAllocator(options_, &allocator_));
+    return static_cast<SlabMemoryAllocator*>(allocator_.get());
+  }
+
+  SlabAllocatorOptions options_;
+  std::shared_ptr<MemoryAllocator> allocator_;
+};
+
+TEST_F(SlabMemoryAllocatorTest, InvalidOptions) {
+  std::shared_ptr<MemoryAllocator> allocator;
+  SlabAllocatorOptions options;
+  options.max_slab_allocation_size = 0;
+  ASSERT_TRUE(NewSlabMemoryAllocator(options, &allocator).IsInvalidArgument());
+  options.max_slab_allocation_size = 1 << 20;
+  options.slab_size = 2 << 20;
+  ASSERT_TRUE(NewSlabMemoryAllocator(options, &allocator).IsInvalidArgument());
+  options.slab_size = (4 << 20) + 1;
+  ASSERT_TRUE(NewSlabMemoryAllocator(options, &allocator).IsInvalidArgument());
+  ASSERT_EQ(nullptr, allocator);
+}
+
+TEST_F(SlabMemoryAllocatorTest, SizeClasses) {
+  SlabMemoryAllocator* allocator = NewAllocator();
+  const std::vector<size_t>& size_classes = allocator->GetSizeClasses();
+  ASSERT_EQ(SlabMemoryAllocator::kMinAllocationSize, size_classes.front());
+  ASSERT_EQ((32 << 10) + SlabMemoryAllocator::kHeaderSize,
+            size_classes.back());
+  for (size_t i = 1; i < size_classes.size(); i++) {
+    ASSERT_GT(size_classes[i], size_classes[i - 1]);
+    ASSERT_LE(size_classes[i], size_classes[i - 1] * 5 / 4);
+    ASSERT_EQ(0U, size_classes[i] % SlabMemoryAllocator::kHeaderSize);
+  }
+
+  for (size_t size : {1, 48, 49, 4000, 4096, 4200, 32 << 10}) {
+    void* p = allocator->Allocate(size);
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(p) % 16);
+    size_t usable_size = allocator->UsableSize(p, size);
+    ASSERT_GE(usable_size, size);
+    ASSERT_LE(usable_size + SlabMemoryAllocator::kHeaderSize,
+              std::max((size + SlabMemoryAllocator::kHeaderSize) * 5 / 4,
+                       SlabMemoryAllocator::kMinAllocationSize));
+    ASSERT_EQ(usable_size, allocator->GetAllocatedMemory());
+    memset(p, 0xff, usable_size);
+    allocator->Deallocate(p);
+    ASSERT_EQ(0U, allocator->GetAllocatedMemory());
+  }
+  // Slabs are kept after the allocations are freed.
+  ASSERT_GE(allocator->GetTotalMemory(), options_.slab_size);
+  ASSERT_EQ(0U, allocator->GetTotalMemory() % options_.slab_size);
+}
+
+TEST_F(SlabMemoryAllocatorTest, LargeAllocation) {
+  SlabMemoryAllocator* allocator = NewAllocator();
+  size_t size = 100 << 10;
+  void* p = allocator->Allocate(size);
+  ASSERT_EQ(size, allocator->UsableSize(p, size));
+  ASSERT_EQ(size, allocator->GetAllocatedMemory());
+  ASSERT_EQ(size + SlabMemoryAllocator::kHeaderSize,
+            allocator->GetTotalMemory());
+  memset(p, 0xff, size);
+  allocator->Deallocate(p);
+  ASSERT_EQ(0U, allocator->GetAllocatedMemory());
+  ASSERT_EQ(0U, allocator->GetTotalMemory());
+}
+
+TEST_F(SlabMemoryAllocatorTest, ReuseFreedAllocations) {
+  SlabMemoryAllocator* allocator = NewAllocator();
+  Random rnd(301);
+  std::vector<void*> allocations;
+  size_t first_round_memory = 0;
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 1000; i++) {
+      allocations.push_back(allocator->Allocate(2048 + rnd.Uniform(4096)));
+    }
+    for (void* p : allocations) {
+      allocator->Deallocate(p);
+    }
+    allocations.clear();
+    if (round == 0) {
+      first_round_memory = allocator->GetTotalMemory();
+    }
+  }
+  ASSERT_EQ(0U, allocator->GetAllocatedMemory());
+  // Rounds after the first mostly reuse the freed allocations, unless the
+  // thread moves to other cores.
+  ASSERT_LT(allocator->GetTotalMemory(), 10 * first_round_memory);
+}
+
+TEST_F(SlabMemoryAllocatorTest, MultiThreaded) {
+  SlabMemoryAllocator* allocator = NewAllocator();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([allocator, t]() {
+      Random rnd(t + 1);
+      std::vector<std::pair<char*, size_t>> allocations;
+      for (int i = 0; i < 10000; i++) {
+        if (allocations.size() < 100 && rnd.OneIn(2)) {
+          size_t size = 1 + rnd.Uniform(40 << 10);
+          char* p = static_cast<char*>(allocator->Allocate(size));
+          memset(p, static_cast<char>(t), size);
+          allocations.emplace_back(p, size);
+        } else if (!allocations.empty()) {
+          size_t j = rnd.Uniform(static_cast<int>(allocations.size()));
+          char* p = allocations[j].first;
+          size_t size = allocations[j].second;
+          for (size_t k = 0; k < size; k++) {
+            ASSERT_EQ(static_cast<char>(t), p[k]);
+          }
+          allocator->Deallocate(p);
+          allocations[j] = allocations.back();
+          allocations.pop_back();
+        }
+      }
+      for (auto& allocation : allocations) {
+        allocator->Deallocate(allocation.first);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(0U, allocator->GetAllocatedMemory());
+}
+
+TEST_F(SlabMemoryAllocatorTest, DatabaseBlockCache) {
+  SlabMemoryAllocator* allocator = NewAllocator();
+  LRUCacheOptions cache_options(1 << 20, 0 /*num_shard_bits*/,
+                                false /*strict_capacity_limit*/,
+                                0.0 /*high_pri_pool_ratio*/, allocator_);
+  std::shared_ptr<Cache> cache = NewLRUCache(cache_options);
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = cache;
+
+  Options options;
+  options.create_if_missing = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  std::string dbname = test::PerThreadDBPath("slab_memory_allocator_test");
+  ASSERT_OK(DestroyDB(dbname, options));
+
+  DB* db = nullptr;
+  ASSERT_OK(DB::Open(options, dbname, &db));
+  const int kNumKeys = 2000;
+  std::string value(100, 'v');
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), std::to_string(i), value));
+  }
+  ASSERT_OK(db->Flush(FlushOptions()));
+
+  std::string result;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(db->Get(ReadOptions(), std::to_string(i), &result));
+    ASSERT_EQ(value, result);
+  }
+  // The data blocks are cached in allocations from the slabs.
+  ASSERT_GT(cache->GetUsage(), kNumKeys * value.size() / 2);
+  ASSERT_GE(allocator->GetAllocatedMemory(), kNumKeys * value.size() / 2);
+
+  ASSERT_OK(db->Close());
+  delete db;
+  ASSERT_OK(DestroyDB(dbname, options));
+  cache->EraseUnRefEntries();
+  ASSERT_EQ(0U, allocator->GetAllocatedMemory());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
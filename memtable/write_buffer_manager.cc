@@ -9,6 +9,7 @@
 
 #include "rocksdb/write_buffer_manager.h"
 #include <mutex>
+#include "cache/cache_entry_roles.h"
 #include "util/coding.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -91,8 +92,9 @@ void WriteBufferManager::ReserveMemWithCache(size_t mem) {
     // Expand size by at least 256KB.
     // Add a dummy record to the cache
     Cache::Handle* handle = nullptr;
-    cache_rep_->cache_->Insert(cache_rep_->GetNextCacheKey(), nullptr,
-                               kSizeDummyEntry, nullptr, &handle);
+    cache_rep_->cache_->Insert(
+        cache_rep_->GetNextCacheKey(), nullptr, kSizeDummyEntry,
+        GetNoopDeleterForRole(CacheEntryRole::kWriteBuffer), &handle);
     // We keep the handle even if insertion fails and a null handle is
     // returned, so that when memory shrinks, we don't release extra
     // entries from cache.
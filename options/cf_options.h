@@ -96,6 +96,8 @@ struct ImmutableCFOptions {
 
   bool new_table_reader_for_compaction_inputs;
 
+  bool async_compaction_readahead;
+
   int num_levels;
 
   bool optimize_filters_for_hits;
@@ -125,6 +125,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, new_table_reader_for_compaction_inputs),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone, 0}},
+        {"async_compaction_readahead",
+         {offsetof(struct DBOptions, async_compaction_readahead),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
         {"compaction_readahead_size",
          {offsetof(struct DBOptions, compaction_readahead_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -363,6 +367,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, bgerror_resume_retry_interval),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone, 0}},
+        {"secondary_catch_up_period_micros",
+         {offsetof(struct DBOptions, secondary_catch_up_period_micros),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
         // The following properties were handled as special cases in ParseOption
         // This means that the properties could be read from the options file
         // but never written to the file or compared to each other.
@@ -440,6 +448,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       access_hint_on_compaction_start(options.access_hint_on_compaction_start),
       new_table_reader_for_compaction_inputs(
           options.new_table_reader_for_compaction_inputs),
+      async_compaction_readahead(options.async_compaction_readahead),
       random_access_max_buffer_size(options.random_access_max_buffer_size),
       use_adaptive_mutex(options.use_adaptive_mutex),
       listeners(options.listeners),
@@ -475,7 +484,9 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       file_checksum_gen_factory(options.file_checksum_gen_factory),
       best_efforts_recovery(options.best_efforts_recovery),
       max_bgerror_resume_count(options.max_bgerror_resume_count),
-      bgerror_resume_retry_interval(options.bgerror_resume_retry_interval) {
+      bgerror_resume_retry_interval(options.bgerror_resume_retry_interval),
+      secondary_catch_up_period_micros(
+          options.secondary_catch_up_period_micros) {
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -558,6 +569,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    static_cast<int>(access_hint_on_compaction_start));
   ROCKS_LOG_HEADER(log, " Options.new_table_reader_for_compaction_inputs: %d",
                    new_table_reader_for_compaction_inputs);
+  ROCKS_LOG_HEADER(log, "             Options.async_compaction_readahead: %d",
+                   async_compaction_readahead);
   ROCKS_LOG_HEADER(
       log, "          Options.random_access_max_buffer_size: %" ROCKSDB_PRIszt,
       random_access_max_buffer_size);
@@ -631,6 +644,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(log,
                    "           Options.bgerror_resume_retry_interval: %" PRIu64,
                    bgerror_resume_retry_interval);
+  ROCKS_LOG_HEADER(log,
+                   "        Options.secondary_catch_up_period_micros: %" PRIu64,
+                   secondary_catch_up_period_micros);
 }
 
 MutableDBOptions::MutableDBOptions()
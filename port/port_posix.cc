@@ -23,6 +23,9 @@
 #include <sys/time.h>
 #include <unistd.h>
 #include <cstdlib>
+#ifdef NUMA
+#include <numa.h>
+#endif
 #include "logging/logging.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -176,6 +179,53 @@ int PhysicalCoreID() {
 #endif
 }
 
+namespace {
+#ifdef NUMA
+bool IsNumaAvailable() {
+  // numa_available() makes a system call, so only do it once.
+  static const bool available = numa_available() >= 0;
+  return available;
+}
+#endif  // NUMA
+}  // namespace
+
+int GetNumaNodeCount() {
+#ifdef NUMA
+  if (IsNumaAvailable()) {
+    return numa_max_node() + 1;
+  }
+#endif  // NUMA
+  return 1;
+}
+
+int GetCurrentNumaNode() {
+#ifdef NUMA
+  if (IsNumaAvailable()) {
+    int cpu = sched_getcpu();
+    if (cpu >= 0) {
+      int node = numa_node_of_cpu(cpu);
+      if (node >= 0) {
+        return node;
+      }
+    }
+  }
+#endif  // NUMA
+  return 0;
+}
+
+bool BindCurrentThreadToNumaNode(int node) {
+#ifdef NUMA
+  if (IsNumaAvailable() && node >= 0 && node <= numa_max_node() &&
+      numa_run_on_node(node) == 0) {
+    numa_set_preferred(node);
+    return true;
+  }
+#else
+  (void)node;
+#endif  // NUMA
+  return false;
+}
+
 void InitOnce(OnceType* once, void (*initializer)()) {
   PthreadCall("once", pthread_once(once, initializer));
 }
@@ -177,6 +177,18 @@ static inline void AsmVolatilePause() {
 // Returns -1 if not available on this platform
 extern int PhysicalCoreID();
 
+// Returns the number of NUMA nodes, or 1 if not built with NUMA support or
+// the kernel does not support NUMA.
+extern int GetNumaNodeCount();
+
+// Returns the NUMA node of the CPU the calling thread runs on, or 0 if
+// unknown.
+extern int GetCurrentNumaNode();
+
+// Runs the calling thread on the CPUs of the NUMA node only, and allocates its
+// memory from that node when possible. Returns false if not supported.
+extern bool BindCurrentThreadToNumaNode(int node);
+
 typedef pthread_once_t OnceType;
 #define LEVELDB_ONCE_INIT PTHREAD_ONCE_INIT
 extern void InitOnce(OnceType* once, void (*initializer)());
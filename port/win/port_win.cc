@@ -124,6 +124,12 @@ void CondVar::SignalAll() { cv_.notify_all(); }
 
 int PhysicalCoreID() { return GetCurrentProcessorNumber(); }
 
+int GetNumaNodeCount() { return 1; }
+
+int GetCurrentNumaNode() { return 0; }
+
+bool BindCurrentThreadToNumaNode(int /*node*/) { return false; }
+
 void InitOnce(OnceType* once, void (*initializer)()) {
   std::call_once(once->flag_, initializer);
 }
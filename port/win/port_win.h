@@ -291,6 +291,12 @@ static inline void AsmVolatilePause() {
 
 extern int PhysicalCoreID();
 
+extern int GetNumaNodeCount();
+
+extern int GetCurrentNumaNode();
+
+extern bool BindCurrentThreadToNumaNode(int node);
+
 // For Thread Local Storage abstraction
 typedef DWORD pthread_key_t;
 
@@ -1,8 +1,12 @@
 # These are the sources from which librocksdb.a is built:
 LIB_SOURCES =                                                   \
   cache/cache.cc                                                \
+  cache/cache_entry_roles.cc                                    \
+  cache/cache_reservation_manager.cc                            \
   cache/clock_cache.cc                                          \
+  cache/frequency_sketch.cc                                     \
   cache/lru_cache.cc                                            \
+  cache/miss_ratio_curve.cc                                     \
   cache/sharded_cache.cc                                        \
   db/arena_wrapped_db_iter.cc                                   \
   db/blob/blob_file_addition.cc                                 \
@@ -100,6 +104,7 @@ LIB_SOURCES =                                                   \
   memory/concurrent_arena.cc                                    \
   memory/jemalloc_nodump_allocator.cc                           \
   memory/memkind_kmem_allocator.cc                              \
+  memory/slab_memory_allocator.cc                               \
   memtable/alloc_tracker.cc                                     \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
@@ -207,6 +212,7 @@ LIB_SOURCES =                                                   \
   utilities/blob_db/blob_db_impl.cc                             \
   utilities/blob_db/blob_db_impl_filesnapshot.cc                \
   utilities/blob_db/blob_file.cc                                \
+  utilities/bulk_load/bulk_loader.cc                            \
   utilities/cassandra/cassandra_compaction_filter.cc            \
   utilities/cassandra/format.cc                                 \
   utilities/cassandra/merge_operator.cc                         \
@@ -428,6 +434,7 @@ TEST_MAIN_SOURCES =                                                     \
   logging/event_logger_test.cc                                          \
   memory/arena_test.cc                                                  \
   memory/memkind_kmem_allocator_test.cc                                 \
+  memory/slab_memory_allocator_test.cc                                  \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
@@ -481,6 +488,7 @@ TEST_MAIN_SOURCES =                                                     \
   util/work_queue_test.cc                                               \
   utilities/backupable/backupable_db_test.cc                            \
   utilities/blob_db/blob_db_test.cc                                     \
+  utilities/bulk_load/bulk_loader_test.cc                               \
   utilities/cassandra/cassandra_format_test.cc                          \
   utilities/cassandra/cassandra_functional_test.cc                      \
   utilities/cassandra/cassandra_row_merge_test.cc                       \
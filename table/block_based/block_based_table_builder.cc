@@ -19,6 +19,7 @@
 #include <unordered_map>
 #include <utility>
 
+#include "cache/cache_reservation_manager.h"
 #include "db/dbformat.h"
 #include "index_builder.h"
 #include "port/lang.h"
@@ -61,6 +62,11 @@ typedef BlockBasedTableOptions::IndexType IndexType;
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
 
+// Memory buffered per key to build a filter, charged to the block cache if
+// reserve_table_builder_memory is set: the filter builders keep a hash of up
+// to 8 bytes per key until the filter is finished.
+const size_t kFilterConstructionBytesPerKey = sizeof(uint64_t);
+
 // Create a filter block builder based on its type.
 FilterBlockBuilder* CreateFilterBlockBuilder(
     const ImmutableCFOptions& /*opt*/, const MutableCFOptions& mopt,
@@ -313,6 +319,11 @@ struct BlockBasedTableBuilder::Rep {
 
   const bool use_delta_encoding_for_index_values;
   std::unique_ptr<FilterBlockBuilder> filter_builder;
+  // Charges the memory buffered by filter_builder to the block cache, if
+  // reserve_table_builder_memory is set. Only accessed by the thread adding
+  // keys to filter_builder.
+  std::unique_ptr<CacheReservationManager> filter_cache_res_mgr;
+  size_t num_filter_keys_added = 0;
   char compressed_cache_key_prefix[BlockBasedTable::kMaxCacheKeyPrefixSize];
   size_t compressed_cache_key_prefix_size;
 
@@ -368,6 +379,14 @@ struct BlockBasedTableBuilder::Rep {
     }
   }
 
+  // Charges the keys added to filter_builder so far to the block cache.
+  void UpdateFilterCacheReservation() {
+    if (filter_cache_res_mgr != nullptr) {
+      SetStatus(filter_cache_res_mgr->UpdateCacheReservation(
+          num_filter_keys_added * kFilterConstructionBytesPerKey));
+    }
+  }
+
   // Never erase an existing status that is not OK.
   void SetStatus(Status s) {
     if (!s.ok()) {
@@ -476,6 +495,12 @@ struct BlockBasedTableBuilder::Rep {
       filter_builder.reset(CreateFilterBlockBuilder(
           ioptions, moptions, context, use_delta_encoding_for_index_values,
           p_index_builder_));
+      if (filter_builder != nullptr &&
+          table_options.reserve_table_builder_memory &&
+          table_options.block_cache != nullptr) {
+        filter_cache_res_mgr.reset(new CacheReservationManager(
+            table_options.block_cache, CacheEntryRole::kFilterConstruction));
+      }
     }
 
     for (auto& collector_factories : *int_tbl_prop_collector_factories) {
@@ -763,6 +788,7 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
           size_t ts_sz =
               r->internal_comparator.user_comparator()->timestamp_size();
           r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
+          r->num_filter_keys_added++;
         }
       }
     }
@@ -908,6 +934,7 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   if (is_data_block) {
     if (r->filter_builder != nullptr) {
       r->filter_builder->StartBlock(r->get_offset());
+      r->UpdateFilterCacheReservation();
     }
     r->props.data_size = r->get_offset();
     ++r->props.num_data_blocks;
@@ -1184,6 +1211,7 @@ void BlockBasedTableBuilder::BGWorkWriteRawBlock() {
         size_t ts_sz =
             r->internal_comparator.user_comparator()->timestamp_size();
         r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
+        r->num_filter_keys_added++;
       }
       r->index_builder->OnKeyAdded(key);
     }
@@ -1203,6 +1231,7 @@ void BlockBasedTableBuilder::BGWorkWriteRawBlock() {
 
     if (r->filter_builder != nullptr) {
       r->filter_builder->StartBlock(r->get_offset());
+      r->UpdateFilterCacheReservation();
     }
     r->props.data_size = r->get_offset();
     ++r->props.num_data_blocks;
@@ -1290,6 +1319,10 @@ void BlockBasedTableBuilder::WriteFilterBlock(
       WriteRawBlock(filter_content, kNoCompression, &filter_block_handle);
     }
   }
+  if (rep_->filter_cache_res_mgr != nullptr) {
+    // The filter is written, so its buffers are no longer charged.
+    rep_->SetStatus(rep_->filter_cache_res_mgr->UpdateCacheReservation(0));
+  }
   if (ok() && !empty_filter_block) {
     // Add mapping from "<filter_block_prefix>.Name" to location
     // of filter data.
@@ -1610,6 +1643,7 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
           size_t ts_sz =
               r->internal_comparator.user_comparator()->timestamp_size();
           r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
+          r->num_filter_keys_added++;
         }
         r->index_builder->OnKeyAdded(key);
       }
@@ -15,6 +15,7 @@
 #include <memory>
 #include <string>
 
+#include "cache/cache_reservation_manager.h"
 #include "options/options_helper.h"
 #include "options/options_parser.h"
 #include "port/port.h"
@@ -341,6 +342,15 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, block_align),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone, 0}},
+        {"reserve_table_reader_memory",
+         {offsetof(struct BlockBasedTableOptions, reserve_table_reader_memory),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
+        {"reserve_table_builder_memory",
+         {offsetof(struct BlockBasedTableOptions,
+                   reserve_table_builder_memory),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone, 0}},
         {"pin_top_level_index_and_filter",
          {offsetof(struct BlockBasedTableOptions,
                    pin_top_level_index_and_filter),
@@ -409,6 +419,11 @@ BlockBasedTableFactory::BlockBasedTableFactory(
     // We do not support partitioned filters without partitioning indexes
     table_options_.partition_filters = false;
   }
+  if (table_options_.reserve_table_reader_memory &&
+      table_options_.block_cache != nullptr) {
+    table_reader_cache_res_mgr_ = std::make_shared<CacheReservationManager>(
+        table_options_.block_cache, CacheEntryRole::kBlockBasedTableReader);
+  }
 }
 
 Status BlockBasedTableFactory::NewTableReader(
@@ -416,7 +431,7 @@ Status BlockBasedTableFactory::NewTableReader(
     std::unique_ptr<RandomAccessFileReader>&& file, uint64_t file_size,
     std::unique_ptr<TableReader>* table_reader,
     bool prefetch_index_and_filter_in_cache) const {
-  return BlockBasedTable::Open(
+  Status s = BlockBasedTable::Open(
       ro, table_reader_options.ioptions, table_reader_options.env_options,
       table_options_, table_reader_options.internal_comparator, std::move(file),
       file_size, table_reader, table_reader_options.prefix_extractor,
@@ -426,6 +441,16 @@ Status BlockBasedTableFactory::NewTableReader(
       table_reader_options.force_direct_prefetch, &tail_prefetch_stats_,
       table_reader_options.block_cache_tracer,
       table_reader_options.max_file_size_for_l0_meta_pin);
+  if (s.ok() && table_reader_cache_res_mgr_ != nullptr) {
+    auto* table = static_cast<BlockBasedTable*>(table_reader->get());
+    s = table_reader_cache_res_mgr_->MakeCacheReservation(
+        table->ApproximateMemoryUsage(),
+        &table->get_rep()->table_reader_cache_res_handle);
+    if (!s.ok()) {
+      table_reader->reset();
+    }
+  }
+  return s;
 }
 
 TableBuilder* BlockBasedTableFactory::NewTableBuilder(
@@ -627,6 +652,12 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  block_align: %d\n",
            table_options_.block_align);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  reserve_table_reader_memory: %d\n",
+           table_options_.reserve_table_reader_memory);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  reserve_table_builder_memory: %d\n",
+           table_options_.reserve_table_builder_memory);
+  ret.append(buffer);
   return ret;
 }
 
@@ -22,6 +22,7 @@ struct ConfigOptions;
 struct EnvOptions;
 
 class BlockBasedTableBuilder;
+class CacheReservationManager;
 
 // A class used to track actual bytes written from the tail in the recent SST
 // file opens, and provide a suggestion for following open.
@@ -81,6 +82,9 @@ class BlockBasedTableFactory : public TableFactory {
  private:
   BlockBasedTableOptions table_options_;
   mutable TailPrefetchStats tail_prefetch_stats_;
+  // Charges the memory of the table readers to the block cache, if
+  // reserve_table_reader_memory is set.
+  std::shared_ptr<CacheReservationManager> table_reader_cache_res_mgr_;
 };
 
 extern const std::string kHashIndexPrefixesBlock;
@@ -232,9 +232,17 @@ void BlockBasedTableIterator::InitDataBlock() {
     //   Enabled after 2 sequential IOs when ReadOptions.readahead_size == 0.
     // Explicit user requested readahead:
     //   Enabled from the very first IO when ReadOptions.readahead_size is set.
+    // No readahead is needed past the block containing the upper bound.
+    bool is_last_block_in_range =
+        read_options_.iterate_upper_bound != nullptr &&
+        user_comparator_.CompareWithoutTimestamp(
+            *read_options_.iterate_upper_bound,
+            /*a_has_ts=*/false, index_iter_->user_key(),
+            /*b_has_ts=*/true) <= 0;
     block_prefetcher_.PrefetchIfNeeded(rep, data_block_handle,
                                        read_options_.readahead_size,
-                                       is_for_compaction);
+                                       is_for_compaction,
+                                       is_last_block_in_range);
 
     Status s;
     table_->NewDataBlockIterator<DataBlockIter>(
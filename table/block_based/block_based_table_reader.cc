@@ -15,6 +15,7 @@
 #include <utility>
 #include <vector>
 
+#include "cache/cache_entry_roles.h"
 #include "cache/sharded_cache.h"
 
 #include "db/dbformat.h"
@@ -189,6 +190,29 @@ void DeleteCachedEntry(const Slice& /*key*/, void* value) {
   delete entry;
 }
 
+// Returns the deleter of the block cache entries of this type, which also
+// records their role for the cache entry stats.
+template <typename TBlocklike>
+Cache::DeleterFn GetBlockCacheDeleter(BlockType block_type) {
+  switch (block_type) {
+    case BlockType::kData:
+      return GetCacheEntryDeleterForRole<TBlocklike,
+                                         CacheEntryRole::kDataBlock>();
+    case BlockType::kFilter:
+      return GetCacheEntryDeleterForRole<TBlocklike,
+                                         CacheEntryRole::kFilterBlock>();
+    case BlockType::kIndex:
+      return GetCacheEntryDeleterForRole<TBlocklike,
+                                         CacheEntryRole::kIndexBlock>();
+    case BlockType::kCompressionDictionary:
+      return GetCacheEntryDeleterForRole<
+          TBlocklike, CacheEntryRole::kCompressionDictionaryBlock>();
+    default:
+      return GetCacheEntryDeleterForRole<TBlocklike,
+                                         CacheEntryRole::kOtherBlock>();
+  }
+}
+
 // Release the cached entry and decrement its ref count.
 // Do not force erase
 void ReleaseCachedEntry(void* arg, void* h) {
@@ -1210,7 +1234,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
       size_t charge = block_holder->ApproximateMemoryUsage();
       Cache::Handle* cache_handle = nullptr;
       s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                              &DeleteCachedEntry<TBlocklike>, &cache_handle);
+                              GetBlockCacheDeleter<TBlocklike>(block_type),
+                              &cache_handle);
       if (s.ok()) {
         assert(cache_handle != nullptr);
         block->SetCachedValue(block_holder.release(), block_cache,
@@ -1315,8 +1340,8 @@ Status BlockBasedTable::PutDataBlockToCache(
     size_t charge = block_holder->ApproximateMemoryUsage();
     Cache::Handle* cache_handle = nullptr;
     s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                            &DeleteCachedEntry<TBlocklike>, &cache_handle,
-                            priority);
+                            GetBlockCacheDeleter<TBlocklike>(block_type),
+                            &cache_handle, priority);
     if (s.ok()) {
       assert(cache_handle != nullptr);
       cached_block->SetCachedValue(block_holder.release(), block_cache,
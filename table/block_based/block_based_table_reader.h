@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "cache/cache_reservation_manager.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "file/filename.h"
 #include "table/block_based/block_based_table_factory.h"
@@ -543,6 +544,10 @@ struct BlockBasedTable::Rep {
   std::unique_ptr<FilterBlockReader> filter;
   std::unique_ptr<UncompressionDictReader> uncompression_dict_reader;
 
+  // Charges the memory of this reader to the block cache, if
+  // reserve_table_reader_memory is set.
+  std::unique_ptr<CacheReservationHandle> table_reader_cache_res_handle;
+
   enum class FilterType {
     kNoFilter,
     kFullFilter,
@@ -599,6 +604,11 @@ struct BlockBasedTable::Rep {
 
   const bool immortal_table;
 
+  // Auto readahead size most recently reached by an iterator on this file.
+  // New iterators start from it, so that the readahead learned by one scan
+  // carries over to the next instead of ramping up from scratch again.
+  mutable std::atomic<size_t> auto_readahead_size{0};
+
   SequenceNumber get_global_seqno(BlockType block_type) const {
     return (block_type == BlockType::kFilter ||
             block_type == BlockType::kCompressionDictionary)
@@ -623,12 +633,14 @@ struct BlockBasedTable::Rep {
   uint64_t sst_number_for_tracing() const {
     return file ? TableFileNameToNumber(file->file_name()) : UINT64_MAX;
   }
-  void CreateFilePrefetchBuffer(
-      size_t readahead_size, size_t max_readahead_size,
-      std::unique_ptr<FilePrefetchBuffer>* fpb) const {
-    fpb->reset(new FilePrefetchBuffer(file.get(), readahead_size,
-                                      max_readahead_size,
-                                      !ioptions.allow_mmap_reads /* enable */));
+  void CreateFilePrefetchBuffer(size_t readahead_size,
+                                size_t max_readahead_size,
+                                std::unique_ptr<FilePrefetchBuffer>* fpb,
+                                bool async_read = false) const {
+    fpb->reset(new FilePrefetchBuffer(
+        file.get(), readahead_size, max_readahead_size,
+        !ioptions.allow_mmap_reads /* enable */, false /* track_min_offset */,
+        async_read ? ioptions.env : nullptr /* async_env */));
   }
 };
 }  // namespace ROCKSDB_NAMESPACE
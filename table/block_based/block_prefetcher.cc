@@ -8,37 +8,92 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based/block_prefetcher.h"
 
+#include <algorithm>
+
+#include "rocksdb/rate_limiter.h"
+#include "test_util/sync_point.h"
+
 namespace ROCKSDB_NAMESPACE {
+void BlockPrefetcher::UpdateReadPattern(const BlockBasedTable::Rep* rep,
+                                        const BlockHandle& handle) {
+  const size_t kInitReadaheadSize = BlockBasedTable::kInitAutoReadaheadSize;
+  const uint64_t offset = handle.offset();
+  bool sequential;
+  if (num_file_reads_ == 0) {
+    // First read through this iterator. Start from the readahead size that
+    // earlier iterators on this file settled on.
+    readahead_size_ =
+        std::max(kInitReadaheadSize,
+                 rep->auto_readahead_size.load(std::memory_order_relaxed));
+    sequential = true;
+  } else {
+    // Skipping forward within the prefetched window costs no extra I/O, so
+    // it does not break the sequential run.
+    sequential =
+        offset == prev_block_end_ ||
+        (offset > prev_block_end_ && offset < readahead_limit_);
+  }
+  if (!sequential) {
+    readahead_size_ = std::max(kInitReadaheadSize, readahead_size_ / 2);
+    readahead_limit_ = 0;
+    num_file_reads_ = 0;
+    if (rep->auto_readahead_size.load(std::memory_order_relaxed) !=
+        readahead_size_) {
+      rep->auto_readahead_size.store(readahead_size_,
+                                     std::memory_order_relaxed);
+    }
+  }
+  prev_block_end_ = offset + block_size(handle);
+  num_file_reads_++;
+}
+
 void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                                        const BlockHandle& handle,
                                        size_t readahead_size,
-                                       bool is_for_compaction) {
+                                       bool is_for_compaction,
+                                       bool is_last_block_in_range) {
   if (!is_for_compaction) {
     if (readahead_size == 0) {
       // Implicit auto readahead
-      num_file_reads_++;
-      if (num_file_reads_ >
-          BlockBasedTable::kMinNumFileReadsToStartAutoReadahead) {
-        if (!rep->file->use_direct_io() &&
-            (handle.offset() + static_cast<size_t>(block_size(handle)) >
-             readahead_limit_)) {
-          // Buffered I/O
+      if (!rep->file->use_direct_io()) {
+        // Buffered I/O
+        UpdateReadPattern(rep, handle);
+        if (num_file_reads_ <=
+                BlockBasedTable::kMinNumFileReadsToStartAutoReadahead ||
+            is_last_block_in_range) {
+          return;
+        }
+        if (handle.offset() + static_cast<size_t>(block_size(handle)) >
+            readahead_limit_) {
+          // The OS reads the window in the background. Charge it to the rate
+          // limiter like the readahead reads of direct I/O.
+          if (rep->ioptions.rate_limiter != nullptr) {
+            rep->ioptions.rate_limiter->RequestToken(
+                readahead_size_, 0 /* alignment */, Env::IO_USER,
+                rep->ioptions.statistics, RateLimiter::OpType::kRead);
+          }
           // Discarding the return status of Prefetch calls intentionally, as
           // we can fallback to reading from disk if Prefetch fails.
           rep->file->Prefetch(handle.offset(), readahead_size_);
+          TEST_SYNC_POINT_CALLBACK("BlockPrefetcher::PrefetchIfNeeded:Prefetch",
+                                   &readahead_size_);
           readahead_limit_ =
               static_cast<size_t>(handle.offset() + readahead_size_);
           // Keep exponentially increasing readahead size until
           // kMaxAutoReadaheadSize.
           readahead_size_ = std::min(BlockBasedTable::kMaxAutoReadaheadSize,
                                      readahead_size_ * 2);
-        } else if (rep->file->use_direct_io() && !prefetch_buffer_) {
-          // Direct I/O
-          // Let FilePrefetchBuffer take care of the readahead.
-          rep->CreateFilePrefetchBuffer(BlockBasedTable::kInitAutoReadaheadSize,
-                                        BlockBasedTable::kMaxAutoReadaheadSize,
-                                        &prefetch_buffer_);
+          rep->auto_readahead_size.store(readahead_size_,
+                                         std::memory_order_relaxed);
         }
+      } else if (++num_file_reads_ >
+                     BlockBasedTable::kMinNumFileReadsToStartAutoReadahead &&
+                 !prefetch_buffer_) {
+        // Direct I/O
+        // Let FilePrefetchBuffer take care of the readahead.
+        rep->CreateFilePrefetchBuffer(BlockBasedTable::kInitAutoReadaheadSize,
+                                      BlockBasedTable::kMaxAutoReadaheadSize,
+                                      &prefetch_buffer_);
       }
     } else if (!prefetch_buffer_) {
       // Explicit user requested readahead
@@ -48,9 +103,9 @@ void BlockPrefetcher::PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                                     &prefetch_buffer_);
     }
   } else if (!prefetch_buffer_) {
-    rep->CreateFilePrefetchBuffer(compaction_readahead_size_,
-                                  compaction_readahead_size_,
-                                  &prefetch_buffer_);
+    rep->CreateFilePrefetchBuffer(
+        compaction_readahead_size_, compaction_readahead_size_,
+        &prefetch_buffer_, rep->ioptions.async_compaction_readahead);
   }
 }
 }  // namespace ROCKSDB_NAMESPACE
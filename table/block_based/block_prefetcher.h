@@ -10,16 +10,40 @@
 #include "table/block_based/block_based_table_reader.h"
 
 namespace ROCKSDB_NAMESPACE {
+// BlockPrefetcher decides how much to read ahead of the data blocks an
+// iterator is about to consume.
+//
+// For implicit auto readahead with buffered I/O, it tracks the block offsets
+// the iterator reads. Readahead starts after
+// kMinNumFileReadsToStartAutoReadahead sequential reads and doubles every
+// time the iterator moves past the prefetched window, up to
+// kMaxAutoReadaheadSize. A read that skips forward within the prefetched
+// window still counts as sequential. Any other jump halves the readahead size
+// instead of resetting it, so a scan interrupted by a short seek quickly gets
+// back to full speed while a truly random pattern decays to no readahead.
+// The readahead size reached is shared with later iterators on the same file
+// through BlockBasedTable::Rep, and no readahead is issued past the block
+// containing the iterate_upper_bound.
 class BlockPrefetcher {
  public:
   explicit BlockPrefetcher(size_t compaction_readahead_size)
       : compaction_readahead_size_(compaction_readahead_size) {}
+  // `is_last_block_in_range` : true if the iterator will not need any data
+  //   block after `handle`, e.g. because `handle` contains
+  //   ReadOptions::iterate_upper_bound.
   void PrefetchIfNeeded(const BlockBasedTable::Rep* rep,
                         const BlockHandle& handle, size_t readahead_size,
-                        bool is_for_compaction);
+                        bool is_for_compaction,
+                        bool is_last_block_in_range = false);
   FilePrefetchBuffer* prefetch_buffer() { return prefetch_buffer_.get(); }
 
  private:
+  // Updates the observed read pattern with a read of the given block. A read
+  // that does not continue the current sequential run halves the readahead
+  // size and restarts the count of sequential reads.
+  void UpdateReadPattern(const BlockBasedTable::Rep* rep,
+                         const BlockHandle& handle);
+
   // Readahead size used in compaction, its value is used only if
   // lookup_context_.caller = kCompaction.
   size_t compaction_readahead_size_;
@@ -27,6 +51,8 @@ class BlockPrefetcher {
   size_t readahead_size_ = BlockBasedTable::kInitAutoReadaheadSize;
   size_t readahead_limit_ = 0;
   int64_t num_file_reads_ = 0;
+  // End offset of the previous data block read through this prefetcher.
+  uint64_t prev_block_end_ = 0;
   std::unique_ptr<FilePrefetchBuffer> prefetch_buffer_;
 };
 }  // namespace ROCKSDB_NAMESPACE
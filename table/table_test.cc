@@ -4523,6 +4523,50 @@ TEST_F(BBTTailPrefetchTest, FilePrefetchBufferMinOffset) {
   ASSERT_EQ(480, buffer.min_offset_read());
 }
 
+TEST_F(BBTTailPrefetchTest, FilePrefetchBufferAsyncRead) {
+  Env* env = Env::Default();
+  env->SetBackgroundThreads(1, Env::Priority::USER);
+  Random rnd(301);
+  const size_t kFileSize = 1 << 20;
+  const size_t kReadaheadSize = 64 << 10;
+  std::string contents = rnd.RandomString(static_cast<int>(kFileSize));
+  std::unique_ptr<RandomAccessFileReader> file_reader(
+      test::GetRandomAccessFileReader(new test::StringSource(contents)));
+
+  std::atomic<int> num_scheduled(0);
+  std::atomic<int> num_hits(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::MaybeScheduleAsyncRead:Schedule",
+      [&](void* /*arg*/) { num_scheduled++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::TryReadFromAsyncBuffer:Hit",
+      [&](void* /*arg*/) { num_hits++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  IOOptions opts;
+  {
+    FilePrefetchBuffer buffer(file_reader.get(), kReadaheadSize,
+                              kReadaheadSize, true /* enable */,
+                              false /* track_min_offset */, env);
+    // Reads that are not multiples of the readahead size make some requests
+    // straddle the two buffers.
+    const size_t kReadSize = 3000;
+    for (size_t offset = 0; offset < kFileSize; offset += kReadSize) {
+      size_t n = std::min(kReadSize, kFileSize - offset);
+      Slice result;
+      ASSERT_TRUE(buffer.TryReadFromCache(opts, offset, n, &result,
+                                          true /* for_compaction */));
+      ASSERT_EQ(Slice(contents.data() + offset, n), result);
+    }
+  }
+  // All but the first chunk came from background reads.
+  ASSERT_GE(num_hits.load(), static_cast<int>(kFileSize / kReadaheadSize) - 1);
+  ASSERT_GE(num_scheduled.load(), num_hits.load());
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_P(BlockBasedTableTest, DataBlockHashIndex) {
   const int kNumKeys = 500;
   const int kKeySize = 8;
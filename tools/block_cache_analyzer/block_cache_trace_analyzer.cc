@@ -34,8 +34,10 @@ DEFINE_string(
     "The config file path. One cache configuration per line. The format of a "
     "cache configuration is "
     "cache_name,num_shard_bits,ghost_capacity,cache_capacity_1,...,cache_"
-    "capacity_N. Supported cache names are lru, lru_priority, lru_hybrid, and "
-    "lru_hybrid_no_insert_on_row_miss. User may also add a prefix 'ghost_' to "
+    "capacity_N. Supported cache names are lru, lru_tinylfu, lru_priority, "
+    "lru_priority_tinylfu, lru_hybrid, and lru_hybrid_no_insert_on_row_miss. "
+    "The tinylfu variants enable TinyLFU admission control, for all blocks "
+    "or for data blocks respectively. User may also add a prefix 'ghost_' to "
     "a cache_name to add a ghost cache in front of the real cache. "
     "ghost_capacity and cache_capacity can be xK, xM or xG where x is a "
     "positive number.");
@@ -166,7 +168,9 @@ const std::set<std::string> kGroupbyLabels{
     kGroupbyBlock,     kGroupbyColumnFamily, kGroupbySSTFile, kGroupbyLevel,
     kGroupbyBlockType, kGroupbyCaller,       kGroupbyAll};
 const std::string kSupportedCacheNames =
-    " lru ghost_lru lru_priority ghost_lru_priority lru_hybrid "
+    " lru ghost_lru lru_tinylfu ghost_lru_tinylfu lru_priority "
+    "ghost_lru_priority lru_priority_tinylfu ghost_lru_priority_tinylfu "
+    "lru_hybrid "
     "ghost_lru_hybrid lru_hybrid_no_insert_on_row_miss "
     "ghost_lru_hybrid_no_insert_on_row_miss ";
 
@@ -447,6 +447,16 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
               "If > 0.0, we also enable "
               "cache_index_and_filter_blocks_with_high_priority.");
 
+DEFINE_double(cache_probation_pool_ratio, 0.0,
+              "If > 0.0, data blocks enter the block cache through a "
+              "probation FIFO taking this ratio of the cache, and move to the "
+              "LRU list only when hit again.");
+
+DEFINE_double(cache_miss_ratio_curve_sampling_rate, 0.0,
+              "If > 0, the block cache estimates its miss ratio at other "
+              "capacities from the lookups of this fraction of the keys, and "
+              "the estimate is printed at the end of the benchmarks.");
+
 DEFINE_bool(use_clock_cache, false,
             "Replace default LRU block cache with clock cache.");
 
@@ -460,6 +470,13 @@ DEFINE_bool(cache_index_and_filter_blocks, false,
 DEFINE_bool(use_cache_memkind_kmem_allocator, false,
             "Use memkind kmem allocator for block cache.");
 
+DEFINE_bool(use_cache_slab_allocator, false,
+            "Use the slab memory allocator for block cache.");
+
+DEFINE_bool(cache_slab_allocator_use_huge_pages, true,
+            "Back the slabs of the block cache slab allocator with huge "
+            "pages.");
+
 DEFINE_bool(partition_index_and_filters, false,
             "Partition index and filter blocks.");
 
@@ -527,6 +544,16 @@ DEFINE_bool(block_align,
             ROCKSDB_NAMESPACE::BlockBasedTableOptions().block_align,
             "Align data blocks on page size");
 
+DEFINE_bool(reserve_table_reader_memory,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .reserve_table_reader_memory,
+            "Charge the memory of table readers to the block cache");
+
+DEFINE_bool(reserve_table_builder_memory,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .reserve_table_builder_memory,
+            "Charge the memory buffered to build filters to the block cache");
+
 DEFINE_bool(use_data_block_hash_index, false,
             "if use kDataBlockBinaryAndHash "
             "instead of kDataBlockBinarySearch. "
@@ -558,6 +585,9 @@ DEFINE_bool(new_table_reader_for_compaction_inputs, true,
 
 DEFINE_int32(compaction_readahead_size, 0, "Compaction readahead size");
 
+DEFINE_bool(async_compaction_readahead, false,
+            "Read the next compaction readahead chunk in the background");
+
 DEFINE_int32(log_readahead_size, 0, "WAL and manifest readahead size");
 
 DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
@@ -860,8 +890,17 @@ DEFINE_bool(use_stderr_info_logger, false,
 
 DEFINE_string(trace_file, "", "Trace workload to a file. ");
 
-DEFINE_int32(trace_replay_fast_forward, 1,
-             "Fast forward trace replay, must >= 1. ");
+DEFINE_uint64(trace_key_sampling_frequency, 1,
+              "Trace the operations on one out of this many keys, picked by "
+              "key hash.");
+
+DEFINE_uint64(trace_buffer_size, 0,
+              "If > 0, buffer the traces of each thread in a ring buffer of "
+              "this many bytes, written by a background thread.");
+
+DEFINE_double(trace_replay_fast_forward, 1.0,
+              "Speedup factor of the trace replay, must be > 0. Values < 1 "
+              "slow down the replay.");
 DEFINE_int32(block_cache_trace_sampling_frequency, 1,
              "Block cache trace sampling frequency, termed s. It uses spatial "
              "downsampling and samples accesses to one out of s blocks.");
@@ -874,6 +913,11 @@ DEFINE_int64(
 DEFINE_string(block_cache_trace_file, "", "Block cache trace file path.");
 DEFINE_int32(trace_replay_threads, 1,
              "The number of threads to replay, must >=1.");
+DEFINE_bool(trace_replay_per_thread, false,
+            "Replay the trace with one thread per traced thread, keeping the "
+            "order of the operations of each traced thread, and report the "
+            "latency of the replayed operations per type. "
+            "trace_replay_threads is ignored.");
 
 static enum ROCKSDB_NAMESPACE::CompressionType StringToCompressionType(
     const char* ctype) {
@@ -2676,9 +2720,30 @@ class Benchmark {
         exit(1);
 #endif
       } else {
-        return NewLRUCache(
+        LRUCacheOptions opts(
             static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
             false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio);
+        opts.miss_ratio_curve_sampling_rate =
+            FLAGS_cache_miss_ratio_curve_sampling_rate;
+        opts.probation_pool_ratio = FLAGS_cache_probation_pool_ratio;
+        opts.numa_aware = FLAGS_enable_numa;
+        if (FLAGS_use_cache_slab_allocator) {
+          SlabAllocatorOptions slab_opts;
+          slab_opts.use_huge_pages = FLAGS_cache_slab_allocator_use_huge_pages;
+          slab_opts.max_slab_allocation_size =
+              std::max<size_t>(slab_opts.max_slab_allocation_size,
+                               4 * static_cast<size_t>(FLAGS_block_size));
+          while (slab_opts.slab_size < 8 * slab_opts.max_slab_allocation_size) {
+            slab_opts.slab_size *= 2;
+          }
+          Status s =
+              NewSlabMemoryAllocator(slab_opts, &opts.memory_allocator);
+          if (!s.ok()) {
+            fprintf(stderr, "Slab allocator: %s\n", s.ToString().c_str());
+            exit(1);
+          }
+        }
+        return NewLRUCache(opts);
       }
     }
   }
@@ -3211,6 +3276,10 @@ class Benchmark {
                     s.ToString().c_str());
             exit(1);
           }
+          trace_options_.key_sampling_frequency =
+              FLAGS_trace_key_sampling_frequency;
+          trace_options_.buffer_size =
+              static_cast<size_t>(FLAGS_trace_buffer_size);
           s = db_.db->StartTrace(trace_options_, std::move(trace_writer));
           if (!s.ok()) {
             fprintf(stderr, "Encountered an error starting a trace, %s\n",
@@ -3302,6 +3371,12 @@ class Benchmark {
         fprintf(stderr, "Encountered an error ending the trace, %s\n",
                 s.ToString().c_str());
       }
+      uint64_t dropped = 0;
+      if (FLAGS_trace_buffer_size > 0 &&
+          db_.db->GetIntProperty(DB::Properties::kTraceDroppedRecords,
+                                 &dropped)) {
+        fprintf(stdout, "Dropped trace records: %" PRIu64 "\n", dropped);
+      }
     }
     if (!FLAGS_block_cache_trace_file.empty()) {
       Status s = db_.db->EndBlockCacheTrace();
@@ -3321,6 +3396,14 @@ class Benchmark {
           stdout, "SIMULATOR CACHE STATISTICS:\n%s\n",
           static_cast_with_check<SimCache>(cache_.get())->ToString().c_str());
     }
+    std::vector<MissRatioCurvePoint> curve;
+    if (cache_ != nullptr && cache_->GetMissRatioCurve(&curve)) {
+      fprintf(stdout, "Estimated block cache miss ratio curve:\n");
+      for (const auto& point : curve) {
+        fprintf(stdout, "%" ROCKSDB_PRIszt " bytes: %.4f\n", point.capacity,
+                point.miss_ratio);
+      }
+    }
 
 #ifndef ROCKSDB_LITE
     if (FLAGS_use_secondary_db) {
@@ -3709,6 +3792,7 @@ class Benchmark {
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
+    options.async_compaction_readahead = FLAGS_async_compaction_readahead;
     options.log_readahead_size = FLAGS_log_readahead_size;
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
     options.writable_file_max_buffer_size = FLAGS_writable_file_max_buffer_size;
@@ -3875,6 +3959,10 @@ class Benchmark {
       block_based_options.enable_index_compression =
           FLAGS_enable_index_compression;
       block_based_options.block_align = FLAGS_block_align;
+      block_based_options.reserve_table_reader_memory =
+          FLAGS_reserve_table_reader_memory;
+      block_based_options.reserve_table_builder_memory =
+          FLAGS_reserve_table_builder_memory;
       if (FLAGS_use_data_block_hash_index) {
         block_based_options.data_block_index_type =
             ROCKSDB_NAMESPACE::BlockBasedTableOptions::kDataBlockBinaryAndHash;
@@ -4095,6 +4183,11 @@ class Benchmark {
       FLAGS_env->LowerThreadPoolCPUPriority(Env::LOW);
       FLAGS_env->LowerThreadPoolCPUPriority(Env::HIGH);
     }
+    if (FLAGS_enable_numa) {
+      FLAGS_env->PinThreadPoolToNumaNodes(Env::LOW);
+      FLAGS_env->PinThreadPoolToNumaNodes(Env::HIGH);
+      FLAGS_env->PinThreadPoolToNumaNodes(Env::BOTTOM);
+    }
     options.env = FLAGS_env;
     if (FLAGS_sine_write_rate) {
       FLAGS_benchmark_write_rate_limit = static_cast<uint64_t>(SineRate(0));
@@ -7043,10 +7136,18 @@ class Benchmark {
     }
     Replayer replayer(db_with_cfh->db, db_with_cfh->cfh,
                       std::move(trace_reader));
-    replayer.SetFastForward(
-        static_cast<uint32_t>(FLAGS_trace_replay_fast_forward));
-    s = replayer.MultiThreadReplay(
-        static_cast<uint32_t>(FLAGS_trace_replay_threads));
+    s = replayer.SetFastForward(FLAGS_trace_replay_fast_forward);
+    if (!s.ok()) {
+      fprintf(stderr, "Invalid trace_replay_fast_forward: %f\n",
+              FLAGS_trace_replay_fast_forward);
+      exit(1);
+    }
+    if (FLAGS_trace_replay_per_thread) {
+      s = replayer.PerThreadReplay();
+    } else {
+      s = replayer.MultiThreadReplay(
+          static_cast<uint32_t>(FLAGS_trace_replay_threads));
+    }
     if (s.ok()) {
       fprintf(stdout, "Replay started from trace_file: %s\n",
               FLAGS_trace_file.c_str());
@@ -7054,6 +7155,22 @@ class Benchmark {
       fprintf(stderr, "Starting replay failed. Error: %s\n",
               s.ToString().c_str());
     }
+    if (FLAGS_trace_replay_per_thread) {
+      const std::vector<std::pair<TraceType, std::string>> op_types = {
+          {kTraceWrite, "Write"},
+          {kTraceGet, "Get"},
+          {kTraceMultiGet, "MultiGet"},
+          {kTraceIteratorSeek, "Seek"},
+          {kTraceIteratorSeekForPrev, "SeekForPrev"},
+          {kTraceIteratorNext, "Next"}};
+      for (const auto& op_type : op_types) {
+        const HistogramImpl& hist = replayer.GetLatencyHistogram(op_type.first);
+        if (hist.num() > 0) {
+          fprintf(stdout, "Microseconds per %s:\n%s\n",
+                  op_type.second.c_str(), hist.ToString().c_str());
+        }
+      }
+    }
   }
 };
 
@@ -734,6 +734,34 @@ TEST_F(TraceAnalyzerTest, Iterator) {
   CheckFileContent(top_qps, file_path, true);
 }
 
+// Test analyzing the workload model
+TEST_F(TraceAnalyzerTest, WorkloadModel) {
+  std::string trace_path = test_path_ + "/trace";
+  std::string output_path = test_path_ + "/workload_model";
+  std::vector<std::string> paras = {
+      "-analyze_get=true",           "-analyze_put=true",
+      "-analyze_delete=false",       "-analyze_single_delete=false",
+      "-analyze_range_delete=false", "-analyze_iterator=true",
+      "-output_workload_model=true"};
+  paras.push_back("-output_dir=" + output_path);
+  paras.push_back("-trace_path=" + trace_path);
+  paras.push_back("-key_space_dir=" + test_path_);
+  AnalyzeTrace(paras, output_path, trace_path);
+
+  // 2 Gets, 1 Put, 1 Seek and 1 SeekForPrev. The two Get keys are accessed
+  // once each, so F(r) = 0.5 * r.
+  std::string model;
+  ASSERT_OK(ReadFileToString(env_, output_path + "/test-workload_model.txt",
+                             &model));
+  ASSERT_NE(std::string::npos, model.find("--mix_get_ratio=0.4\n"));
+  ASSERT_NE(std::string::npos, model.find("--mix_put_ratio=0.2\n"));
+  ASSERT_NE(std::string::npos, model.find("--mix_seek_ratio=0.4\n"));
+  ASSERT_NE(std::string::npos, model.find("--key_dist_a=0.5\n"));
+  ASSERT_NE(std::string::npos, model.find("--key_dist_b=1\n"));
+  ASSERT_NE(std::string::npos, model.find("--mix_ave_kv_size=10\n"));
+  ASSERT_NE(std::string::npos, model.find("--sine_d="));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -15,10 +15,12 @@
 #include <unistd.h>
 #endif
 
+#include <algorithm>
 #include <cinttypes>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
 #include <memory>
 #include <sstream>
 #include <stdexcept>
@@ -164,6 +166,14 @@ DEFINE_int32(value_interval, 8,
 DEFINE_double(sample_ratio, 1.0,
               "If the trace size is extremely huge or user want to sample "
               "the trace when analyzing, sample ratio can be set (0, 1.0]");
+DEFINE_bool(output_workload_model, false,
+            "Fit a synthetic workload model to the analyzed Get, Put and "
+            "Seek queries and output it as db_bench mix_graph flags.\n"
+            "Key access counts are fitted from the Get queries "
+            "(needs 'analyze_get') and value sizes from the Put queries "
+            "(needs 'analyze_put').\n"
+            "File name: <prefix>-workload_model.txt\n"
+            "Format: one '--flag=value' per line.");
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -427,12 +437,7 @@ Status TraceAnalyzer::ReadTraceRecord(Trace* trace) {
     return s;
   }
 
-  Slice enc_slice = Slice(encoded_trace);
-  GetFixed64(&enc_slice, &trace->ts);
-  trace->type = static_cast<TraceType>(enc_slice[0]);
-  enc_slice.remove_prefix(kTraceTypeSize + kTracePayloadLengthSize);
-  trace->payload = enc_slice.ToString();
-  return s;
+  return TracerHelper::DecodeTrace(encoded_trace, trace);
 }
 
 // process the trace itself and redirect the trace content
@@ -492,6 +497,25 @@ Status TraceAnalyzer::StartProcessing() {
         fprintf(stderr, "Cannot process the get in the trace\n");
         return s;
       }
+    } else if (trace.type == kTraceMultiGet) {
+      // Each key of a MultiGet is analyzed as a Get.
+      Slice buf(trace.payload);
+      uint32_t num_keys = 0;
+      GetFixed32(&buf, &num_keys);
+      for (uint32_t i = 0; i < num_keys; ++i) {
+        uint32_t cf_id = 0;
+        Slice key;
+        if (!GetFixed32(&buf, &cf_id) || !GetLengthPrefixedSlice(&buf, &key)) {
+          fprintf(stderr, "Cannot decode the multiget in the trace\n");
+          return Status::Corruption("Corrupted MultiGet trace.");
+        }
+        total_gets_++;
+        s = HandleGet(cf_id, key.ToString(), trace.ts, 1);
+        if (!s.ok()) {
+          fprintf(stderr, "Cannot process the multiget in the trace\n");
+          return s;
+        }
+      }
     } else if (trace.type == kTraceIteratorSeek ||
                trace.type == kTraceIteratorSeekForPrev) {
       uint32_t cf_id = 0;
@@ -653,9 +677,123 @@ Status TraceAnalyzer::MakeStatistics() {
     }
   }
 
+  if (FLAGS_output_workload_model) {
+    s = MakeWorkloadModel();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
   return Status::OK();
 }
 
+// Fit the models used by the db_bench mix_graph benchmark to the trace:
+// the Get/Put/Seek mix, the power distribution F(r) = a * r^b of the
+// fraction of Get accesses going to the r hottest keys, a Generalized Pareto
+// distribution of the Put value sizes (by method of moments), and the
+// average QPS.
+Status TraceAnalyzer::MakeWorkloadModel() {
+  uint64_t type_count[kTaTypeNum] = {0};
+  uint64_t kv_size_sum = 0;
+  uint64_t value_count = 0;
+  double value_size_sum = 0.0;
+  double value_size_sqsum = 0.0;
+  std::vector<uint64_t> get_counts;
+  for (int type = 0; type < kTaTypeNum; type++) {
+    for (auto& stat : ta_[type].stats) {
+      type_count[type] += stat.second.a_count;
+      if (type == TraceOperationType::kGet) {
+        for (auto& record : stat.second.a_key_stats) {
+          get_counts.push_back(record.second.access_count);
+        }
+      } else if (type == TraceOperationType::kPut) {
+        kv_size_sum += stat.second.a_key_size_sum + stat.second.a_value_size_sum;
+        value_count += stat.second.a_count;
+        value_size_sum += static_cast<double>(stat.second.a_value_size_sum);
+        value_size_sqsum += static_cast<double>(stat.second.a_value_size_sqsum);
+      }
+    }
+  }
+  uint64_t seeks = type_count[TraceOperationType::kIteratorSeek] +
+                   type_count[TraceOperationType::kIteratorSeekForPrev];
+  uint64_t total = type_count[TraceOperationType::kGet] +
+                   type_count[TraceOperationType::kPut] + seeks;
+  if (total == 0) {
+    return Status::InvalidArgument(
+        "No Get, Put or Seek analyzed for the workload model");
+  }
+
+  std::ostringstream model;
+  model << "--mix_get_ratio="
+        << static_cast<double>(type_count[TraceOperationType::kGet]) / total
+        << "\n";
+  model << "--mix_put_ratio="
+        << static_cast<double>(type_count[TraceOperationType::kPut]) / total
+        << "\n";
+  model << "--mix_seek_ratio=" << static_cast<double>(seeks) / total << "\n";
+
+  // Least squares fit of log(F(r)) = log(a) + b * log(r).
+  if (get_counts.size() > 1) {
+    std::sort(get_counts.begin(), get_counts.end(),
+              std::greater<uint64_t>());
+    uint64_t get_total = 0;
+    for (uint64_t count : get_counts) {
+      get_total += count;
+    }
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    uint64_t cumulative = 0;
+    for (size_t r = 0; r < get_counts.size(); r++) {
+      cumulative += get_counts[r];
+      double x = std::log(static_cast<double>(r + 1));
+      double y = std::log(static_cast<double>(cumulative) / get_total);
+      sx += x;
+      sy += y;
+      sxx += x * x;
+      sxy += x * y;
+    }
+    double n = static_cast<double>(get_counts.size());
+    double b = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    double a = std::exp((sy - b * sx) / n);
+    if (b > 0.0) {
+      model << "--key_dist_a=" << a << "\n";
+      model << "--key_dist_b=" << b << "\n";
+    }
+  }
+
+  if (value_count > 0) {
+    double mean = value_size_sum / value_count;
+    double var = value_size_sqsum / value_count - mean * mean;
+    if (mean > 0.0 && var > 0.0) {
+      double k = (1.0 - mean * mean / var) / 2.0;
+      model << "--value_theta=0\n";
+      model << "--value_k=" << k << "\n";
+      model << "--value_sigma=" << mean * (1.0 - k) << "\n";
+    }
+    model << "--mix_ave_kv_size=" << kv_size_sum / value_count << "\n";
+  }
+
+  if (end_time_ > begin_time_) {
+    double duration = static_cast<double>(end_time_ - begin_time_) / 1000000;
+    model << "--sine_mix_rate=true\n";
+    model << "--sine_a=0\n";
+    model << "--sine_d=" << total * sample_max_ / duration << "\n";
+  }
+
+  std::unique_ptr<WritableFile> model_f;
+  std::string model_path =
+      output_path_ + "/" + FLAGS_output_prefix + "-workload_model.txt";
+  Status s = env_->NewWritableFile(model_path, &model_f, env_options_);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot open file: %s\n", model_path.c_str());
+    return s;
+  }
+  s = model_f->Append(model.str());
+  if (s.ok()) {
+    s = model_f->Close();
+  }
+  return s;
+}
+
 // Process the statistics of the key access and
 // prefix of the accessed keys if required
 Status TraceAnalyzer::MakeStatisticKeyStatsOrPrefix(TraceStats& stats) {
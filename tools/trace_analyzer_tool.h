@@ -249,6 +249,7 @@ class TraceAnalyzer {
   Status MakeStatisticKeyStatsOrPrefix(TraceStats& stats);
   Status MakeStatisticCorrelation(TraceStats& stats, StatsUnit& unit);
   Status MakeStatisticQPS();
+  Status MakeWorkloadModel();
 };
 
 // write bach handler to be used for WriteBache iterator
@@ -5,14 +5,22 @@
 
 #include "trace_replay/trace_replay.h"
 
+#include <algorithm>
 #include <chrono>
+#include <deque>
+#include <functional>
 #include <sstream>
 #include <thread>
 #include "db/db_impl/db_impl.h"
+#include "db/write_batch_internal.h"
+#include "port/port.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/write_batch.h"
 #include "util/coding.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
 #include "util/string_util.h"
+#include "util/thread_local.h"
 #include "util/threadpool_imp.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -25,19 +33,75 @@ void EncodeCFAndKey(std::string* dst, uint32_t cf_id, const Slice& key) {
   PutLengthPrefixedSlice(dst, key);
 }
 
-void DecodeCFAndKey(std::string& buffer, uint32_t* cf_id, Slice* key) {
+void DecodeCFAndKey(const std::string& buffer, uint32_t* cf_id, Slice* key) {
   Slice buf(buffer);
   GetFixed32(&buf, cf_id);
   GetLengthPrefixedSlice(&buf, key);
 }
+
+// Iterator traces are followed by the iterator id since trace version 0.2.
+void DecodeIteratorTrace(const std::string& buffer, uint32_t* cf_id,
+                         Slice* key, uint64_t* iter_id) {
+  Slice buf(buffer);
+  GetFixed32(&buf, cf_id);
+  if (key != nullptr) {
+    GetLengthPrefixedSlice(&buf, key);
+  }
+  if (!GetFixed64(&buf, iter_id)) {
+    *iter_id = 0;
+  }
+}
+
+Status DecodeMultiGet(const std::string& buffer,
+                      std::vector<uint32_t>* cf_ids,
+                      std::vector<Slice>* keys) {
+  Slice buf(buffer);
+  uint32_t num_keys = 0;
+  if (!GetFixed32(&buf, &num_keys)) {
+    return Status::Corruption("Corrupted MultiGet trace.");
+  }
+  cf_ids->resize(num_keys);
+  keys->resize(num_keys);
+  for (uint32_t i = 0; i < num_keys; ++i) {
+    if (!GetFixed32(&buf, &(*cf_ids)[i]) ||
+        !GetLengthPrefixedSlice(&buf, &(*keys)[i])) {
+      return Status::Corruption("Corrupted MultiGet trace.");
+    }
+  }
+  return Status::OK();
+}
+
+// The traces of one traced thread, waiting for its replay thread.
+struct ReplayThreadQueue {
+  // Maximum number of traces queued before the reader waits for the replay
+  // thread to catch up.
+  static const size_t kMaxQueued = 10000;
+
+  port::Mutex mu;
+  port::CondVar cv;
+  std::deque<Trace> traces;
+  bool done;
+
+  ReplayThreadQueue() : cv(&mu), done(false) {}
+};
 }  // namespace
 
 void TracerHelper::EncodeTrace(const Trace& trace, std::string* encoded_trace) {
   assert(encoded_trace);
   PutFixed64(encoded_trace, trace.ts);
-  encoded_trace->push_back(trace.type);
-  PutFixed32(encoded_trace, static_cast<uint32_t>(trace.payload.size()));
-  encoded_trace->append(trace.payload);
+  if (trace.thread_id == 0) {
+    encoded_trace->push_back(trace.type);
+    PutFixed32(encoded_trace, static_cast<uint32_t>(trace.payload.size()));
+    encoded_trace->append(trace.payload);
+  } else {
+    encoded_trace->push_back(
+        static_cast<char>(static_cast<unsigned char>(trace.type) |
+                          kTraceThreadIdFlag));
+    PutFixed32(encoded_trace,
+               static_cast<uint32_t>(trace.payload.size() + sizeof(uint64_t)));
+    encoded_trace->append(trace.payload);
+    PutFixed64(encoded_trace, trace.thread_id);
+  }
 }
 
 Status TracerHelper::DecodeTrace(const std::string& encoded_trace,
@@ -50,22 +114,215 @@ Status TracerHelper::DecodeTrace(const std::string& encoded_trace,
   if (enc_slice.size() < kTraceTypeSize + kTracePayloadLengthSize) {
     return Status::Incomplete("Decode trace string failed");
   }
-  trace->type = static_cast<TraceType>(enc_slice[0]);
+  unsigned char type = static_cast<unsigned char>(enc_slice[0]);
   enc_slice.remove_prefix(kTraceTypeSize + kTracePayloadLengthSize);
-  trace->payload = enc_slice.ToString();
+  if ((type & kTraceThreadIdFlag) == 0) {
+    trace->type = static_cast<TraceType>(type);
+    trace->payload = enc_slice.ToString();
+    trace->thread_id = 0;
+  } else {
+    trace->type = static_cast<TraceType>(type & ~kTraceThreadIdFlag);
+    if (enc_slice.size() < sizeof(uint64_t)) {
+      return Status::Incomplete("Decode trace string failed");
+    }
+    size_t payload_size = enc_slice.size() - sizeof(uint64_t);
+    trace->payload.assign(enc_slice.data(), payload_size);
+    trace->thread_id = DecodeFixed64(enc_slice.data() + payload_size);
+  }
   return Status::OK();
 }
 
+// The state used to sample the traces of one thread, or of all threads if
+// the traces are not buffered.
+struct Tracer::SamplingState {
+  // Number of slots of sampled_iters.
+  static const size_t kNumIterSlots = 64;
+
+  uint64_t request_count = 0;
+  // The ids of recently sought iterators whose seek was traced, so that their
+  // following Next() calls are traced too. Indexed by a hash of the id.
+  uint64_t sampled_iters[kNumIterSlots] = {};
+
+  uint64_t* IterSlot(uint64_t iter_id) {
+    return &sampled_iters[GetSliceNPHash64(Slice(
+                              reinterpret_cast<const char*>(&iter_id),
+                              sizeof(iter_id))) %
+                          kNumIterSlots];
+  }
+};
+
+// A ring buffer of encoded traces with a single producer, the thread owning
+// it, and a single consumer, the drain thread. Each trace is prefixed with
+// its fixed32 length.
+struct Tracer::ThreadBuffer {
+  explicit ThreadBuffer(size_t capacity)
+      : data(capacity),
+        head(0),
+        tail(0),
+        dropped(0),
+        drain_requested(false),
+        abandoned(false) {}
+
+  // Appends an encoded trace, or drops it if it does not fit. Returns true if
+  // the buffer became half full and should be drained soon.
+  bool Append(const std::string& encoded_trace) {
+    const uint64_t size = kTracePayloadLengthSize + encoded_trace.size();
+    const uint64_t t = tail.load(std::memory_order_relaxed);
+    const uint64_t h = head.load(std::memory_order_acquire);
+    if (t - h + size > data.size()) {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    char len[kTracePayloadLengthSize];
+    EncodeFixed32(len, static_cast<uint32_t>(encoded_trace.size()));
+    CopyIn(t, len, sizeof(len));
+    CopyIn(t + sizeof(len), encoded_trace.data(), encoded_trace.size());
+    tail.store(t + size, std::memory_order_release);
+    return 2 * (t + size - h) >= data.size() &&
+           !drain_requested.exchange(true, std::memory_order_relaxed);
+  }
+
+  // Moves all the appended traces to *encoded_traces.
+  void Drain(std::vector<std::string>* encoded_traces) {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    const uint64_t t = tail.load(std::memory_order_acquire);
+    drain_requested.store(false, std::memory_order_relaxed);
+    while (h < t) {
+      char len[kTracePayloadLengthSize];
+      CopyOut(h, len, sizeof(len));
+      const uint32_t size = DecodeFixed32(len);
+      h += sizeof(len);
+      encoded_traces->emplace_back(size, '\0');
+      CopyOut(h, &encoded_traces->back()[0], size);
+      h += size;
+    }
+    head.store(h, std::memory_order_release);
+  }
+
+  bool Empty() const {
+    return head.load(std::memory_order_relaxed) ==
+           tail.load(std::memory_order_acquire);
+  }
+
+  void CopyIn(uint64_t pos, const char* src, size_t n) {
+    const size_t offset = static_cast<size_t>(pos % data.size());
+    const size_t first = std::min(n, data.size() - offset);
+    memcpy(&data[offset], src, first);
+    memcpy(&data[0], src + first, n - first);
+  }
+
+  void CopyOut(uint64_t pos, char* dst, size_t n) const {
+    const size_t offset = static_cast<size_t>(pos % data.size());
+    const size_t first = std::min(n, data.size() - offset);
+    memcpy(dst, &data[offset], first);
+    memcpy(dst + first, &data[0], n - first);
+  }
+
+  std::vector<char> data;
+  // Total number of bytes consumed and appended.
+  std::atomic<uint64_t> head;
+  std::atomic<uint64_t> tail;
+  std::atomic<uint64_t> dropped;
+  // Set by the producer when it woke up the drain thread.
+  std::atomic<bool> drain_requested;
+  // Set when the owning thread exited, so that the buffer can be freed once
+  // drained.
+  std::atomic<bool> abandoned;
+  // Only accessed by the owning thread.
+  SamplingState sampling;
+};
+
+namespace {
+// Interval between two drains of the thread buffers.
+const uint64_t kTraceDrainIntervalMicros = 100000;
+
+// Copies the entries on sampled keys of a write batch.
+class SampledWriteBatchBuilder : public WriteBatch::Handler {
+ public:
+  SampledWriteBatchBuilder(
+      const std::function<bool(uint32_t, const Slice&)>& is_sampled,
+      WriteBatch* sampled)
+      : is_sampled_(is_sampled), sampled_(sampled) {}
+
+  Status PutCF(uint32_t cf_id, const Slice& key, const Slice& value) override {
+    return is_sampled_(cf_id, key)
+               ? WriteBatchInternal::Put(sampled_, cf_id, key, value)
+               : Status::OK();
+  }
+  Status DeleteCF(uint32_t cf_id, const Slice& key) override {
+    return is_sampled_(cf_id, key)
+               ? WriteBatchInternal::Delete(sampled_, cf_id, key)
+               : Status::OK();
+  }
+  Status SingleDeleteCF(uint32_t cf_id, const Slice& key) override {
+    return is_sampled_(cf_id, key)
+               ? WriteBatchInternal::SingleDelete(sampled_, cf_id, key)
+               : Status::OK();
+  }
+  // Range deletions are sampled by their begin key.
+  Status DeleteRangeCF(uint32_t cf_id, const Slice& begin_key,
+                       const Slice& end_key) override {
+    return is_sampled_(cf_id, begin_key)
+               ? WriteBatchInternal::DeleteRange(sampled_, cf_id, begin_key,
+                                                 end_key)
+               : Status::OK();
+  }
+  Status MergeCF(uint32_t cf_id, const Slice& key,
+                 const Slice& value) override {
+    return is_sampled_(cf_id, key)
+               ? WriteBatchInternal::Merge(sampled_, cf_id, key, value)
+               : Status::OK();
+  }
+  Status PutBlobIndexCF(uint32_t cf_id, const Slice& key,
+                        const Slice& value) override {
+    return is_sampled_(cf_id, key)
+               ? WriteBatchInternal::PutBlobIndex(sampled_, cf_id, key, value)
+               : Status::OK();
+  }
+  // Log data and the markers of two phase commit are not traced.
+  void LogData(const Slice& /*blob*/) override {}
+  Status MarkBeginPrepare(bool /*unprepare*/) override { return Status::OK(); }
+  Status MarkEndPrepare(const Slice& /*xid*/) override { return Status::OK(); }
+  Status MarkCommit(const Slice& /*xid*/) override { return Status::OK(); }
+  Status MarkRollback(const Slice& /*xid*/) override { return Status::OK(); }
+  Status MarkNoop(bool /*empty_batch*/) override { return Status::OK(); }
+
+ private:
+  const std::function<bool(uint32_t, const Slice&)>& is_sampled_;
+  WriteBatch* sampled_;
+};
+}  // namespace
+
 Tracer::Tracer(Env* env, const TraceOptions& trace_options,
                std::unique_ptr<TraceWriter>&& trace_writer)
     : env_(env),
       trace_options_(trace_options),
       trace_writer_(std::move(trace_writer)),
-      trace_request_count_ (0) {
+      sampling_(new SamplingState()),
+      freed_dropped_count_(0),
+      over_max_(false),
+      bg_cv_(&bg_mutex_),
+      drain_requested_(false),
+      closing_(false) {
   WriteHeader();
+  if (IsBuffered()) {
+    local_buffer_.reset(new ThreadLocalPtr(&AbandonThreadBuffer));
+    bg_thread_ = port::Thread([this] { BGDrain(); });
+  }
 }
 
-Tracer::~Tracer() { trace_writer_.reset(); }
+Tracer::~Tracer() {
+  if (bg_thread_.joinable()) {
+    {
+      MutexLock l(&bg_mutex_);
+      closing_ = true;
+      bg_cv_.Signal();
+    }
+    bg_thread_.join();
+  }
+  local_buffer_.reset();
+  trace_writer_.reset();
+}
 
 Status Tracer::Write(WriteBatch* write_batch) {
   TraceType trace_type = kTraceWrite;
@@ -75,24 +332,109 @@ Status Tracer::Write(WriteBatch* write_batch) {
   Trace trace;
   trace.ts = env_->NowMicros();
   trace.type = trace_type;
-  trace.payload = write_batch->Data();
-  return WriteTrace(trace);
+  if (!IsKeySampling()) {
+    trace.payload = write_batch->Data();
+  } else {
+    WriteBatch sampled;
+    std::function<bool(uint32_t, const Slice&)> is_sampled =
+        [this](uint32_t cf_id, const Slice& key) {
+          return IsSampledKey(cf_id, key);
+        };
+    SampledWriteBatchBuilder builder(is_sampled, &sampled);
+    Status s = write_batch->Iterate(&builder);
+    if (!s.ok() || sampled.Count() == 0) {
+      return s;
+    }
+    trace.payload = sampled.Data();
+  }
+  return WriteTrace(&trace);
 }
 
 Status Tracer::Get(ColumnFamilyHandle* column_family, const Slice& key) {
   TraceType trace_type = kTraceGet;
-  if (ShouldSkipTrace(trace_type)) {
+  if (!IsSampledKey(column_family->GetID(), key) ||
+      ShouldSkipTrace(trace_type)) {
     return Status::OK();
   }
   Trace trace;
   trace.ts = env_->NowMicros();
   trace.type = trace_type;
   EncodeCFAndKey(&trace.payload, column_family->GetID(), key);
-  return WriteTrace(trace);
+  return WriteTrace(&trace);
 }
 
-Status Tracer::IteratorSeek(const uint32_t& cf_id, const Slice& key) {
+Status Tracer::MultiGet(const std::vector<ColumnFamilyHandle*>& column_families,
+                        const std::vector<Slice>& keys) {
+  assert(column_families.size() == keys.size());
+  return MultiGet(keys.size(), const_cast<ColumnFamilyHandle**>(
+                                   column_families.data()),
+                  keys.data());
+}
+
+Status Tracer::MultiGet(const size_t num_keys,
+                        ColumnFamilyHandle** column_families,
+                        const Slice* keys) {
+  TraceType trace_type = kTraceMultiGet;
+  if (ShouldSkipTrace(trace_type)) {
+    return Status::OK();
+  }
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = trace_type;
+  uint32_t num_sampled = 0;
+  PutFixed32(&trace.payload, num_sampled);
+  for (size_t i = 0; i < num_keys; ++i) {
+    uint32_t cf_id = column_families[i]->GetID();
+    if (IsSampledKey(cf_id, keys[i])) {
+      EncodeCFAndKey(&trace.payload, cf_id, keys[i]);
+      num_sampled++;
+    }
+  }
+  if (num_sampled == 0) {
+    return Status::OK();
+  }
+  EncodeFixed32(&trace.payload[0], num_sampled);
+  return WriteTrace(&trace);
+}
+
+Status Tracer::MultiGet(const size_t num_keys,
+                        ColumnFamilyHandle* column_family, const Slice* keys) {
+  TraceType trace_type = kTraceMultiGet;
+  if (ShouldSkipTrace(trace_type)) {
+    return Status::OK();
+  }
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = trace_type;
+  uint32_t cf_id = column_family->GetID();
+  uint32_t num_sampled = 0;
+  PutFixed32(&trace.payload, num_sampled);
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (IsSampledKey(cf_id, keys[i])) {
+      EncodeCFAndKey(&trace.payload, cf_id, keys[i]);
+      num_sampled++;
+    }
+  }
+  if (num_sampled == 0) {
+    return Status::OK();
+  }
+  EncodeFixed32(&trace.payload[0], num_sampled);
+  return WriteTrace(&trace);
+}
+
+Status Tracer::IteratorSeek(const uint32_t& cf_id, const Slice& key,
+                            uint64_t iter_id) {
   TraceType trace_type = kTraceIteratorSeek;
+  if (IsKeySampling()) {
+    uint64_t* slot = GetSamplingState()->IterSlot(iter_id);
+    if (!IsSampledKey(cf_id, key)) {
+      if (*slot == iter_id) {
+        *slot = 0;
+      }
+      return Status::OK();
+    }
+    *slot = iter_id;
+  }
   if (ShouldSkipTrace(trace_type)) {
     return Status::OK();
   }
@@ -100,11 +442,23 @@ Status Tracer::IteratorSeek(const uint32_t& cf_id, const Slice& key) {
   trace.ts = env_->NowMicros();
   trace.type = trace_type;
   EncodeCFAndKey(&trace.payload, cf_id, key);
-  return WriteTrace(trace);
+  PutFixed64(&trace.payload, iter_id);
+  return WriteTrace(&trace);
 }
 
-Status Tracer::IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key) {
+Status Tracer::IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
+                                   uint64_t iter_id) {
   TraceType trace_type = kTraceIteratorSeekForPrev;
+  if (IsKeySampling()) {
+    uint64_t* slot = GetSamplingState()->IterSlot(iter_id);
+    if (!IsSampledKey(cf_id, key)) {
+      if (*slot == iter_id) {
+        *slot = 0;
+      }
+      return Status::OK();
+    }
+    *slot = iter_id;
+  }
   if (ShouldSkipTrace(trace_type)) {
     return Status::OK();
   }
@@ -112,7 +466,24 @@ Status Tracer::IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key) {
   trace.ts = env_->NowMicros();
   trace.type = trace_type;
   EncodeCFAndKey(&trace.payload, cf_id, key);
-  return WriteTrace(trace);
+  PutFixed64(&trace.payload, iter_id);
+  return WriteTrace(&trace);
+}
+
+Status Tracer::IteratorNext(const uint32_t& cf_id, uint64_t iter_id) {
+  TraceType trace_type = kTraceIteratorNext;
+  if (IsKeySampling() && *GetSamplingState()->IterSlot(iter_id) != iter_id) {
+    return Status::OK();
+  }
+  if (ShouldSkipTrace(trace_type)) {
+    return Status::OK();
+  }
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = trace_type;
+  PutFixed32(&trace.payload, cf_id);
+  PutFixed64(&trace.payload, iter_id);
+  return WriteTrace(&trace);
 }
 
 bool Tracer::ShouldSkipTrace(const TraceType& trace_type) {
@@ -122,35 +493,137 @@ bool Tracer::ShouldSkipTrace(const TraceType& trace_type) {
   if ((trace_options_.filter & kTraceFilterGet
     && trace_type == kTraceGet)
    || (trace_options_.filter & kTraceFilterWrite
-    && trace_type == kTraceWrite)) {
+    && trace_type == kTraceWrite)
+   || (trace_options_.filter & kTraceFilterMultiGet
+    && trace_type == kTraceMultiGet)
+   || (trace_options_.filter & kTraceFilterIteratorNext
+    && trace_type == kTraceIteratorNext)) {
     return true;
   }
-  ++trace_request_count_;
-  if (trace_request_count_ < trace_options_.sampling_frequency) {
+  if (trace_options_.sampling_frequency <= 1) {
+    return false;
+  }
+  SamplingState* sampling = GetSamplingState();
+  ++sampling->request_count;
+  if (sampling->request_count < trace_options_.sampling_frequency) {
     return true;
   }
-  trace_request_count_ = 0;
+  sampling->request_count = 0;
   return false;
 }
 
+bool Tracer::IsSampledKey(uint32_t cf_id, const Slice& key) const {
+  const std::vector<uint32_t>& cf_ids = trace_options_.column_family_ids;
+  if (!cf_ids.empty() &&
+      std::find(cf_ids.begin(), cf_ids.end(), cf_id) == cf_ids.end()) {
+    return false;
+  }
+  return trace_options_.key_sampling_frequency <= 1 ||
+         GetSliceNPHash64(key) % trace_options_.key_sampling_frequency == 0;
+}
+
+Tracer::SamplingState* Tracer::GetSamplingState() {
+  return IsBuffered() ? &GetThreadBuffer()->sampling : sampling_.get();
+}
+
+Tracer::ThreadBuffer* Tracer::GetThreadBuffer() {
+  assert(IsBuffered());
+  void* ptr = local_buffer_->Get();
+  if (ptr != nullptr) {
+    return static_cast<ThreadBuffer*>(ptr);
+  }
+  ThreadBuffer* buffer = new ThreadBuffer(trace_options_.buffer_size);
+  {
+    MutexLock l(&buffers_mutex_);
+    buffers_.emplace_back(buffer);
+  }
+  local_buffer_->Reset(buffer);
+  return buffer;
+}
+
+void Tracer::AbandonThreadBuffer(void* ptr) {
+  static_cast<ThreadBuffer*>(ptr)->abandoned.store(true,
+                                                   std::memory_order_release);
+}
+
 bool Tracer::IsTraceFileOverMax() {
+  if (IsBuffered()) {
+    return over_max_.load(std::memory_order_relaxed);
+  }
   uint64_t trace_file_size = trace_writer_->GetFileSize();
   return (trace_file_size > trace_options_.max_trace_file_size);
 }
 
+uint64_t Tracer::GetDroppedCount() {
+  MutexLock l(&buffers_mutex_);
+  uint64_t dropped = freed_dropped_count_;
+  for (const auto& buffer : buffers_) {
+    dropped += buffer->dropped.load(std::memory_order_relaxed);
+  }
+  return dropped;
+}
+
+void Tracer::DrainBuffers() {
+  std::vector<std::string> encoded_traces;
+  {
+    MutexLock l(&buffers_mutex_);
+    size_t num_buffers = 0;
+    for (auto& buffer : buffers_) {
+      // Check before draining, so that no trace can be appended to an
+      // abandoned buffer after it was drained.
+      bool abandoned = buffer->abandoned.load(std::memory_order_acquire);
+      buffer->Drain(&encoded_traces);
+      if (abandoned) {
+        freed_dropped_count_ += buffer->dropped.load(std::memory_order_relaxed);
+      } else {
+        buffers_[num_buffers++] = std::move(buffer);
+      }
+    }
+    buffers_.resize(num_buffers);
+  }
+  // Every encoded trace starts with its fixed64 timestamp.
+  std::stable_sort(encoded_traces.begin(), encoded_traces.end(),
+                   [](const std::string& a, const std::string& b) {
+                     return DecodeFixed64(a.data()) < DecodeFixed64(b.data());
+                   });
+  for (const auto& encoded_trace : encoded_traces) {
+    if (trace_writer_->GetFileSize() > trace_options_.max_trace_file_size) {
+      break;
+    }
+    trace_writer_->Write(Slice(encoded_trace));
+  }
+  over_max_.store(
+      trace_writer_->GetFileSize() > trace_options_.max_trace_file_size,
+      std::memory_order_relaxed);
+}
+
+void Tracer::BGDrain() {
+  MutexLock l(&bg_mutex_);
+  while (!closing_) {
+    if (!drain_requested_) {
+      bg_cv_.TimedWait(Env::Default()->NowMicros() +
+                       kTraceDrainIntervalMicros);
+    }
+    drain_requested_ = false;
+    bg_mutex_.Unlock();
+    DrainBuffers();
+    bg_mutex_.Lock();
+  }
+}
+
 Status Tracer::WriteHeader() {
   std::ostringstream s;
   s << kTraceMagic << "\t"
-    << "Trace Version: 0.1\t"
+    << "Trace Version: 0.2\t"
     << "RocksDB Version: " << kMajorVersion << "." << kMinorVersion << "\t"
-    << "Format: Timestamp OpType Payload\n";
+    << "Format: Timestamp OpType Payload ThreadId\n";
   std::string header(s.str());
 
   Trace trace;
   trace.ts = env_->NowMicros();
   trace.type = kTraceBegin;
   trace.payload = header;
-  return WriteTrace(trace);
+  return WriteTraceToWriter(&trace);
 }
 
 Status Tracer::WriteFooter() {
@@ -158,16 +631,43 @@ Status Tracer::WriteFooter() {
   trace.ts = env_->NowMicros();
   trace.type = kTraceEnd;
   trace.payload = "";
-  return WriteTrace(trace);
+  return WriteTraceToWriter(&trace);
+}
+
+Status Tracer::WriteTrace(Trace* trace) {
+  if (!IsBuffered()) {
+    return WriteTraceToWriter(trace);
+  }
+  std::string encoded_trace;
+  trace->thread_id = env_->GetThreadID();
+  TracerHelper::EncodeTrace(*trace, &encoded_trace);
+  if (GetThreadBuffer()->Append(encoded_trace)) {
+    MutexLock l(&bg_mutex_);
+    drain_requested_ = true;
+    bg_cv_.Signal();
+  }
+  return Status::OK();
 }
 
-Status Tracer::WriteTrace(const Trace& trace) {
+Status Tracer::WriteTraceToWriter(Trace* trace) {
   std::string encoded_trace;
-  TracerHelper::EncodeTrace(trace, &encoded_trace);
+  trace->thread_id = env_->GetThreadID();
+  TracerHelper::EncodeTrace(*trace, &encoded_trace);
   return trace_writer_->Write(Slice(encoded_trace));
 }
 
-Status Tracer::Close() { return WriteFooter(); }
+Status Tracer::Close() {
+  if (bg_thread_.joinable()) {
+    {
+      MutexLock l(&bg_mutex_);
+      closing_ = true;
+      bg_cv_.Signal();
+    }
+    bg_thread_.join();
+    DrainBuffers();
+  }
+  return WriteFooter();
+}
 
 Replayer::Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
                    std::unique_ptr<TraceReader>&& reader)
@@ -183,9 +683,9 @@ Replayer::Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
 
 Replayer::~Replayer() { trace_reader_.reset(); }
 
-Status Replayer::SetFastForward(uint32_t fast_forward) {
+Status Replayer::SetFastForward(double fast_forward) {
   Status s;
-  if (fast_forward < 1) {
+  if (fast_forward <= 0) {
     s = Status::InvalidArgument("Wrong fast forward speed!");
   } else {
     fast_forward_ = fast_forward;
@@ -207,8 +707,7 @@ Status Replayer::Replay() {
   WriteOptions woptions;
   ReadOptions roptions;
   Trace trace;
-  uint64_t ops = 0;
-  Iterator* single_iter = nullptr;
+  std::unordered_map<uint64_t, std::unique_ptr<Iterator>> iters;
   while (s.ok()) {
     trace.reset();
     s = ReadTrace(&trace);
@@ -217,81 +716,214 @@ Status Replayer::Replay() {
     }
 
     std::this_thread::sleep_until(
-        replay_epoch +
-        std::chrono::microseconds((trace.ts - header.ts) / fast_forward_));
-    if (trace.type == kTraceWrite) {
-      WriteBatch batch(trace.payload);
-      db_->Write(woptions, &batch);
-      ops++;
-    } else if (trace.type == kTraceGet) {
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
-      }
+        replay_epoch + std::chrono::microseconds(static_cast<uint64_t>(
+                           (trace.ts - header.ts) / fast_forward_)));
+    if (trace.type == kTraceEnd) {
+      // Do nothing for now.
+      // TODO: Add some validations later.
+      break;
+    }
+    s = ExecuteTrace(trace, roptions, woptions, &iters);
+  }
 
-      std::string value;
-      if (cf_id == 0) {
-        db_->Get(roptions, key, &value);
-      } else {
-        db_->Get(roptions, cf_map_[cf_id], key, &value);
+  if (s.IsIncomplete()) {
+    // Reaching eof returns Incomplete status at the moment.
+    // Could happen when killing a process without calling EndTrace() API.
+    // TODO: Add better error handling.
+    return Status::OK();
+  }
+  return s;
+}
+
+// The traces are read sequentially and dispatched to one replay thread per
+// traced thread id. Each replay thread sleeps until the scaled timestamp of
+// its next trace, so the operations of different original threads overlap
+// as they did when traced, and a slow operation only delays the following
+// operations of the same thread.
+Status Replayer::PerThreadReplay() {
+  Status s;
+  Trace header;
+  s = ReadHeader(&header);
+  if (!s.ok()) {
+    return s;
+  }
+  for (auto& hist : latency_hists_) {
+    hist.Clear();
+  }
+
+  std::chrono::system_clock::time_point replay_epoch =
+      std::chrono::system_clock::now();
+  port::Mutex status_mu;
+  Status replay_status;
+  auto replay_thread = [&](ReplayThreadQueue* queue) {
+    WriteOptions woptions;
+    ReadOptions roptions;
+    std::unordered_map<uint64_t, std::unique_ptr<Iterator>> iters;
+    bool failed = false;
+    while (true) {
+      Trace trace;
+      {
+        MutexLock l(&queue->mu);
+        while (queue->traces.empty() && !queue->done) {
+          queue->cv.Wait();
+        }
+        if (queue->traces.empty()) {
+          break;
+        }
+        trace = std::move(queue->traces.front());
+        queue->traces.pop_front();
+        queue->cv.SignalAll();
       }
-      ops++;
-    } else if (trace.type == kTraceIteratorSeek) {
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
+      if (failed) {
+        // Keep draining the queue so that the reader is never blocked.
+        continue;
       }
-
-      if (cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
-      } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[cf_id]);
+      std::this_thread::sleep_until(
+          replay_epoch + std::chrono::microseconds(static_cast<uint64_t>(
+                             (trace.ts - header.ts) / fast_forward_)));
+      uint64_t start = env_->NowMicros();
+      Status exec_s = ExecuteTrace(trace, roptions, woptions, &iters);
+      if (trace.type < kTraceMax) {
+        latency_hists_[trace.type].Add(env_->NowMicros() - start);
       }
-      single_iter->Seek(key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceIteratorSeekForPrev) {
-      // Currently, only support to call the Seek()
-      uint32_t cf_id = 0;
-      Slice key;
-      DecodeCFAndKey(trace.payload, &cf_id, &key);
-      if (cf_id > 0 && cf_map_.find(cf_id) == cf_map_.end()) {
-        return Status::Corruption("Invalid Column Family ID.");
+      if (!exec_s.ok()) {
+        failed = true;
+        MutexLock l(&status_mu);
+        if (replay_status.ok()) {
+          replay_status = exec_s;
+        }
       }
+    }
+  };
 
-      if (cf_id == 0) {
-        single_iter = db_->NewIterator(roptions);
-      } else {
-        single_iter = db_->NewIterator(roptions, cf_map_[cf_id]);
-      }
-      single_iter->SeekForPrev(key);
-      ops++;
-      delete single_iter;
-    } else if (trace.type == kTraceEnd) {
-      // Do nothing for now.
-      // TODO: Add some validations later.
+  std::unordered_map<uint64_t, std::unique_ptr<ReplayThreadQueue>> queues;
+  std::vector<port::Thread> threads;
+  Trace trace;
+  while (s.ok()) {
+    trace.reset();
+    s = ReadTrace(&trace);
+    if (!s.ok() || trace.type == kTraceEnd) {
       break;
     }
+    if (trace.type == kTraceBegin) {
+      continue;
+    }
+    auto& queue = queues[trace.thread_id];
+    if (queue == nullptr) {
+      queue.reset(new ReplayThreadQueue());
+      threads.emplace_back(replay_thread, queue.get());
+    }
+    MutexLock l(&queue->mu);
+    while (queue->traces.size() >= ReplayThreadQueue::kMaxQueued) {
+      queue->cv.Wait();
+    }
+    queue->traces.push_back(std::move(trace));
+    queue->cv.SignalAll();
+  }
+
+  for (auto& queue : queues) {
+    MutexLock l(&queue.second->mu);
+    queue.second->done = true;
+    queue.second->cv.SignalAll();
+  }
+  for (auto& thread : threads) {
+    thread.join();
   }
 
   if (s.IsIncomplete()) {
     // Reaching eof returns Incomplete status at the moment.
     // Could happen when killing a process without calling EndTrace() API.
-    // TODO: Add better error handling.
-    return Status::OK();
+    s = Status::OK();
+  }
+  if (s.ok()) {
+    s = replay_status;
   }
   return s;
 }
 
+ColumnFamilyHandle* Replayer::GetColumnFamily(uint32_t cf_id) {
+  if (cf_id == 0) {
+    return db_->DefaultColumnFamily();
+  }
+  auto it = cf_map_.find(cf_id);
+  return it == cf_map_.end() ? nullptr : it->second;
+}
+
+Status Replayer::ExecuteTrace(
+    const Trace& trace, const ReadOptions& roptions,
+    const WriteOptions& woptions,
+    std::unordered_map<uint64_t, std::unique_ptr<Iterator>>* iters) {
+  if (trace.type == kTraceWrite) {
+    WriteBatch batch(trace.payload);
+    db_->Write(woptions, &batch);
+  } else if (trace.type == kTraceGet) {
+    uint32_t cf_id = 0;
+    Slice key;
+    DecodeCFAndKey(trace.payload, &cf_id, &key);
+    ColumnFamilyHandle* cfh = GetColumnFamily(cf_id);
+    if (cfh == nullptr) {
+      return Status::Corruption("Invalid Column Family ID.");
+    }
+
+    std::string value;
+    db_->Get(roptions, cfh, key, &value);
+  } else if (trace.type == kTraceMultiGet) {
+    std::vector<uint32_t> cf_ids;
+    std::vector<Slice> keys;
+    Status s = DecodeMultiGet(trace.payload, &cf_ids, &keys);
+    if (!s.ok()) {
+      return s;
+    }
+    std::vector<ColumnFamilyHandle*> handles(cf_ids.size());
+    for (size_t i = 0; i < cf_ids.size(); ++i) {
+      handles[i] = GetColumnFamily(cf_ids[i]);
+      if (handles[i] == nullptr) {
+        return Status::Corruption("Invalid Column Family ID.");
+      }
+    }
+
+    std::vector<std::string> values;
+    db_->MultiGet(roptions, handles, keys, &values);
+  } else if (trace.type == kTraceIteratorSeek ||
+             trace.type == kTraceIteratorSeekForPrev) {
+    uint32_t cf_id = 0;
+    Slice key;
+    uint64_t iter_id = 0;
+    DecodeIteratorTrace(trace.payload, &cf_id, &key, &iter_id);
+    ColumnFamilyHandle* cfh = GetColumnFamily(cf_id);
+    if (cfh == nullptr) {
+      return Status::Corruption("Invalid Column Family ID.");
+    }
+
+    // Each traced seek gets a new iterator, as the traced iterator id may
+    // have been reused by an iterator created after the previous seek.
+    std::unique_ptr<Iterator>& iter = (*iters)[iter_id];
+    iter.reset(db_->NewIterator(roptions, cfh));
+    if (trace.type == kTraceIteratorSeek) {
+      iter->Seek(key);
+    } else {
+      iter->SeekForPrev(key);
+    }
+  } else if (trace.type == kTraceIteratorNext) {
+    uint32_t cf_id = 0;
+    uint64_t iter_id = 0;
+    DecodeIteratorTrace(trace.payload, &cf_id, nullptr, &iter_id);
+    auto it = iters->find(iter_id);
+    // The seek of the iterator may have been filtered out or sampled away.
+    if (it != iters->end() && it->second->Valid()) {
+      it->second->Next();
+    }
+  }
+  // Other trace entry types are not replayed.
+  return Status::OK();
+}
+
 // The trace can be replayed with multithread by configurnge the number of
 // threads in the thread pool. Trace records are read from the trace file
 // sequentially and the corresponding queries are scheduled in the task
 // queue based on the timestamp. Currently, we support Write_batch (Put,
-// Delete, SingleDelete, DeleteRange), Get, Iterator (Seek and SeekForPrev).
+// Delete, SingleDelete, DeleteRange), Get, MultiGet, Iterator (Seek and
+// SeekForPrev).
 Status Replayer::MultiThreadReplay(uint32_t threads_num) {
   Status s;
   Trace header;
@@ -326,8 +958,9 @@ Status Replayer::MultiThreadReplay(uint32_t threads_num) {
     ra->roptions = roptions;
 
     std::this_thread::sleep_until(
-        replay_epoch + std::chrono::microseconds(
-                           (ra->trace_entry.ts - header.ts) / fast_forward_));
+        replay_epoch +
+        std::chrono::microseconds(static_cast<uint64_t>(
+            (ra->trace_entry.ts - header.ts) / fast_forward_)));
     if (ra->trace_entry.type == kTraceWrite) {
       thread_pool.Schedule(&Replayer::BGWorkWriteBatch, ra.release(), nullptr,
                            nullptr);
@@ -344,6 +977,10 @@ Status Replayer::MultiThreadReplay(uint32_t threads_num) {
       thread_pool.Schedule(&Replayer::BGWorkIterSeekForPrev, ra.release(),
                            nullptr, nullptr);
       ops++;
+    } else if (ra->trace_entry.type == kTraceMultiGet) {
+      thread_pool.Schedule(&Replayer::BGWorkMultiGet, ra.release(), nullptr,
+                           nullptr);
+      ops++;
     } else if (ra->trace_entry.type == kTraceEnd) {
       // Do nothing for now.
       // TODO: Add some validations later.
@@ -487,4 +1124,31 @@ void Replayer::BGWorkIterSeekForPrev(void* arg) {
   return;
 }
 
+void Replayer::BGWorkMultiGet(void* arg) {
+  std::unique_ptr<ReplayerWorkerArg> ra(
+      reinterpret_cast<ReplayerWorkerArg*>(arg));
+  assert(ra != nullptr);
+  auto cf_map = static_cast<std::unordered_map<uint32_t, ColumnFamilyHandle*>*>(
+      ra->cf_map);
+  std::vector<uint32_t> cf_ids;
+  std::vector<Slice> keys;
+  if (!DecodeMultiGet(ra->trace_entry.payload, &cf_ids, &keys).ok()) {
+    return;
+  }
+  std::vector<ColumnFamilyHandle*> handles(cf_ids.size());
+  for (size_t i = 0; i < cf_ids.size(); ++i) {
+    if (cf_ids[i] == 0) {
+      handles[i] = ra->db->DefaultColumnFamily();
+    } else if (cf_map->find(cf_ids[i]) != cf_map->end()) {
+      handles[i] = (*cf_map)[cf_ids[i]];
+    } else {
+      return;
+    }
+  }
+
+  std::vector<std::string> values;
+  ra->db->MultiGet(ra->roptions, handles, keys, &values);
+  return;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -5,10 +5,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "monitoring/histogram.h"
+#include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/trace_reader_writer.h"
@@ -22,7 +26,9 @@ class ColumnFamilyHandle;
 class ColumnFamilyData;
 class DB;
 class DBImpl;
+class Iterator;
 class Slice;
+class ThreadLocalPtr;
 class WriteBatch;
 
 extern const std::string kTraceMagic;
@@ -31,6 +37,9 @@ const unsigned int kTraceTypeSize = 1;
 const unsigned int kTracePayloadLengthSize = 4;
 const unsigned int kTraceMetadataSize =
     kTraceTimestampSize + kTraceTypeSize + kTracePayloadLengthSize;
+// Set in the encoded type of the traces followed by the id of the thread that
+// issued them. The thread id is counted in the encoded payload length.
+const unsigned char kTraceThreadIdFlag = 0x80;
 
 // Supported Trace types.
 enum TraceType : char {
@@ -52,6 +61,9 @@ enum TraceType : char {
   kIOFileNameAndFileSize = 14,
   kIOLen = 15,
   kIOLenAndOffset = 16,
+  // Query related types added in trace version 0.2.
+  kTraceMultiGet = 17,
+  kTraceIteratorNext = 18,
   // All trace types should be added before kTraceMax
   kTraceMax,
 };
@@ -64,11 +76,15 @@ struct Trace {
   uint64_t ts;  // timestamp
   TraceType type;
   std::string payload;
+  // Id of the thread that issued the traced operation, or 0 if unknown.
+  // Recorded since trace version 0.2.
+  uint64_t thread_id = 0;
 
   void reset() {
     ts = 0;
     type = kTraceMax;
     payload.clear();
+    thread_id = 0;
   }
 };
 
@@ -84,6 +100,11 @@ class TracerHelper {
 // Tracer captures all RocksDB operations using a user-provided TraceWriter.
 // Every RocksDB operation is written as a single trace. Each trace will have a
 // timestamp and type, followed by the trace payload.
+//
+// Unless TraceOptions::buffer_size is set, the callers must serialize the
+// calls to a Tracer. In buffered mode, the traces are appended to a lock-free
+// buffer of the calling thread, and Tracer may be called concurrently except
+// for Close().
 class Tracer {
  public:
   Tracer(Env* env, const TraceOptions& trace_options,
@@ -96,18 +117,40 @@ class Tracer {
   // Trace Get operations.
   Status Get(ColumnFamilyHandle* cfname, const Slice& key);
 
-  // Trace Iterators.
-  Status IteratorSeek(const uint32_t& cf_id, const Slice& key);
-  Status IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key);
+  // Trace MultiGet operations.
+  Status MultiGet(const std::vector<ColumnFamilyHandle*>& column_families,
+                  const std::vector<Slice>& keys);
+  Status MultiGet(const size_t num_keys, ColumnFamilyHandle** column_families,
+                  const Slice* keys);
+  Status MultiGet(const size_t num_keys, ColumnFamilyHandle* column_family,
+                  const Slice* keys);
+
+  // Trace Iterators. iter_id identifies the iterator, so that its Next()
+  // calls can be matched with the seek that positioned it.
+  Status IteratorSeek(const uint32_t& cf_id, const Slice& key,
+                      uint64_t iter_id);
+  Status IteratorSeekForPrev(const uint32_t& cf_id, const Slice& key,
+                             uint64_t iter_id);
+  Status IteratorNext(const uint32_t& cf_id, uint64_t iter_id);
 
   // Returns true if the trace is over the configured max trace file limit.
   // False otherwise.
   bool IsTraceFileOverMax();
 
-  // Writes a trace footer at the end of the tracing
+  // Returns true if the traces are buffered per thread, in which case the
+  // Tracer can be called without synchronization.
+  bool IsBuffered() const { return trace_options_.buffer_size > 0; }
+
+  // Number of traces dropped because the buffer of their thread was full.
+  uint64_t GetDroppedCount();
+
+  // Writes the buffered traces and a trace footer at the end of the tracing
   Status Close();
 
  private:
+  struct SamplingState;
+  struct ThreadBuffer;
+
   // Write a trace header at the beginning, typically on initiating a trace,
   // with some metadata like a magic number, trace version, RocksDB version, and
   // trace format.
@@ -117,17 +160,66 @@ class Tracer {
   Status WriteFooter();
 
   // Write a single trace using the provided TraceWriter to the underlying
-  // system, say, a filesystem or a streaming service.
-  Status WriteTrace(const Trace& trace);
+  // system, say, a filesystem or a streaming service, or to the buffer of the
+  // calling thread in buffered mode. The id of the calling thread is recorded
+  // in the trace.
+  Status WriteTrace(Trace* trace);
+
+  // Write a single trace to the TraceWriter, bypassing the buffers.
+  Status WriteTraceToWriter(Trace* trace);
 
   // Helps in filtering and sampling of traces.
   // Returns true if a trace should be skipped, false otherwise.
   bool ShouldSkipTrace(const TraceType& type);
 
+  // Returns true if the operations on the given key of the given column
+  // family are traced according to the key and column family sampling.
+  bool IsSampledKey(uint32_t cf_id, const Slice& key) const;
+
+  // Returns true if some traces are left out by key or column family.
+  bool IsKeySampling() const {
+    return trace_options_.key_sampling_frequency > 1 ||
+           !trace_options_.column_family_ids.empty();
+  }
+
+  // The sampling state of the calling thread in buffered mode, or the one of
+  // the Tracer otherwise.
+  SamplingState* GetSamplingState();
+
+  // The buffer of the calling thread, created on its first trace.
+  ThreadBuffer* GetThreadBuffer();
+
+  // Marks the buffer of an exited thread to be freed once drained.
+  static void AbandonThreadBuffer(void* ptr);
+
+  // Moves the traces of all thread buffers to the TraceWriter, in timestamp
+  // order, and frees the buffers of the exited threads.
+  void DrainBuffers();
+
+  // The function of the thread that drains the buffers in buffered mode.
+  void BGDrain();
+
   Env* env_;
   TraceOptions trace_options_;
   std::unique_ptr<TraceWriter> trace_writer_;
-  uint64_t trace_request_count_;
+  std::unique_ptr<SamplingState> sampling_;
+
+  // The following are only used in buffered mode.
+  port::Mutex buffers_mutex_;
+  // All the thread buffers. Protected by buffers_mutex_.
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  // Dropped traces of the freed buffers. Protected by buffers_mutex_.
+  uint64_t freed_dropped_count_;
+  // Holds the ThreadBuffer of each thread. Declared after buffers_ so that the
+  // buffers outlive it.
+  std::unique_ptr<ThreadLocalPtr> local_buffer_;
+  std::atomic<bool> over_max_;
+  port::Mutex bg_mutex_;
+  port::CondVar bg_cv_;
+  // Protected by bg_mutex_.
+  bool drain_requested_;
+  bool closing_;
+  port::Thread bg_thread_;
 };
 
 // Replayer helps to replay the captured RocksDB operations, using a user
@@ -148,18 +240,45 @@ class Replayer {
   // User can set the number of threads in the thread pool.
   Status MultiThreadReplay(uint32_t threads_num);
 
+  // Replay the provided trace stream with one thread per thread that issued
+  // the traced operations. The operations of each original thread are
+  // executed in their original order, each at its scaled offset from the
+  // start of the trace, and their latency is recorded per trace type (see
+  // GetLatencyHistogram()). Traces written before version 0.2 do not record
+  // thread ids and are replayed by a single thread.
+  Status PerThreadReplay();
+
   // Enables fast forwarding a replay by reducing the delay between the ingested
   // traces.
   // fast_forward : Rate of replay speedup.
   //   If 1, replay the operations at the same rate as in the trace stream.
   //   If > 1, speed up the replay by this amount.
-  Status SetFastForward(uint32_t fast_forward);
+  //   If < 1, slow down the replay by this amount.
+  Status SetFastForward(double fast_forward);
+
+  // Latency in microseconds of the operations of the given type executed by
+  // PerThreadReplay().
+  const HistogramImpl& GetLatencyHistogram(TraceType type) const {
+    return latency_hists_[type];
+  }
 
  private:
   Status ReadHeader(Trace* header);
   Status ReadFooter(Trace* footer);
   Status ReadTrace(Trace* trace);
 
+  // Returns the handle of the traced column family, or nullptr if it is not
+  // one of the handles given to the Replayer.
+  ColumnFamilyHandle* GetColumnFamily(uint32_t cf_id);
+
+  // Executes a single traced operation. The iterators positioned by seeks are
+  // kept in *iters, keyed by the traced iterator id, so that the following
+  // Next() calls of the same iterator can be replayed on them.
+  Status ExecuteTrace(
+      const Trace& trace, const ReadOptions& roptions,
+      const WriteOptions& woptions,
+      std::unordered_map<uint64_t, std::unique_ptr<Iterator>>* iters);
+
   // The background function for MultiThreadReplay to execute Get query
   // based on the trace records.
   static void BGWorkGet(void* arg);
@@ -176,11 +295,16 @@ class Replayer {
   // (SeekForPrev) based on the trace records.
   static void BGWorkIterSeekForPrev(void* arg);
 
+  // The background function for MultiThreadReplay to execute MultiGet based
+  // on the trace records.
+  static void BGWorkMultiGet(void* arg);
+
   DBImpl* db_;
   Env* env_;
   std::unique_ptr<TraceReader> trace_reader_;
   std::unordered_map<uint32_t, ColumnFamilyHandle*> cf_map_;
-  uint32_t fast_forward_;
+  double fast_forward_;
+  HistogramImpl latency_hists_[kTraceMax];
 };
 
 // The passin arg of MultiThreadRepkay for each trace record.
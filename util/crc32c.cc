@@ -1252,6 +1252,66 @@ uint32_t Extend(uint32_t crc, const char* buf, size_t size) {
   return ChosenExtend(crc, buf, size);
 }
 
+// Crc32cCombine() appends crc2len zero bytes to crc1 by multiplying it with
+// the matrix of the CRC shift operator over GF(2), squaring the operator for
+// every bit of crc2len, as in zlib's crc32_combine().
+namespace {
+uint32_t GF2MatrixTimes(const uint32_t* mat, uint32_t vec) {
+  uint32_t sum = 0;
+  while (vec) {
+    if (vec & 1) {
+      sum ^= *mat;
+    }
+    vec >>= 1;
+    mat++;
+  }
+  return sum;
+}
+
+void GF2MatrixSquare(uint32_t* square, const uint32_t* mat) {
+  for (int n = 0; n < 32; n++) {
+    square[n] = GF2MatrixTimes(mat, mat[n]);
+  }
+}
+}  // namespace
+
+uint32_t Crc32cCombine(uint32_t crc1, uint32_t crc2, size_t crc2len) {
+  if (crc2len == 0) {
+    return crc1;
+  }
+  uint32_t even[32];  // even-power-of-two zeros operator
+  uint32_t odd[32];   // odd-power-of-two zeros operator
+
+  // Operator for one zero bit, reflected CRC-32C polynomial.
+  odd[0] = 0x82f63b78u;
+  uint32_t row = 1;
+  for (int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+  GF2MatrixSquare(even, odd);  // two zero bits
+  GF2MatrixSquare(odd, even);  // four zero bits
+
+  // Apply crc2len zero bytes to crc1. The first square below puts the
+  // operator for one zero byte, eight zero bits, in even.
+  do {
+    GF2MatrixSquare(even, odd);
+    if (crc2len & 1) {
+      crc1 = GF2MatrixTimes(even, crc1);
+    }
+    crc2len >>= 1;
+    if (crc2len == 0) {
+      break;
+    }
+    GF2MatrixSquare(odd, even);
+    if (crc2len & 1) {
+      crc1 = GF2MatrixTimes(odd, crc1);
+    }
+    crc2len >>= 1;
+  } while (crc2len != 0);
+  return crc1 ^ crc2;
+}
+
 
 }  // namespace crc32c
 }  // namespace ROCKSDB_NAMESPACE
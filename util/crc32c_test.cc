@@ -129,6 +129,24 @@ TEST(CRC, Extend) {
             Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, Combine) {
+  ASSERT_EQ(Value("hello world", 11),
+            Crc32cCombine(Value("hello ", 6), Value("world", 5), 5));
+  ASSERT_EQ(Value("hello", 5), Crc32cCombine(Value("hello", 5), 0, 0));
+
+  std::string data(100000, '\0');
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>(i * 7 + 13);
+  }
+  const uint32_t expected = Value(data.data(), data.size());
+  for (size_t split : {size_t{1}, size_t{4095}, size_t{65536}, size_t{99999}}) {
+    ASSERT_EQ(expected,
+              Crc32cCombine(Value(data.data(), split),
+                            Value(data.data() + split, data.size() - split),
+                            data.size() - split));
+  }
+}
+
 TEST(CRC, Mask) {
   uint32_t crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
@@ -33,12 +33,22 @@ size_t RateLimiter::RequestToken(size_t bytes, size_t alignment,
   return bytes;
 }
 
+namespace {
+// Number of refill periods between two calls to Tune().
+const int kRefillsPerTune = 100;
+}  // namespace
+
 // Pending request
 struct GenericRateLimiter::Req {
-  explicit Req(int64_t _bytes, port::Mutex* _mu)
-      : request_bytes(_bytes), bytes(_bytes), cv(_mu), granted(false) {}
+  explicit Req(int64_t _bytes, Env::IOPriority _pri, port::Mutex* _mu)
+      : request_bytes(_bytes),
+        bytes(_bytes),
+        pri(_pri),
+        cv(_mu),
+        granted(false) {}
   int64_t request_bytes;
   int64_t bytes;
+  Env::IOPriority pri;
   port::CondVar cv;
   bool granted;
 };
@@ -66,23 +76,24 @@ GenericRateLimiter::GenericRateLimiter(int64_t rate_bytes_per_sec,
       num_drains_(0),
       prev_num_drains_(0),
       max_bytes_per_sec_(rate_bytes_per_sec),
-      tuned_time_(NowMicrosMonotonic(env_)) {
-  total_requests_[0] = 0;
-  total_requests_[1] = 0;
-  total_bytes_through_[0] = 0;
-  total_bytes_through_[1] = 0;
+      tuned_time_(NowMicrosMonotonic(env_)),
+      next_tune_us_(tuned_time_.count() + kRefillsPerTune * refill_period_us) {
+  for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+    total_requests_[i].store(0, std::memory_order_relaxed);
+    total_bytes_through_[i].store(0, std::memory_order_relaxed);
+    num_waiters_[i].store(0, std::memory_order_relaxed);
+  }
 }
 
 GenericRateLimiter::~GenericRateLimiter() {
   MutexLock g(&request_mutex_);
   stop_ = true;
-  requests_to_wait_ = static_cast<int32_t>(queue_[Env::IO_LOW].size() +
-                                           queue_[Env::IO_HIGH].size());
-  for (auto& r : queue_[Env::IO_HIGH]) {
-    r->cv.Signal();
-  }
-  for (auto& r : queue_[Env::IO_LOW]) {
-    r->cv.Signal();
+  requests_to_wait_ = 0;
+  for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+    requests_to_wait_ += static_cast<int32_t>(queue_[i].size());
+    for (auto& r : queue_[i]) {
+      r->cv.Signal();
+    }
   }
   while (requests_to_wait_ > 0) {
     exit_cv_.Wait();
@@ -98,16 +109,55 @@ void GenericRateLimiter::SetBytesPerSecond(int64_t bytes_per_second) {
       std::memory_order_relaxed);
 }
 
+bool GenericRateLimiter::TryRequestWithoutWaiting(int64_t bytes,
+                                                  Env::IOPriority pri) {
+  if (auto_tuned_ && static_cast<int64_t>(NowMicrosMonotonic(env_)) >=
+                         next_tune_us_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  // Waiting requests of the same or a higher priority go first.
+  for (int i = pri; i < Env::IO_TOTAL; ++i) {
+    if (num_waiters_[i].load(std::memory_order_acquire) > 0) {
+      return false;
+    }
+  }
+  int64_t available = available_bytes_.load(std::memory_order_relaxed);
+  while (available >= bytes) {
+    if (available_bytes_.compare_exchange_weak(available, available - bytes,
+                                               std::memory_order_relaxed)) {
+      total_requests_[pri].fetch_add(1, std::memory_order_relaxed);
+      total_bytes_through_[pri].fetch_add(bytes, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+int64_t GenericRateLimiter::TakeAvailableBytes(int64_t bytes) {
+  int64_t available = available_bytes_.load(std::memory_order_relaxed);
+  int64_t taken;
+  do {
+    taken = std::max<int64_t>(std::min(available, bytes), 0);
+  } while (taken > 0 &&
+           !available_bytes_.compare_exchange_weak(
+               available, available - taken, std::memory_order_relaxed));
+  return taken;
+}
+
 void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
                                  Statistics* stats) {
   assert(bytes <= refill_bytes_per_period_.load(std::memory_order_relaxed));
+  assert(pri < Env::IO_TOTAL);
   TEST_SYNC_POINT("GenericRateLimiter::Request");
   TEST_SYNC_POINT_CALLBACK("GenericRateLimiter::Request:1",
                            &rate_bytes_per_sec_);
+  if (TryRequestWithoutWaiting(bytes, pri)) {
+    return;
+  }
+
   MutexLock g(&request_mutex_);
 
   if (auto_tuned_) {
-    static const int kRefillsPerTune = 100;
     std::chrono::microseconds now(NowMicrosMonotonic(env_));
     if (now - tuned_time_ >=
         kRefillsPerTune * std::chrono::microseconds(refill_period_us_)) {
@@ -119,20 +169,30 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
     return;
   }
 
-  ++total_requests_[pri];
+  total_requests_[pri].fetch_add(1, std::memory_order_relaxed);
 
-  if (available_bytes_ >= bytes) {
+  bool higher_pri_waiting = false;
+  for (int i = pri; i < Env::IO_TOTAL; ++i) {
+    higher_pri_waiting = higher_pri_waiting || !queue_[i].empty();
+  }
+  if (!higher_pri_waiting) {
     // Refill thread assigns quota and notifies requests waiting on
     // the queue under mutex. So if we get here, that means nobody
     // is waiting?
-    available_bytes_ -= bytes;
-    total_bytes_through_[pri] += bytes;
-    return;
+    int64_t available = available_bytes_.load(std::memory_order_relaxed);
+    while (available >= bytes) {
+      if (available_bytes_.compare_exchange_weak(
+              available, available - bytes, std::memory_order_relaxed)) {
+        total_bytes_through_[pri].fetch_add(bytes, std::memory_order_relaxed);
+        return;
+      }
+    }
   }
 
   // Request cannot be satisfied at this moment, enqueue
-  Req r(bytes, &request_mutex_);
+  Req r(bytes, pri, &request_mutex_);
   queue_[pri].push_back(&r);
+  num_waiters_[pri].fetch_add(1, std::memory_order_release);
 
   do {
     bool timedout = false;
@@ -142,11 +202,7 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
     //     to lower priority
     // (3) a previous waiter at the front of queue, who got notified by
     //     previous leader
-    if (leader_ == nullptr &&
-        ((!queue_[Env::IO_HIGH].empty() &&
-            &r == queue_[Env::IO_HIGH].front()) ||
-         (!queue_[Env::IO_LOW].empty() &&
-            &r == queue_[Env::IO_LOW].front()))) {
+    if (leader_ == nullptr && &r == queue_[pri].front()) {
       leader_ = &r;
       int64_t delta = next_refill_us_ - NowMicrosMonotonic(env_);
       delta = delta > 0 ? delta : 0;
@@ -171,16 +227,8 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
     }
 
     // Make sure the waken up request is always the header of its queue
-    assert(r.granted ||
-           (!queue_[Env::IO_HIGH].empty() &&
-            &r == queue_[Env::IO_HIGH].front()) ||
-           (!queue_[Env::IO_LOW].empty() &&
-            &r == queue_[Env::IO_LOW].front()));
-    assert(leader_ == nullptr ||
-           (!queue_[Env::IO_HIGH].empty() &&
-            leader_ == queue_[Env::IO_HIGH].front()) ||
-           (!queue_[Env::IO_LOW].empty() &&
-            leader_ == queue_[Env::IO_LOW].front()));
+    assert(r.granted || &r == queue_[pri].front());
+    assert(leader_ == nullptr || leader_ == queue_[leader_->pri].front());
 
     if (leader_ == &r) {
       // Waken up from TimedWait()
@@ -196,14 +244,10 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
         if (r.granted) {
           // Current leader already got granted with quota. Notify header
           // of waiting queue to participate next round of election.
-          assert((queue_[Env::IO_HIGH].empty() ||
-                    &r != queue_[Env::IO_HIGH].front()) &&
-                 (queue_[Env::IO_LOW].empty() ||
-                    &r != queue_[Env::IO_LOW].front()));
-          if (!queue_[Env::IO_HIGH].empty()) {
-            queue_[Env::IO_HIGH].front()->cv.Signal();
-          } else if (!queue_[Env::IO_LOW].empty()) {
-            queue_[Env::IO_LOW].front()->cv.Signal();
+          assert(queue_[pri].empty() || &r != queue_[pri].front());
+          Req* next_leader = HighestPriorityWaiter();
+          if (next_leader != nullptr) {
+            next_leader->cv.Signal();
           }
           // Done
           break;
@@ -226,32 +270,65 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri,
   } while (!r.granted);
 }
 
+GenericRateLimiter::Req* GenericRateLimiter::HighestPriorityWaiter() const {
+  for (int i = Env::IO_TOTAL - 1; i >= Env::IO_LOW; --i) {
+    if (!queue_[i].empty()) {
+      return queue_[i].front();
+    }
+  }
+  return nullptr;
+}
+
+void GenericRateLimiter::GeneratePriorityIterationOrder(
+    Env::IOPriority* pri_order) {
+  // User reads are always served first. Flushes are served after both
+  // compaction priorities one time in fairness_, and so are L0 compactions
+  // after the other compactions, so that no priority is starved.
+  bool high_pri_last = rnd_.OneIn(fairness_);
+  bool mid_pri_last = rnd_.OneIn(fairness_);
+  Env::IOPriority first_compaction_pri =
+      mid_pri_last ? Env::IO_LOW : Env::IO_MID;
+  Env::IOPriority second_compaction_pri =
+      mid_pri_last ? Env::IO_MID : Env::IO_LOW;
+  pri_order[0] = Env::IO_USER;
+  if (high_pri_last) {
+    pri_order[1] = first_compaction_pri;
+    pri_order[2] = second_compaction_pri;
+    pri_order[3] = Env::IO_HIGH;
+  } else {
+    pri_order[1] = Env::IO_HIGH;
+    pri_order[2] = first_compaction_pri;
+    pri_order[3] = second_compaction_pri;
+  }
+}
+
 void GenericRateLimiter::Refill() {
   TEST_SYNC_POINT("GenericRateLimiter::Refill");
   next_refill_us_ = NowMicrosMonotonic(env_) + refill_period_us_;
   // Carry over the left over quota from the last period
   auto refill_bytes_per_period =
       refill_bytes_per_period_.load(std::memory_order_relaxed);
-  if (available_bytes_ < refill_bytes_per_period) {
-    available_bytes_ += refill_bytes_per_period;
+  if (available_bytes_.load(std::memory_order_relaxed) <
+      refill_bytes_per_period) {
+    available_bytes_.fetch_add(refill_bytes_per_period,
+                               std::memory_order_relaxed);
   }
 
-  int use_low_pri_first = rnd_.OneIn(fairness_) ? 0 : 1;
-  for (int q = 0; q < 2; ++q) {
-    auto use_pri = (use_low_pri_first == q) ? Env::IO_LOW : Env::IO_HIGH;
+  Env::IOPriority pri_order[Env::IO_TOTAL];
+  GeneratePriorityIterationOrder(pri_order);
+  for (auto use_pri : pri_order) {
     auto* queue = &queue_[use_pri];
     while (!queue->empty()) {
       auto* next_req = queue->front();
-      if (available_bytes_ < next_req->request_bytes) {
-        // avoid starvation
-        next_req->request_bytes -= available_bytes_;
-        available_bytes_ = 0;
+      // avoid starvation by taking what is left for a larger request
+      next_req->request_bytes -= TakeAvailableBytes(next_req->request_bytes);
+      if (next_req->request_bytes > 0) {
         break;
       }
-      available_bytes_ -= next_req->request_bytes;
-      next_req->request_bytes = 0;
-      total_bytes_through_[use_pri] += next_req->bytes;
+      total_bytes_through_[use_pri].fetch_add(next_req->bytes,
+                                              std::memory_order_relaxed);
       queue->pop_front();
+      num_waiters_[use_pri].fetch_sub(1, std::memory_order_release);
 
       next_req->granted = true;
       if (next_req != leader_) {
@@ -321,6 +398,9 @@ Status GenericRateLimiter::Tune() {
     SetBytesPerSecond(new_bytes_per_sec);
   }
   num_drains_ = prev_num_drains_;
+  next_tune_us_.store(
+      tuned_time_.count() + kRefillsPerTune * refill_period_us_,
+      std::memory_order_relaxed);
   return Status::OK();
 }
 
@@ -21,6 +21,11 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+// A token bucket refilled every refill_period_us. A request takes tokens
+// with a compare-and-swap, without locking, as long as enough are available
+// and no request of the same or a higher priority is waiting. Otherwise it
+// waits in the queue of its priority, and a leader among the waiters refills
+// the bucket and hands the tokens to the queues under request_mutex_.
 class GenericRateLimiter : public RateLimiter {
  public:
   GenericRateLimiter(int64_t refill_bytes, int64_t refill_period_us,
@@ -45,21 +50,26 @@ class GenericRateLimiter : public RateLimiter {
 
   virtual int64_t GetTotalBytesThrough(
       const Env::IOPriority pri = Env::IO_TOTAL) const override {
-    MutexLock g(&request_mutex_);
     if (pri == Env::IO_TOTAL) {
-      return total_bytes_through_[Env::IO_LOW] +
-             total_bytes_through_[Env::IO_HIGH];
+      int64_t total = 0;
+      for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+        total += total_bytes_through_[i].load(std::memory_order_relaxed);
+      }
+      return total;
     }
-    return total_bytes_through_[pri];
+    return total_bytes_through_[pri].load(std::memory_order_relaxed);
   }
 
   virtual int64_t GetTotalRequests(
       const Env::IOPriority pri = Env::IO_TOTAL) const override {
-    MutexLock g(&request_mutex_);
     if (pri == Env::IO_TOTAL) {
-      return total_requests_[Env::IO_LOW] + total_requests_[Env::IO_HIGH];
+      int64_t total = 0;
+      for (int i = Env::IO_LOW; i < Env::IO_TOTAL; ++i) {
+        total += total_requests_[i].load(std::memory_order_relaxed);
+      }
+      return total;
     }
-    return total_requests_[pri];
+    return total_requests_[pri].load(std::memory_order_relaxed);
   }
 
   virtual int64_t GetBytesPerSecond() const override {
@@ -67,6 +77,17 @@ class GenericRateLimiter : public RateLimiter {
   }
 
  private:
+  // Takes bytes from available_bytes_ if enough are available and no request
+  // of priority pri or higher is waiting.
+  bool TryRequestWithoutWaiting(int64_t bytes, Env::IOPriority pri);
+  // Takes up to bytes from available_bytes_, and returns how many it took.
+  int64_t TakeAvailableBytes(int64_t bytes);
+  // Fills pri_order with the priorities in the order Refill() serves them.
+  void GeneratePriorityIterationOrder(Env::IOPriority* pri_order);
+  // Returns the first request of the highest priority non-empty queue, or
+  // nullptr if all queues are empty.
+  struct Req;
+  Req* HighestPriorityWaiter() const;
   void Refill();
   int64_t CalculateRefillBytesPerPeriod(int64_t rate_bytes_per_sec);
   Status Tune();
@@ -75,7 +96,7 @@ class GenericRateLimiter : public RateLimiter {
     return env->NowNanos() / std::milli::den;
   }
 
-  // This mutex guard all internal states
+  // This mutex guard all internal states, except for the atomics below.
   mutable port::Mutex request_mutex_;
 
   const int64_t kMinRefillBytesPerPeriod = 100;
@@ -91,15 +112,19 @@ class GenericRateLimiter : public RateLimiter {
   port::CondVar exit_cv_;
   int32_t requests_to_wait_;
 
-  int64_t total_requests_[Env::IO_TOTAL];
-  int64_t total_bytes_through_[Env::IO_TOTAL];
-  int64_t available_bytes_;
+  std::atomic<int64_t> total_requests_[Env::IO_TOTAL];
+  std::atomic<int64_t> total_bytes_through_[Env::IO_TOTAL];
+  // Taken by requests on the fast path without request_mutex_. Only added to
+  // under request_mutex_.
+  std::atomic<int64_t> available_bytes_;
+  // Number of requests in queue_[pri]. Read without request_mutex_ by the
+  // fast path.
+  std::atomic<int32_t> num_waiters_[Env::IO_TOTAL];
   int64_t next_refill_us_;
 
   int32_t fairness_;
   Random rnd_;
 
-  struct Req;
   Req* leader_;
   std::deque<Req*> queue_[Env::IO_TOTAL];
 
@@ -108,6 +133,9 @@ class GenericRateLimiter : public RateLimiter {
   int64_t prev_num_drains_;
   const int64_t max_bytes_per_sec_;
   std::chrono::microseconds tuned_time_;
+  // Requests take the slow path once this time is reached, so that Tune()
+  // runs.
+  std::atomic<int64_t> next_tune_us_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
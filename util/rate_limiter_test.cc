@@ -12,6 +12,7 @@
 #include <chrono>
 #include <cinttypes>
 #include <limits>
+#include <thread>
 
 #include "db/db_test_util.h"
 #include "rocksdb/env.h"
@@ -59,6 +60,54 @@ TEST_F(RateLimiterTest, Modes) {
   }
 }
 
+TEST_F(RateLimiterTest, Priorities) {
+  GenericRateLimiter limiter(
+      1 << 30 /* rate_bytes_per_sec */, 100 * 1000 /* refill_period_us */,
+      10 /* fairness */, RateLimiter::Mode::kAllIo, Env::Default(),
+      false /* auto_tuned */);
+  int64_t bytes = 1;
+  for (auto pri : {Env::IO_LOW, Env::IO_MID, Env::IO_HIGH, Env::IO_USER}) {
+    limiter.Request(bytes, pri, nullptr /* stats */,
+                    RateLimiter::OpType::kRead);
+    bytes *= 10;
+  }
+  ASSERT_EQ(1, limiter.GetTotalBytesThrough(Env::IO_LOW));
+  ASSERT_EQ(10, limiter.GetTotalBytesThrough(Env::IO_MID));
+  ASSERT_EQ(100, limiter.GetTotalBytesThrough(Env::IO_HIGH));
+  ASSERT_EQ(1000, limiter.GetTotalBytesThrough(Env::IO_USER));
+  ASSERT_EQ(1111, limiter.GetTotalBytesThrough());
+  ASSERT_EQ(1, limiter.GetTotalRequests(Env::IO_USER));
+  ASSERT_EQ(4, limiter.GetTotalRequests());
+}
+
+TEST_F(RateLimiterTest, UserRequestsServedFirst) {
+  // One refill per second, of 100 bytes.
+  GenericRateLimiter limiter(
+      100 /* rate_bytes_per_sec */, 1000 * 1000 /* refill_period_us */,
+      10 /* fairness */, RateLimiter::Mode::kAllIo, Env::Default(),
+      false /* auto_tuned */);
+  // Drain the first refill.
+  limiter.Request(100, Env::IO_LOW, nullptr /* stats */,
+                  RateLimiter::OpType::kRead);
+  ASSERT_EQ(100, limiter.GetTotalBytesThrough(Env::IO_LOW));
+
+  // Both requests are queued long before the next refill, which only has
+  // tokens for one of them.
+  std::thread low_pri_thread([&limiter]() {
+    limiter.Request(100, Env::IO_LOW, nullptr /* stats */,
+                    RateLimiter::OpType::kRead);
+  });
+  std::thread user_thread([&limiter]() {
+    limiter.Request(100, Env::IO_USER, nullptr /* stats */,
+                    RateLimiter::OpType::kRead);
+  });
+  user_thread.join();
+  ASSERT_EQ(100, limiter.GetTotalBytesThrough(Env::IO_USER));
+  ASSERT_EQ(100, limiter.GetTotalBytesThrough(Env::IO_LOW));
+  low_pri_thread.join();
+  ASSERT_EQ(200, limiter.GetTotalBytesThrough(Env::IO_LOW));
+}
+
 #if !(defined(TRAVIS) && defined(OS_MACOSX))
 TEST_F(RateLimiterTest, Rate) {
   auto* env = Env::Default();
@@ -59,6 +59,8 @@ struct ThreadPoolImpl::Impl {
 
   void LowerCPUPriority(CpuPriority pri);
 
+  void PinToNumaNodes();
+
   void WakeUpAllThreads() {
     bgsignal_.notify_all();
   }
@@ -103,6 +105,7 @@ private:
 
  bool low_io_priority_;
  CpuPriority cpu_priority_;
+ bool pin_to_numa_nodes_;
  Env::Priority priority_;
  Env* env_;
 
@@ -129,6 +132,7 @@ private:
 inline ThreadPoolImpl::Impl::Impl()
     : low_io_priority_(false),
       cpu_priority_(CpuPriority::kNormal),
+      pin_to_numa_nodes_(false),
       priority_(Env::LOW),
       env_(nullptr),
       total_threads_limit_(0),
@@ -179,9 +183,15 @@ inline void ThreadPoolImpl::Impl::LowerCPUPriority(CpuPriority pri) {
   cpu_priority_ = pri;
 }
 
+inline void ThreadPoolImpl::Impl::PinToNumaNodes() {
+  std::lock_guard<std::mutex> lock(mu_);
+  pin_to_numa_nodes_ = true;
+}
+
 void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
   bool low_io_priority = false;
   CpuPriority current_cpu_priority = CpuPriority::kNormal;
+  bool pinned_to_numa_node = false;
 
   while (true) {
     // Wait until there is an item that is ready to run
@@ -223,8 +233,19 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
 
     bool decrease_io_priority = (low_io_priority != low_io_priority_);
     CpuPriority cpu_priority = cpu_priority_;
+    bool pin_to_numa_node = pin_to_numa_nodes_ && !pinned_to_numa_node;
     lock.unlock();
 
+    if (pin_to_numa_node) {
+      // Spread the threads over the nodes, so that each node runs its share
+      // of the background jobs on local memory.
+      int node = static_cast<int>(thread_id % port::GetNumaNodeCount());
+      port::BindCurrentThreadToNumaNode(node);
+      pinned_to_numa_node = true;
+      TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::PinnedToNumaNode",
+                               &node);
+    }
+
     if (cpu_priority < current_cpu_priority) {
       TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::BeforeSetCpuPriority",
                                &current_cpu_priority);
@@ -454,6 +475,8 @@ void ThreadPoolImpl::LowerCPUPriority(CpuPriority pri) {
   impl_->LowerCPUPriority(pri);
 }
 
+void ThreadPoolImpl::PinToNumaNodes() { impl_->PinToNumaNodes(); }
+
 void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num) {
   impl_->SetBackgroundThreadsInternal(num, false);
 }
@@ -53,6 +53,11 @@ class ThreadPoolImpl : public ThreadPool {
   // Currently only has effect on Linux
   void LowerCPUPriority(CpuPriority pri);
 
+  // Make threads run on the CPUs of one NUMA node each, spreading them over
+  // the nodes, and allocate memory from their node
+  // Currently only has effect on Linux built with NUMA support
+  void PinToNumaNodes();
+
   // Ensure there is at aleast num threads in the pool
   // but do not kill threads if there are more
   void IncBackgroundThreadsIfNeeded(int num);
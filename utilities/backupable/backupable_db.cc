@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cinttypes>
+#include <condition_variable>
 #include <functional>
 #include <future>
 #include <limits>
@@ -119,6 +120,8 @@ void BackupableDBOptions::Dump(Logger* logger) const {
                  restore_rate_limit);
   ROCKS_LOG_INFO(logger, "Options.max_background_operations: %d",
                  max_background_operations);
+  ROCKS_LOG_INFO(logger, " Options.parallel_copy_chunk_size: %" PRIu64,
+                 parallel_copy_chunk_size);
 }
 
 // -------- BackupEngineImpl class ---------
@@ -172,7 +175,11 @@ class BackupEngineImpl : public BackupEngine {
   }
 
  private:
-  void DeleteChildren(const std::string& dir, uint32_t file_type_filter = 0);
+  // Deletes the files in dir, except those of a type in file_type_filter and
+  // those whose full path is in files_to_keep.
+  void DeleteChildren(
+      const std::string& dir, uint32_t file_type_filter = 0,
+      const std::unordered_set<std::string>* files_to_keep = nullptr);
   Status DeleteBackupInternal(BackupID backup_id);
 
   // Extends the "result" map with pathname->size mappings for the contents of
@@ -500,6 +507,58 @@ class BackupEngineImpl : public BackupEngine {
     }
   };
 
+  // State of a large file copied in chunks by several background threads.
+  // Chunks are claimed through next_chunk; each participant computes the
+  // crc32c of the chunks it copies, and the thread that started the copy
+  // combines them once all chunks are done.
+  struct ChunkedCopy {
+    std::string src_path;
+    std::string dst_path;
+    Env* src_env;
+    Env* dst_env;
+    EnvOptions src_env_options;
+    RateLimiter* rate_limiter;
+    std::function<void()> progress_callback;
+    uint64_t file_size;
+    uint64_t chunk_size;
+    size_t num_chunks;
+    std::atomic<size_t> next_chunk;
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Protected by mutex
+    std::vector<uint32_t> chunk_checksums;
+    size_t num_chunks_done;
+    Status status;
+
+    ChunkedCopy()
+        : src_env(nullptr),
+          dst_env(nullptr),
+          rate_limiter(nullptr),
+          file_size(0),
+          chunk_size(0),
+          num_chunks(0),
+          next_chunk(0),
+          num_chunks_done(0) {}
+  };
+
+  struct CopyOrCreateWorkItem;
+
+  // Copies work_item's source file of file_size bytes using the other
+  // background threads too. Returns NotSupported, without copying anything,
+  // if the destination Env cannot write at random offsets.
+  Status CopyFileInChunks(const CopyOrCreateWorkItem& work_item,
+                          uint64_t file_size, uint64_t* size,
+                          std::string* checksum_hex);
+
+  // Copies unclaimed chunks of copy until there is none left.
+  void CopyChunks(ChunkedCopy* copy);
+
+  // Lets the calling background thread take part in the chunked copies in
+  // progress.
+  void HelpChunkedCopies();
+
+  void RemoveChunkedCopy(const std::shared_ptr<ChunkedCopy>& copy);
+
   struct CopyOrCreateResult {
     uint64_t size;
     std::string checksum_hex;
@@ -531,6 +590,14 @@ class BackupEngineImpl : public BackupEngine {
     std::string backup_checksum_func_name;
     std::string db_id;
     std::string db_session_id;
+    // If true, the item only asks the thread to help the chunked copies in
+    // progress.
+    bool help_chunked_copies;
+    // If true and dst_path already has expected_size bytes and the crc32c
+    // checksum expected_checksum_hex, dst_path is kept as is.
+    bool reuse_matching_dst;
+    uint64_t expected_size;
+    std::string expected_checksum_hex;
 
     CopyOrCreateWorkItem()
         : src_path(""),
@@ -547,7 +614,11 @@ class BackupEngineImpl : public BackupEngine {
           src_checksum_hex(""),
           backup_checksum_func_name(kUnknownFileChecksumFuncName),
           db_id(""),
-          db_session_id("") {}
+          db_session_id(""),
+          help_chunked_copies(false),
+          reuse_matching_dst(false),
+          expected_size(0),
+          expected_checksum_hex("") {}
 
     CopyOrCreateWorkItem(const CopyOrCreateWorkItem&) = delete;
     CopyOrCreateWorkItem& operator=(const CopyOrCreateWorkItem&) = delete;
@@ -574,6 +645,10 @@ class BackupEngineImpl : public BackupEngine {
       backup_checksum_func_name = std::move(o.backup_checksum_func_name);
       db_id = std::move(o.db_id);
       db_session_id = std::move(o.db_session_id);
+      help_chunked_copies = o.help_chunked_copies;
+      reuse_matching_dst = o.reuse_matching_dst;
+      expected_size = o.expected_size;
+      expected_checksum_hex = std::move(o.expected_checksum_hex);
       return *this;
     }
 
@@ -604,7 +679,11 @@ class BackupEngineImpl : public BackupEngine {
           src_checksum_hex(_src_checksum_hex),
           backup_checksum_func_name(_backup_checksum_func_name),
           db_id(_db_id),
-          db_session_id(_db_session_id) {}
+          db_session_id(_db_session_id),
+          help_chunked_copies(false),
+          reuse_matching_dst(false),
+          expected_size(0),
+          expected_checksum_hex("") {}
   };
 
   struct BackupAfterCopyOrCreateWorkItem {
@@ -677,6 +756,10 @@ class BackupEngineImpl : public BackupEngine {
   bool initialized_;
   std::mutex byte_report_mutex_;
   channel<CopyOrCreateWorkItem> files_to_copy_or_create_;
+  std::mutex chunked_copies_mutex_;
+  // Chunked copies with chunks possibly left to claim. Protected by
+  // chunked_copies_mutex_.
+  std::vector<std::shared_ptr<ChunkedCopy>> chunked_copies_;
   std::vector<port::Thread> threads_;
   std::atomic<CpuPriority> threads_cpu_priority_;
   // Certain operations like PurgeOldBackups and DeleteBackup will trigger
@@ -980,14 +1063,56 @@ Status BackupEngineImpl::Initialize() {
           port::SetCpuPriority(0, priority);
           current_priority = priority;
         }
+        // Large files being copied in chunks are finished before new files
+        // are started.
+        HelpChunkedCopies();
+        if (work_item.help_chunked_copies) {
+          continue;
+        }
+        std::unique_ptr<FileChecksumGenerator> checksum_func;
+        Status s = SetChecksumGenerator(work_item.backup_checksum_func_name,
+                                        checksum_func);
         CopyOrCreateResult result;
-        result.status = CopyOrCreateFile(
-            work_item.src_path, work_item.dst_path, work_item.contents,
-            work_item.src_env, work_item.dst_env, work_item.src_env_options,
-            work_item.sync, work_item.rate_limiter,
-            work_item.backup_checksum_func_name, &result.size,
-            &result.checksum_hex, &result.custom_checksum_hex,
-            work_item.size_limit, work_item.progress_callback);
+        bool copied = false;
+        if (s.ok() && work_item.reuse_matching_dst) {
+          uint64_t dst_size = 0;
+          if (work_item.dst_env->GetFileSize(work_item.dst_path, &dst_size)
+                  .ok() &&
+              dst_size == work_item.expected_size &&
+              CalculateChecksum(work_item.dst_path, work_item.dst_env,
+                                EnvOptions(), 0 /* size_limit */,
+                                &result.checksum_hex, checksum_func,
+                                &result.custom_checksum_hex)
+                  .ok() &&
+              result.checksum_hex == work_item.expected_checksum_hex) {
+            ROCKS_LOG_INFO(options_.info_log, "%s is up to date, not copied",
+                           work_item.dst_path.c_str());
+            result.size = dst_size;
+            result.status = Status::OK();
+            copied = true;
+          }
+        }
+        uint64_t file_size = 0;
+        if (!copied && s.ok() && checksum_func == nullptr &&
+            options_.parallel_copy_chunk_size > 0 &&
+            options_.max_background_operations > 1 &&
+            !work_item.src_path.empty() && work_item.size_limit == 0 &&
+            work_item.src_env->GetFileSize(work_item.src_path, &file_size)
+                .ok() &&
+            file_size >= 2 * options_.parallel_copy_chunk_size) {
+          result.status = CopyFileInChunks(work_item, file_size, &result.size,
+                                           &result.checksum_hex);
+          copied = !result.status.IsNotSupported();
+        }
+        if (!copied) {
+          result.status = CopyOrCreateFile(
+              work_item.src_path, work_item.dst_path, work_item.contents,
+              work_item.src_env, work_item.dst_env, work_item.src_env_options,
+              work_item.sync, work_item.rate_limiter,
+              work_item.backup_checksum_func_name, &result.size,
+              &result.checksum_hex, &result.custom_checksum_hex,
+              work_item.size_limit, work_item.progress_callback);
+        }
         result.checksum_func_name = work_item.backup_checksum_func_name;
         result.db_id = work_item.db_id;
         result.db_session_id = work_item.db_session_id;
@@ -1423,6 +1548,25 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
   ROCKS_LOG_INFO(options_.info_log, "Restoring backup id %u\n", backup_id);
   ROCKS_LOG_INFO(options_.info_log, "keep_log_files: %d\n",
                  static_cast<int>(options.keep_log_files));
+  ROCKS_LOG_INFO(options_.info_log, "incremental: %d\n",
+                 static_cast<int>(options.incremental));
+
+  // With an incremental restore, the files that will be restored are not
+  // deleted up front, so that they can be kept if they are up to date.
+  std::unordered_set<std::string> files_to_keep;
+  if (options.incremental) {
+    for (const auto& file_info : backup->GetFiles()) {
+      std::string dst;
+      uint64_t number;
+      FileType type;
+      Status s = GetFileNameInfo(file_info->filename, dst, number, type);
+      if (!s.ok()) {
+        return s;
+      }
+      files_to_keep.insert(((type == kLogFile) ? wal_dir : db_dir) + "/" +
+                           dst);
+    }
+  }
 
   // just in case. Ignore errors
   db_env_->CreateDirIfMissing(db_dir);
@@ -1430,7 +1574,7 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
 
   if (options.keep_log_files) {
     // delete files in db_dir, but keep all the log files
-    DeleteChildren(db_dir, 1 << kLogFile);
+    DeleteChildren(db_dir, 1 << kLogFile, &files_to_keep);
     // move all the files from archive dir to wal_dir
     std::string archive_dir = ArchivalDirectory(wal_dir);
     std::vector<std::string> archive_files;
@@ -1453,9 +1597,9 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
       }
     }
   } else {
-    DeleteChildren(wal_dir);
+    DeleteChildren(wal_dir, 0 /* file_type_filter */, &files_to_keep);
     DeleteChildren(ArchivalDirectory(wal_dir));
-    DeleteChildren(db_dir);
+    DeleteChildren(db_dir, 0 /* file_type_filter */, &files_to_keep);
   }
 
   Status s;
@@ -1526,6 +1670,11 @@ Status BackupEngineImpl::RestoreDBFromBackup(const RestoreOptions& options,
         0 /* size_limit */, []() {} /* progress_callback */,
         has_manifest_checksum, src_checksum_func_name, src_checksum_hex,
         backup_checksum_func_name);
+    if (options.incremental) {
+      copy_or_create_work_item.reuse_matching_dst = true;
+      copy_or_create_work_item.expected_size = file_info->size;
+      copy_or_create_work_item.expected_checksum_hex = file_info->checksum_hex;
+    }
     RestoreAfterCopyOrCreateWorkItem after_copy_or_create_work_item(
         copy_or_create_work_item.result.get_future(), file_info->checksum_hex);
     files_to_copy_or_create_.write(std::move(copy_or_create_work_item));
@@ -2052,6 +2201,187 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
   return s;
 }
 
+Status BackupEngineImpl::CopyFileInChunks(
+    const CopyOrCreateWorkItem& work_item, uint64_t file_size, uint64_t* size,
+    std::string* checksum_hex) {
+  EnvOptions dst_env_options;
+  dst_env_options.use_mmap_writes = false;
+  std::unique_ptr<WritableFile> dst_file;
+  Status s = work_item.dst_env->NewWritableFile(work_item.dst_path, &dst_file,
+                                                dst_env_options);
+  if (s.ok()) {
+    s = dst_file->Close();
+  }
+  // Also used to sync the file once all chunks are written
+  std::unique_ptr<RandomRWFile> dst_rw_file;
+  if (s.ok()) {
+    s = work_item.dst_env->NewRandomRWFile(work_item.dst_path, &dst_rw_file,
+                                           dst_env_options);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::shared_ptr<ChunkedCopy> copy(new ChunkedCopy());
+  copy->src_path = work_item.src_path;
+  copy->dst_path = work_item.dst_path;
+  copy->src_env = work_item.src_env;
+  copy->dst_env = work_item.dst_env;
+  copy->src_env_options = work_item.src_env_options;
+  copy->rate_limiter = work_item.rate_limiter;
+  copy->progress_callback = work_item.progress_callback;
+  copy->file_size = file_size;
+  copy->chunk_size = options_.parallel_copy_chunk_size;
+  copy->num_chunks =
+      static_cast<size_t>((file_size + copy->chunk_size - 1) / copy->chunk_size);
+  copy->chunk_checksums.resize(copy->num_chunks);
+  {
+    std::lock_guard<std::mutex> lock(chunked_copies_mutex_);
+    chunked_copies_.push_back(copy);
+  }
+  // Wake up idle threads; busy ones join when they finish their current file.
+  size_t num_helpers =
+      std::min(static_cast<size_t>(options_.max_background_operations - 1),
+               copy->num_chunks - 1);
+  for (size_t i = 0; i < num_helpers; i++) {
+    CopyOrCreateWorkItem helper;
+    helper.help_chunked_copies = true;
+    files_to_copy_or_create_.write(std::move(helper));
+  }
+  TEST_SYNC_POINT("BackupEngineImpl::CopyFileInChunks:Start");
+
+  CopyChunks(copy.get());
+  RemoveChunkedCopy(copy);
+  {
+    std::unique_lock<std::mutex> lock(copy->mutex);
+    copy->cv.wait(lock,
+                  [&] { return copy->num_chunks_done == copy->num_chunks; });
+    s = copy->status;
+  }
+  if (s.ok() && work_item.sync) {
+    s = dst_rw_file->Fsync();
+  }
+  if (s.ok()) {
+    s = dst_rw_file->Close();
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  uint32_t checksum_value = copy->chunk_checksums[0];
+  for (size_t i = 1; i < copy->num_chunks; i++) {
+    uint64_t chunk_len =
+        std::min(copy->chunk_size, file_size - i * copy->chunk_size);
+    checksum_value = crc32c::Crc32cCombine(
+        checksum_value, copy->chunk_checksums[i], static_cast<size_t>(chunk_len));
+  }
+  *size = file_size;
+  checksum_hex->assign(ChecksumInt32ToHex(checksum_value));
+  return s;
+}
+
+void BackupEngineImpl::CopyChunks(ChunkedCopy* copy) {
+  std::unique_ptr<RandomAccessFile> src_file;
+  std::unique_ptr<RandomRWFile> dst_file;
+  std::unique_ptr<char[]> buf;
+  uint64_t processed_buffer_size = 0;
+  while (true) {
+    size_t chunk = copy->next_chunk.fetch_add(1);
+    if (chunk >= copy->num_chunks) {
+      break;
+    }
+    Status s;
+    {
+      std::lock_guard<std::mutex> lock(copy->mutex);
+      // No point in copying more once a chunk failed
+      s = copy->status;
+    }
+    if (s.ok() && src_file == nullptr) {
+      s = copy->src_env->NewRandomAccessFile(copy->src_path, &src_file,
+                                             copy->src_env_options);
+      if (s.ok()) {
+        EnvOptions dst_env_options;
+        dst_env_options.use_mmap_writes = false;
+        s = copy->dst_env->NewRandomRWFile(copy->dst_path, &dst_file,
+                                           dst_env_options);
+      }
+      if (!s.ok()) {
+        src_file.reset();
+      }
+      buf.reset(new char[copy_file_buffer_size_]);
+    }
+    uint64_t offset = chunk * copy->chunk_size;
+    uint64_t end = std::min(offset + copy->chunk_size, copy->file_size);
+    uint32_t checksum_value = 0;
+    while (s.ok() && offset < end) {
+      if (stop_backup_.load(std::memory_order_acquire)) {
+        s = Status::Incomplete("Backup stopped");
+        break;
+      }
+      size_t n = static_cast<size_t>(
+          std::min(static_cast<uint64_t>(copy_file_buffer_size_), end - offset));
+      Slice data;
+      s = src_file->Read(offset, n, &data, buf.get());
+      if (s.ok() && data.size() != n) {
+        s = Status::Corruption("File size changed while copying " +
+                               copy->src_path);
+      }
+      if (!s.ok()) {
+        break;
+      }
+      checksum_value = crc32c::Extend(checksum_value, data.data(), data.size());
+      s = dst_file->Write(offset, data);
+      if (copy->rate_limiter != nullptr) {
+        copy->rate_limiter->Request(data.size(), Env::IO_LOW,
+                                    nullptr /* stats */,
+                                    RateLimiter::OpType::kWrite);
+      }
+      offset += n;
+      processed_buffer_size += n;
+      if (processed_buffer_size > options_.callback_trigger_interval_size) {
+        processed_buffer_size -= options_.callback_trigger_interval_size;
+        std::lock_guard<std::mutex> lock(byte_report_mutex_);
+        copy->progress_callback();
+      }
+    }
+    std::lock_guard<std::mutex> lock(copy->mutex);
+    copy->chunk_checksums[chunk] = checksum_value;
+    if (!s.ok() && copy->status.ok()) {
+      copy->status = s;
+    }
+    if (++copy->num_chunks_done == copy->num_chunks) {
+      copy->cv.notify_all();
+    }
+  }
+  if (dst_file != nullptr) {
+    dst_file->Close();  // ignore errors, the chunks are synced by the leader
+  }
+}
+
+void BackupEngineImpl::HelpChunkedCopies() {
+  while (true) {
+    std::shared_ptr<ChunkedCopy> copy;
+    {
+      std::lock_guard<std::mutex> lock(chunked_copies_mutex_);
+      if (chunked_copies_.empty()) {
+        return;
+      }
+      copy = chunked_copies_.back();
+    }
+    CopyChunks(copy.get());
+    RemoveChunkedCopy(copy);
+  }
+}
+
+void BackupEngineImpl::RemoveChunkedCopy(
+    const std::shared_ptr<ChunkedCopy>& copy) {
+  std::lock_guard<std::mutex> lock(chunked_copies_mutex_);
+  auto it = std::find(chunked_copies_.begin(), chunked_copies_.end(), copy);
+  if (it != chunked_copies_.end()) {
+    chunked_copies_.erase(it);
+  }
+}
+
 Status BackupEngineImpl::CalculateChecksum(
     const std::string& src, Env* src_env, const EnvOptions& src_env_options,
     uint64_t size_limit, std::string* checksum_hex,
@@ -2306,8 +2636,9 @@ Status BackupEngineImpl::VerifyFileWithCrc32c(Env* src_env,
   return s;
 }
 
-void BackupEngineImpl::DeleteChildren(const std::string& dir,
-                                      uint32_t file_type_filter) {
+void BackupEngineImpl::DeleteChildren(
+    const std::string& dir, uint32_t file_type_filter,
+    const std::unordered_set<std::string>* files_to_keep) {
   std::vector<std::string> children;
   db_env_->GetChildren(dir, &children);  // ignore errors
 
@@ -2319,6 +2650,9 @@ void BackupEngineImpl::DeleteChildren(const std::string& dir,
       // don't delete this file
       continue;
     }
+    if (files_to_keep != nullptr && files_to_keep->count(dir + "/" + f) > 0) {
+      continue;
+    }
     db_env_->DeleteFile(dir + "/" + f);  // ignore errors
   }
 }
@@ -2314,6 +2314,59 @@ TEST_F(BackupableDBTest, KeepLogFiles) {
   AssertBackupConsistency(0, 0, 500, 600, true);
 }
 
+TEST_F(BackupableDBTest, ParallelChunkedCopy) {
+  backupable_options_->parallel_copy_chunk_size = 1024;
+  std::atomic<int> num_chunked_copies(0);
+  SyncPoint::GetInstance()->SetCallBack(
+      "BackupEngineImpl::CopyFileInChunks:Start",
+      [&](void* /*arg*/) { num_chunked_copies++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  OpenDBAndBackupEngine(true);
+  FillDB(db_.get(), 0, 1000, kFlushAll);
+  ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+  ASSERT_GT(num_chunked_copies.load(), 0);
+  // The combined checksums match the checksums of the whole files
+  ASSERT_OK(backup_engine_->VerifyBackup(1, true /* verify_with_checksum */));
+  CloseDBAndBackupEngine();
+
+  num_chunked_copies = 0;
+  AssertBackupConsistency(0, 0, 1000, 1100);
+  ASSERT_GT(num_chunked_copies.load(), 0);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(BackupableDBTest, IncrementalRestore) {
+  OpenDBAndBackupEngine(true);
+  FillDB(db_.get(), 0, 100, kFlushAll);
+  FillDB(db_.get(), 100, 200, kFlushAll);
+  ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+  CloseDBAndBackupEngine();
+
+  OpenBackupEngine();
+  ASSERT_OK(backup_engine_->RestoreDBFromLatestBackup(dbname_, dbname_));
+  // A file that is not in the backup is still deleted
+  std::string extra_file = dbname_ + "/999999.sst";
+  ASSERT_OK(WriteStringToFile(test_db_env_.get(), "garbage", extra_file));
+  // Up to date files are kept, so only the corrupted one is written again
+  ASSERT_OK(CorruptRandomTableFileInDB());
+  test_db_env_->SetLimitWrittenFiles(1);
+  RestoreOptions restore_options(false /* keep_log_files */,
+                                 true /* incremental */);
+  ASSERT_OK(backup_engine_->RestoreDBFromLatestBackup(dbname_, dbname_,
+                                                      restore_options));
+  ASSERT_TRUE(test_db_env_->FileExists(extra_file).IsNotFound());
+  test_db_env_->SetLimitWrittenFiles(1000000);
+
+  DB* db = OpenDB();
+  AssertExists(db, 0, 200);
+  AssertEmpty(db, 200, 300);
+  delete db;
+  CloseBackupEngine();
+}
+
 class BackupableDBRateLimitingTestWithParam
     : public BackupableDBTest,
       public testing::WithParamInterface<
@@ -0,0 +1,376 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/bulk_loader.h"
+
+#include <algorithm>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/iterator.h"
+#include "rocksdb/sst_file_reader.h"
+#include "rocksdb/sst_file_writer.h"
+#include "rocksdb/threadpool.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+using KeyValue = std::pair<std::string, std::string>;
+
+// A sorted run of unique keys: either the in-memory buffer or a spill file.
+class SortedRun {
+ public:
+  virtual ~SortedRun() {}
+  virtual bool Valid() const = 0;
+  virtual Slice key() const = 0;
+  virtual Slice value() const = 0;
+  virtual void Next() = 0;
+  virtual Status status() const = 0;
+};
+
+class BufferRun : public SortedRun {
+ public:
+  explicit BufferRun(std::vector<KeyValue>* entries)
+      : entries_(entries), pos_(0) {}
+  bool Valid() const override { return pos_ < entries_->size(); }
+  Slice key() const override { return (*entries_)[pos_].first; }
+  Slice value() const override { return (*entries_)[pos_].second; }
+  void Next() override { ++pos_; }
+  Status status() const override { return Status::OK(); }
+
+ private:
+  std::vector<KeyValue>* entries_;
+  size_t pos_;
+};
+
+class SpillFileRun : public SortedRun {
+ public:
+  SpillFileRun(std::unique_ptr<SstFileReader>&& reader, Iterator* iter)
+      : reader_(std::move(reader)), iter_(iter) {
+    iter_->SeekToFirst();
+  }
+  bool Valid() const override { return iter_->Valid(); }
+  Slice key() const override { return iter_->key(); }
+  Slice value() const override { return iter_->value(); }
+  void Next() override { iter_->Next(); }
+  Status status() const override { return iter_->status(); }
+
+ private:
+  std::unique_ptr<SstFileReader> reader_;
+  std::unique_ptr<Iterator> iter_;
+};
+
+class BulkLoaderImpl : public BulkLoader {
+ public:
+  BulkLoaderImpl(DB* db, ColumnFamilyHandle* column_family,
+                 const BulkLoaderOptions& options, const Options& cf_options)
+      : db_(db),
+        column_family_(column_family),
+        options_(options),
+        cf_options_(cf_options),
+        env_(cf_options.env),
+        ucmp_(cf_options.comparator),
+        pool_(NewThreadPool(std::max(options.num_threads, 1))),
+        buffer_size_(0),
+        batch_size_(0),
+        next_file_number_(0),
+        next_spill_number_(0),
+        finished_(false),
+        pending_jobs_(0),
+        cv_(&mu_) {}
+
+  ~BulkLoaderImpl() override {
+    pool_->WaitForJobsAndJoinAllThreads();
+    for (const auto& path : spill_files_) {
+      env_->DeleteFile(path);
+    }
+    if (!finished_) {
+      for (const auto& path : built_files_) {
+        env_->DeleteFile(path);
+      }
+    }
+  }
+
+  Status Add(const Slice& key, const Slice& value) override {
+    if (finished_) {
+      return Status::InvalidArgument("BulkLoader is already finished");
+    }
+    if (options_.sorted_input) {
+      if (!batch_.empty()) {
+        int cmp = ucmp_->Compare(key, batch_.back().first);
+        if (cmp < 0) {
+          return Status::InvalidArgument("Keys must be added in order");
+        } else if (cmp == 0) {
+          batch_size_ += value.size();
+          batch_size_ -= batch_.back().second.size();
+          batch_.back().second.assign(value.data(), value.size());
+          return Status::OK();
+        }
+      }
+      return AddToBatch(key, value);
+    }
+    buffer_.emplace_back(key.ToString(), value.ToString());
+    buffer_size_ += key.size() + value.size();
+    if (buffer_size_ >= options_.max_buffer_size) {
+      return SpillBuffer();
+    }
+    return Status::OK();
+  }
+
+  Status Finish() override {
+    if (finished_) {
+      return Status::InvalidArgument("BulkLoader is already finished");
+    }
+    finished_ = true;
+    Status s;
+    if (!options_.sorted_input) {
+      s = MergeRuns();
+    }
+    if (s.ok() && !batch_.empty()) {
+      s = SubmitBatch();
+    }
+    pool_->WaitForJobsAndJoinAllThreads();
+    if (s.ok()) {
+      s = build_status_;
+    }
+    if (s.ok() && !built_files_.empty()) {
+      s = db_->IngestExternalFile(column_family_, built_files_,
+                                  options_.ingest_options);
+    }
+    if (!s.ok()) {
+      finished_ = false;  // let the destructor clean up the built files
+    }
+    return s;
+  }
+
+  uint64_t num_files() const override { return built_files_.size(); }
+
+  Status Init() { return env_->CreateDirIfMissing(options_.work_dir); }
+
+ private:
+  // Appends a key greater than all keys added to the batch so far, and hands
+  // the batch to the builder threads once it reaches the target file size.
+  // Batches are only cut between different keys, so the built files do not
+  // overlap.
+  Status AddToBatch(const Slice& key, const Slice& value) {
+    if (batch_size_ >= options_.target_file_size) {
+      Status s = SubmitBatch();
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    batch_.emplace_back(key.ToString(), value.ToString());
+    batch_size_ += key.size() + value.size();
+    return Status::OK();
+  }
+
+  Status SubmitBatch() {
+    {
+      MutexLock l(&mu_);
+      // Bound the memory held by batches waiting for a builder thread.
+      while (pending_jobs_ >= 2 * pool_->GetBackgroundThreads()) {
+        cv_.Wait();
+      }
+      if (!build_status_.ok()) {
+        return build_status_;
+      }
+      pending_jobs_++;
+    }
+    std::string path = options_.work_dir + "/bulk_load_" +
+                       ToString(next_file_number_++) + ".sst";
+    built_files_.push_back(path);
+    std::shared_ptr<std::vector<KeyValue>> batch(
+        new std::vector<KeyValue>(std::move(batch_)));
+    batch_.clear();
+    batch_size_ = 0;
+    pool_->SubmitJob([this, batch, path]() {
+      Status s = WriteFile(path, *batch, false /* spill */);
+      MutexLock l(&mu_);
+      if (!s.ok() && build_status_.ok()) {
+        build_status_ = s;
+      }
+      pending_jobs_--;
+      cv_.SignalAll();
+    });
+    return Status::OK();
+  }
+
+  Status WriteFile(const std::string& path, const std::vector<KeyValue>& kvs,
+                   bool spill) {
+    Options options = cf_options_;
+    if (spill) {
+      options.compression = kNoCompression;
+      options.compression_per_level.clear();
+      options.bottommost_compression = kDisableCompressionOption;
+    }
+    SstFileWriter writer(EnvOptions(options), options, column_family_,
+                         true /* invalidate_page_cache */,
+                         Env::IOPriority::IO_TOTAL,
+                         spill /* skip_filters */);
+    Status s = writer.Open(path);
+    for (size_t i = 0; s.ok() && i < kvs.size(); ++i) {
+      s = writer.Put(kvs[i].first, kvs[i].second);
+    }
+    if (s.ok()) {
+      s = writer.Finish();
+    }
+    return s;
+  }
+
+  // Sorts the buffer and drops all but the last added value of each key.
+  void SortBuffer() {
+    const Comparator* ucmp = ucmp_;
+    std::stable_sort(buffer_.begin(), buffer_.end(),
+                     [ucmp](const KeyValue& a, const KeyValue& b) {
+                       return ucmp->Compare(a.first, b.first) < 0;
+                     });
+    size_t out = 0;
+    for (size_t i = 0; i < buffer_.size(); ++i) {
+      if (i + 1 < buffer_.size() &&
+          ucmp_->Compare(buffer_[i].first, buffer_[i + 1].first) == 0) {
+        continue;
+      }
+      if (out != i) {
+        buffer_[out] = std::move(buffer_[i]);
+      }
+      out++;
+    }
+    buffer_.resize(out);
+  }
+
+  Status SpillBuffer() {
+    SortBuffer();
+    std::string path = options_.work_dir + "/bulk_load_spill_" +
+                       ToString(next_spill_number_++) + ".sst";
+    spill_files_.push_back(path);
+    Status s = WriteFile(path, buffer_, true /* spill */);
+    buffer_.clear();
+    buffer_size_ = 0;
+    return s;
+  }
+
+  // Merges the spill files and the remaining buffer into the batches. For
+  // keys present in several runs, the run written last wins.
+  Status MergeRuns() {
+    SortBuffer();
+    std::vector<std::unique_ptr<SortedRun>> runs;
+    for (const auto& path : spill_files_) {
+      std::unique_ptr<SstFileReader> reader(new SstFileReader(cf_options_));
+      Status s = reader->Open(path);
+      if (!s.ok()) {
+        return s;
+      }
+      ReadOptions ro;
+      ro.fill_cache = false;
+      ro.readahead_size = 2 << 20;
+      Iterator* iter = reader->NewIterator(ro);
+      runs.emplace_back(new SpillFileRun(std::move(reader), iter));
+    }
+    runs.emplace_back(new BufferRun(&buffer_));
+
+    const Comparator* ucmp = ucmp_;
+    // Min-heap on key; among equal keys, the newest run comes first.
+    auto greater = [&runs, ucmp](size_t a, size_t b) {
+      int cmp = ucmp->Compare(runs[a]->key(), runs[b]->key());
+      return cmp > 0 || (cmp == 0 && a < b);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heap(
+        greater);
+    for (size_t i = 0; i < runs.size(); ++i) {
+      if (runs[i]->Valid()) {
+        heap.push(i);
+      } else if (!runs[i]->status().ok()) {
+        return runs[i]->status();
+      }
+    }
+    std::string key;
+    while (!heap.empty()) {
+      size_t top = heap.top();
+      heap.pop();
+      key = runs[top]->key().ToString();
+      Status s = AddToBatch(key, runs[top]->value());
+      if (!s.ok()) {
+        return s;
+      }
+      // Skip older values of the same key.
+      std::vector<size_t> advanced = {top};
+      while (!heap.empty() && ucmp_->Compare(runs[heap.top()]->key(), key) ==
+                                  0) {
+        advanced.push_back(heap.top());
+        heap.pop();
+      }
+      for (size_t i : advanced) {
+        runs[i]->Next();
+        if (runs[i]->Valid()) {
+          heap.push(i);
+        } else if (!runs[i]->status().ok()) {
+          return runs[i]->status();
+        }
+      }
+    }
+    buffer_.clear();
+    return Status::OK();
+  }
+
+  DB* db_;
+  ColumnFamilyHandle* column_family_;
+  const BulkLoaderOptions options_;
+  const Options cf_options_;
+  Env* env_;
+  const Comparator* ucmp_;
+  std::unique_ptr<ThreadPool> pool_;
+
+  // Unsorted input not spilled yet.
+  std::vector<KeyValue> buffer_;
+  size_t buffer_size_;
+  std::vector<std::string> spill_files_;
+
+  // Sorted, unique keys for the next table file.
+  std::vector<KeyValue> batch_;
+  uint64_t batch_size_;
+  std::vector<std::string> built_files_;
+  uint64_t next_file_number_;
+  uint64_t next_spill_number_;
+  bool finished_;
+
+  port::Mutex mu_;
+  // Batches submitted but not written yet. Protected by mu_.
+  int pending_jobs_;
+  // First error of the builder threads. Protected by mu_.
+  Status build_status_;
+  port::CondVar cv_;
+};
+}  // namespace
+
+Status BulkLoader::Create(DB* db, ColumnFamilyHandle* column_family,
+                          const BulkLoaderOptions& options,
+                          std::unique_ptr<BulkLoader>* loader) {
+  if (options.work_dir.empty()) {
+    return Status::InvalidArgument("work_dir must be set");
+  }
+  if (column_family == nullptr) {
+    column_family = db->DefaultColumnFamily();
+  }
+  Options cf_options = db->GetOptions(column_family);
+  std::unique_ptr<BulkLoaderImpl> impl(
+      new BulkLoaderImpl(db, column_family, options, cf_options));
+  Status s = impl->Init();
+  if (s.ok()) {
+    loader->reset(impl.release());
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+#endif  // !ROCKSDB_LITE
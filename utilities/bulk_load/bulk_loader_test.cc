@@ -0,0 +1,180 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/utilities/bulk_loader.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "file/file_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/metadata.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "util/random.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+std::string Key(int i) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "key%06d", i);
+  return std::string(buf);
+}
+}  // namespace
+
+class BulkLoaderTest : public testing::Test {
+ public:
+  BulkLoaderTest() : env_(Env::Default()), db_(nullptr) {
+    dbname_ = test::PerThreadDBPath(env_, "bulk_loader_test");
+    work_dir_ = test::PerThreadDBPath(env_, "bulk_loader_work");
+    options_.create_if_missing = true;
+    EXPECT_OK(DestroyDB(dbname_, options_));
+    DestroyDir(env_, work_dir_);
+    EXPECT_OK(DB::Open(options_, dbname_, &db_));
+  }
+
+  ~BulkLoaderTest() override {
+    delete db_;
+    EXPECT_OK(DestroyDB(dbname_, options_));
+    DestroyDir(env_, work_dir_);
+  }
+
+  BulkLoaderOptions LoaderOptions() {
+    BulkLoaderOptions options;
+    options.work_dir = work_dir_;
+    options.target_file_size = 32 << 10;
+    options.num_threads = 3;
+    return options;
+  }
+
+  void VerifyDB(const std::map<std::string, std::string>& expected) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto it = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+      ASSERT_TRUE(it != expected.end());
+      ASSERT_EQ(it->first, iter->key().ToString());
+      ASSERT_EQ(it->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(it == expected.end());
+  }
+
+  // Checks that all files are in the bottommost level.
+  void VerifyFilesInBottommostLevel(uint64_t num_files) {
+    ColumnFamilyMetaData cf_meta;
+    db_->GetColumnFamilyMetaData(&cf_meta);
+    ASSERT_EQ(num_files, cf_meta.file_count);
+    ASSERT_EQ(num_files, cf_meta.levels.back().files.size());
+  }
+
+  Env* env_;
+  Options options_;
+  std::string dbname_;
+  std::string work_dir_;
+  DB* db_;
+};
+
+TEST_F(BulkLoaderTest, UnsortedInputWithSpills) {
+  BulkLoaderOptions loader_options = LoaderOptions();
+  loader_options.max_buffer_size = 64 << 10;
+  std::unique_ptr<BulkLoader> loader;
+  ASSERT_OK(BulkLoader::Create(db_, nullptr, loader_options, &loader));
+
+  Random rnd(301);
+  const int kNumKeys = 5000;
+  std::vector<int> order(kNumKeys);
+  for (int i = 0; i < kNumKeys; ++i) {
+    order[i] = i;
+  }
+  RandomShuffle(order.begin(), order.end(), 301);
+  std::map<std::string, std::string> expected;
+  for (int i : order) {
+    std::string key = Key(i);
+    expected[key] = rnd.RandomString(50);
+    ASSERT_OK(loader->Add(key, expected[key]));
+  }
+  // Overwrite some keys; the value added last wins, even when the first
+  // value is already in a spill file.
+  for (int i = 0; i < kNumKeys; i += 7) {
+    expected[Key(i)] = "overwritten" + ToString(i);
+    ASSERT_OK(loader->Add(Key(i), expected[Key(i)]));
+  }
+  ASSERT_OK(loader->Finish());
+  ASSERT_TRUE(loader->Add("foo", "bar").IsInvalidArgument());
+  ASSERT_GT(loader->num_files(), 1);
+
+  VerifyDB(expected);
+  VerifyFilesInBottommostLevel(loader->num_files());
+  loader.reset();
+
+  // Spill files are removed and the built files were moved into the DB.
+  std::vector<std::string> children;
+  ASSERT_OK(env_->GetChildren(work_dir_, &children));
+  for (const auto& child : children) {
+    ASSERT_TRUE(child == "." || child == "..") << child;
+  }
+}
+
+TEST_F(BulkLoaderTest, SortedInput) {
+  BulkLoaderOptions loader_options = LoaderOptions();
+  loader_options.sorted_input = true;
+  std::unique_ptr<BulkLoader> loader;
+  ASSERT_OK(BulkLoader::Create(db_, nullptr, loader_options, &loader));
+
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 3000; ++i) {
+    expected[Key(i)] = rnd.RandomString(50);
+    ASSERT_OK(loader->Add(Key(i), expected[Key(i)]));
+    if (i % 100 == 0) {
+      expected[Key(i)] = "dup";
+      ASSERT_OK(loader->Add(Key(i), "dup"));
+    }
+  }
+  ASSERT_TRUE(loader->Add(Key(5), "v").IsInvalidArgument());
+  ASSERT_OK(loader->Finish());
+  ASSERT_GT(loader->num_files(), 1);
+
+  VerifyDB(expected);
+  VerifyFilesInBottommostLevel(loader->num_files());
+}
+
+TEST_F(BulkLoaderTest, EmptyInput) {
+  std::unique_ptr<BulkLoader> loader;
+  ASSERT_OK(BulkLoader::Create(db_, nullptr, LoaderOptions(), &loader));
+  ASSERT_OK(loader->Finish());
+  ASSERT_EQ(0, loader->num_files());
+  VerifyDB({});
+
+  BulkLoaderOptions no_dir;
+  ASSERT_TRUE(
+      BulkLoader::Create(db_, nullptr, no_dir, &loader).IsInvalidArgument());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as BulkLoader is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
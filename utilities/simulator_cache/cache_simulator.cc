@@ -218,12 +218,30 @@ Status BlockCacheTraceSimulator::InitializeCaches() {
             NewLRUCache(simulate_cache_capacity, config.num_shard_bits,
                         /*strict_capacity_limit=*/false,
                         /*high_pri_pool_ratio=*/0));
+      } else if (cache_name == "lru_tinylfu") {
+        LRUCacheOptions cache_opts(simulate_cache_capacity,
+                                   config.num_shard_bits,
+                                   /*strict_capacity_limit=*/false,
+                                   /*high_pri_pool_ratio=*/0);
+        cache_opts.high_pri_admission_control = true;
+        cache_opts.low_pri_admission_control = true;
+        sim_cache = std::make_shared<CacheSimulator>(std::move(ghost_cache),
+                                                     NewLRUCache(cache_opts));
       } else if (cache_name == "lru_priority") {
         sim_cache = std::make_shared<PrioritizedCacheSimulator>(
             std::move(ghost_cache),
             NewLRUCache(simulate_cache_capacity, config.num_shard_bits,
                         /*strict_capacity_limit=*/false,
                         /*high_pri_pool_ratio=*/0.5));
+      } else if (cache_name == "lru_priority_tinylfu") {
+        // Only data blocks are subject to admission control.
+        LRUCacheOptions cache_opts(simulate_cache_capacity,
+                                   config.num_shard_bits,
+                                   /*strict_capacity_limit=*/false,
+                                   /*high_pri_pool_ratio=*/0.5);
+        cache_opts.low_pri_admission_control = true;
+        sim_cache = std::make_shared<PrioritizedCacheSimulator>(
+            std::move(ghost_cache), NewLRUCache(cache_opts));
       } else if (cache_name == "lru_hybrid") {
         sim_cache = std::make_shared<HybridRowBlockCacheSimulator>(
             std::move(ghost_cache),